@@ -15,6 +15,8 @@ extern "C" {
  */
 #include "cc11xL_spi.h"
 #include "hal_msp_exp430g2_spi.h"
+#include "cc11xL_profile.h"
+#include "cc11xL_txpower.h"
 
   
 /******************************************************************************
@@ -42,6 +44,8 @@ extern "C" {
 // CRC autoflush = false 
 // PA ramping = false 
 // TX power = 12 
+// Keep the table in ascending address order: cc11xLConfigLoad() writes each
+// run of consecutive addresses with a single burst access.
 static const registerSetting_t preferredSettings[] = {
   {CC110L_IOCFG0,       0x06},
   {CC110L_FIFOTHR,      0x47},
@@ -66,6 +70,46 @@ static const registerSetting_t preferredSettings[] = {
   {CC110L_TEST0,        0x09},
   {CC11xL_PA_TABLE0,    0xC0},
 };
+
+// Data rate profiles for cc11xLProfileSelect(), 27 MHz crystal, GFSK.
+// Entry 0 repeats the values of preferredSettings (and the reset values of
+// BSCFG, AGCCTRL2..0 and FREND1), so the base rate can be selected again.
+// Data rate, deviation and RX filter BW are set from the data sheet
+// formulas; IF, frequency offset, bit sync, AGC, front end and TEST
+// settings follow SmartRF Studio's choices for the same rates. The
+// sensitivities are typical data sheet figures at 868 MHz. Profiles are in
+// ascending data rate order, as cc11xL_rate.c steps through them.
+//
+//   Data rate  Deviation  RX filter BW
+//   1.2 kbps   4.9 kHz    60 kHz
+//   38.4 kbps  19.8 kHz   105 kHz
+//   100 kbps   46.1 kHz   338 kHz
+//   250 kbps   131.8 kHz  563 kHz
+static const cc11xLProfile_t dataRateProfiles[] = {
+  //               FSCTRL1 MDMCFG4 MDMCFG3 DEVIATN FOCCFG BSCFG AGCCTRL2 AGCCTRL1 AGCCTRL0 FREND1 TEST2 TEST1
+  {  1201UL, -112, {0x06,   0xF5,   0x75,   0x14,   0x16,  0x6C, 0x03,    0x40,    0x91,    0x56,  0x81, 0x35}},
+  { 38418UL, -104, {0x06,   0xCA,   0x75,   0x34,   0x16,  0x6C, 0x43,    0x40,    0x91,    0x56,  0x81, 0x35}},
+  { 99907UL,  -99, {0x08,   0x5B,   0xE5,   0x46,   0x1D,  0x1C, 0xC7,    0x00,    0xB2,    0xB6,  0x88, 0x31}},
+  {249664UL,  -95, {0x0C,   0x2D,   0x2F,   0x62,   0x1D,  0x1C, 0xC7,    0x00,    0xB0,    0xB6,  0x88, 0x31}},
+};
+#define NUM_DATA_RATE_PROFILES  (sizeof(dataRateProfiles)/sizeof(cc11xLProfile_t))
+
+// PA settings for cc11xLTxPowerInit(), 868 MHz, 3 V, in ascending output
+// power order. Power and TX current are typical data sheet figures; measure
+// them on the board for energy figures that can be relied on.
+static const cc11xLPaSetting_t paSettings[] = {
+  //  dBm  PATABLE  mA * 10
+  {  -30,  0x03,   119},
+  {  -20,  0x0F,   134},
+  {  -15,  0x1E,   142},
+  {  -10,  0x27,   158},
+  {    0,  0x50,   168},
+  {    5,  0x81,   199},
+  {    7,  0xCB,   259},
+  {   10,  0xC2,   297},
+  {   12,  0xC0,   340},
+};
+#define NUM_PA_SETTINGS         (sizeof(paSettings)/sizeof(cc11xLPaSetting_t))
 #ifdef  __cplusplus
 }
 #endif
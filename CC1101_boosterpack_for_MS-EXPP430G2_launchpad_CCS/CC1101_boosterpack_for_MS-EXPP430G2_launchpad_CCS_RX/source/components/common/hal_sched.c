@@ -0,0 +1,421 @@
+/******************************************************************************
+    Filename: hal_sched.c
+
+    Description: Task scheduler. The application gives a static table of
+                 task functions, index 0 the highest priority, and
+                 halSchedRun() takes over the main loop: it runs the highest
+                 priority task with events posted to it, to completion, and
+                 picks again. Work of a lower priority task is never
+                 preempted, but a higher priority task posted meanwhile
+                 runs as soon as it returns, before anything else.
+
+                 ISRs post with halSchedPost(). A task with events pending
+                 has its bit set in a ready mask; the highest priority one
+                 is the lowest bit set, found with a table lookup per
+                 nibble, in the same few instructions whatever the number
+                 of tasks. With no task ready the MCU sleeps in
+                 halMcuEventWait(), which each post ends.
+
+                 Each task may have a one shot timer, checked when no task
+                 is ready, which posts its events once due.
+
+                 Each run is timed with halMcuGetTimeTicks(), as well as the
+                 time from the post that made the task ready to its run, and
+                 the longest of each is kept per task.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_sched.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_int.h"
+#include "hal_mcu.h"
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static const halSchedTask_t *schedTasks;
+static uint8 schedTaskCount;
+
+/* Tasks with events pending, and the events */
+static volatile uint16 schedReady;
+static volatile uint16 schedEvents[HAL_SCHED_MAX_TASKS];
+static uint32 schedReadyTicks[HAL_SCHED_MAX_TASKS];  /* when the task became ready */
+
+/* One shot timers, main loop only */
+static uint16 schedTimerArmed;
+static uint16 schedTimerEvents[HAL_SCHED_MAX_TASKS];
+static uint32 schedTimerDueMs[HAL_SCHED_MAX_TASKS];
+
+static halSchedStats_t schedStats[HAL_SCHED_MAX_TASKS];
+
+/* Bit of each task in the masks, the MSP430 has no barrel shifter */
+static const uint16 schedBit[HAL_SCHED_MAX_TASKS] =
+{
+  0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+  0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000
+};
+
+/* Index of the lowest set bit of a nibble */
+static const uint8 lowestBitTbl[16] = {0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static uint8 halSchedLowest(uint16 mask);
+static void  halSchedIdle(void);
+
+/******************************************************************************
+ * @fn          halSchedInit
+ *
+ * @brief       Takes the task table. Events posted before are dropped.
+ *
+ * input parameters
+ *
+ * @param       pTasks - task functions, index 0 the highest priority; the
+ *                       index is the task number
+ * @param       nTasks - 1 to HAL_SCHED_MAX_TASKS
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halSchedInit(const halSchedTask_t *pTasks, uint8 nTasks)
+{
+  istate_t key;
+  uint8 i;
+
+  HAL_INT_LOCK(key);
+  schedTasks     = pTasks;
+  schedTaskCount = (nTasks > HAL_SCHED_MAX_TASKS) ? HAL_SCHED_MAX_TASKS : nTasks;
+  schedReady     = 0;
+  for(i = 0; i < HAL_SCHED_MAX_TASKS; i++)
+  {
+    schedEvents[i]             = 0;
+    schedStats[i].runs         = 0;
+    schedStats[i].maxRunTicks  = 0;
+    schedStats[i].maxWaitTicks = 0;
+  }
+  schedTimerArmed = 0;
+  HAL_INT_UNLOCK(key);
+}
+
+/******************************************************************************
+ * @fn          halSchedRun
+ *
+ * @brief       Runs the tasks for ever, the main loop of the application.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      does not return
+ */
+void halSchedRun(void)
+{
+  istate_t key;
+  uint16   bit;
+  uint16   events;
+  uint8    task;
+  uint32   start;
+  uint32   ticks;
+  halSchedStats_t *pStats;
+
+  while(1)
+  {
+    HAL_INT_LOCK(key);
+    if(!schedReady)
+    {
+      HAL_INT_UNLOCK(key);
+      halSchedIdle();
+      continue;
+    }
+    // highest priority task ready, and the events it is run for
+    bit    = schedReady & (0 - schedReady);
+    task   = halSchedLowest(bit);
+    events = schedEvents[task];
+    schedEvents[task] = 0;
+    schedReady &= ~bit;
+    start  = halMcuGetTimeTicks();
+    ticks  = start - schedReadyTicks[task];
+    HAL_INT_UNLOCK(key);
+
+    pStats = &schedStats[task];
+    if(ticks > pStats->maxWaitTicks)
+    {
+      pStats->maxWaitTicks = ticks;
+    }
+    schedTasks[task](events);
+    ticks = halMcuGetTimeTicks() - start;
+    pStats->runs++;
+    if(ticks > pStats->maxRunTicks)
+    {
+      pStats->maxRunTicks = ticks;
+    }
+  }
+}
+
+/******************************************************************************
+ * @fn          halSchedPost
+ *
+ * @brief       Posts events to a task, which runs with them once no higher
+ *              priority task is ready. May be called from an ISR; a port
+ *              pin handler also calls HAL_DIGIO2_WAKE_ON_EXIT() to wake
+ *              the MCU.
+ *
+ * input parameters
+ *
+ * @param       task   - task number
+ * @param       events - bitmask, defined by the task; not 0
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halSchedPost(uint8 task, uint16 events)
+{
+  istate_t key;
+  uint16   bit;
+
+  if((task >= schedTaskCount) || !events)
+  {
+    return;
+  }
+  bit = schedBit[task];
+  HAL_INT_LOCK(key);
+  if(!(schedReady & bit))
+  {
+    schedReadyTicks[task] = halMcuGetTimeTicks();
+    schedReady |= bit;
+  }
+  schedEvents[task] |= events;
+  HAL_INT_UNLOCK(key);
+  halMcuEventSet(HAL_SCHED_MCU_EVENT);
+}
+
+/******************************************************************************
+ * @fn          halSchedClear
+ *
+ * @brief       Drops events posted to a task so far, e.g. edges of a radio
+ *              operation it is about to start over. A task left without
+ *              events is not run.
+ *
+ * input parameters
+ *
+ * @param       task   - task number
+ * @param       events - bitmask
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halSchedClear(uint8 task, uint16 events)
+{
+  istate_t key;
+
+  if(task >= schedTaskCount)
+  {
+    return;
+  }
+  HAL_INT_LOCK(key);
+  schedEvents[task] &= ~events;
+  if(!schedEvents[task])
+  {
+    schedReady &= ~schedBit[task];
+  }
+  HAL_INT_UNLOCK(key);
+}
+
+/******************************************************************************
+ * @fn          halSchedWait
+ *
+ * @brief       Sleeps until one of the events is posted to a task, and takes
+ *              the ones posted, without running other tasks meanwhile. For
+ *              a task waiting for the end of a short radio operation it
+ *              started; it holds up every other task while it waits.
+ *
+ * input parameters
+ *
+ * @param       task   - task number, usually the calling task
+ * @param       events - bitmask
+ *
+ * output parameters
+ *
+ * @return      the events taken
+ */
+uint16 halSchedWait(uint8 task, uint16 events)
+{
+  istate_t key;
+  uint16   taken;
+
+  if(task >= schedTaskCount)
+  {
+    return (0);
+  }
+  HAL_INT_LOCK(key);
+  while(!(schedEvents[task] & events))
+  {
+    HAL_INT_UNLOCK(key);
+    // a post after the check ends the wait at once
+    halMcuEventWait(HAL_SCHED_MCU_EVENT, 0);
+    HAL_INT_LOCK(key);
+  }
+  taken = schedEvents[task] & events;
+  schedEvents[task] &= ~taken;
+  if(!schedEvents[task])
+  {
+    schedReady &= ~schedBit[task];
+  }
+  HAL_INT_UNLOCK(key);
+  return (taken);
+}
+
+/******************************************************************************
+ * @fn          halSchedTimerStart
+ *
+ * @brief       Posts events to a task after ms milliseconds, or later if
+ *              tasks are still running then. Replaces a timer of the task
+ *              not yet due. Needs halMcuTimeInit().
+ *
+ * input parameters
+ *
+ * @param       task   - task number
+ * @param       events - bitmask
+ * @param       ms     - delay
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halSchedTimerStart(uint8 task, uint16 events, uint16 ms)
+{
+  if(task >= schedTaskCount)
+  {
+    return;
+  }
+  schedTimerDueMs[task]  = halMcuGetTimeMs() + ms;
+  schedTimerEvents[task] = events;
+  schedTimerArmed |= schedBit[task];
+}
+
+/******************************************************************************
+ * @fn          halSchedTimerStop
+ *
+ * @brief       Stops the timer of a task, if not yet due.
+ *
+ * input parameters
+ *
+ * @param       task - task number
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halSchedTimerStop(uint8 task)
+{
+  if(task < schedTaskCount)
+  {
+    schedTimerArmed &= ~schedBit[task];
+  }
+}
+
+/******************************************************************************
+ * @fn          halSchedGetTaskCount
+ *
+ * @brief       Returns the number of tasks in the table.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      tasks
+ */
+uint8 halSchedGetTaskCount(void)
+{
+  return (schedTaskCount);
+}
+
+/******************************************************************************
+ * @fn          halSchedGetStats
+ *
+ * @brief       Returns the counters of a task; halMcuTicksToUs() converts
+ *              the times.
+ *
+ * input parameters
+ *
+ * @param       task - task number
+ *
+ * output parameters
+ *
+ * @return      the counters, NULL for no task
+ */
+const halSchedStats_t *halSchedGetStats(uint8 task)
+{
+  return ((task < schedTaskCount) ? &schedStats[task] : NULL);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* Index of the lowest bit set in a non-zero mask */
+static uint8 halSchedLowest(uint16 mask)
+{
+  uint8 low = (uint8)mask;
+
+  if(low)
+  {
+    return ((low & 0x0F) ? lowestBitTbl[low & 0x0F] : 4 + lowestBitTbl[low >> 4]);
+  }
+  low = (uint8)(mask >> 8);
+  return ((low & 0x0F) ? 8 + lowestBitTbl[low & 0x0F] : 12 + lowestBitTbl[low >> 4]);
+}
+
+/* No task ready: posts the timers due, else sleeps until the next is due or
+ * a post
+ */
+static void halSchedIdle(void)
+{
+  uint16 armed = schedTimerArmed;
+  uint16 bit;
+  uint16 waitMs = 0;
+  uint8  task;
+  uint8  due = FALSE;
+  uint32 now;
+  int32  left;
+
+  if(armed)
+  {
+    now = halMcuGetTimeMs();
+    while(armed)
+    {
+      bit    = armed & (0 - armed);
+      armed &= ~bit;
+      task   = halSchedLowest(bit);
+      left   = (int32)(schedTimerDueMs[task] - now);
+      if(left <= 0)
+      {
+        schedTimerArmed &= ~bit;
+        halSchedPost(task, schedTimerEvents[task]);
+        due = TRUE;
+      }
+      else if(!waitMs || ((uint32)left < waitMs))
+      {
+        waitMs = (uint16)left;
+      }
+    }
+    if(due)
+    {
+      return;
+    }
+  }
+  halMcuEventWait(HAL_SCHED_MCU_EVENT, waitMs);
+}
@@ -0,0 +1,242 @@
+/******************************************************************************
+    Filename: cc11xL_config.c  
+    
+    Description: loads a SmartRF Studio register export into the CC11xL with
+                 one burst access per run of consecutive addresses and keeps
+                 a RAM shadow of the configuration registers, so settings can
+                 be read back without SPI traffic.
+                 
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_config.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static CC11xL_BURST_REGISTERS cc11xLShadow;
+/* One bit per shadowed register, set when the shadow holds the chip value */
+static uint8 cc11xLShadowValid[(sizeof(CC11xL_BURST_REGISTERS) + 7) / 8];
+
+/******************************************************************************
+ * MACROS
+ */
+#define SHADOW_IS_VALID(addr)   (cc11xLShadowValid[(addr) >> 3] & BV((addr) & 0x07))
+#define SHADOW_SET_VALID(addr)  st( cc11xLShadowValid[(addr) >> 3] |= BV((addr) & 0x07); )
+
+/******************************************************************************
+ * @fn          cc11xLConfigReset
+ *
+ * @brief       Resets the radio with SRES and invalidates the shadow, as all
+ *              registers are back at their reset values.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLConfigReset(void)
+{
+  uint8 i;
+
+  cc11xLSpiCmdStrobe(CC110L_SRES);
+  for(i = 0; i < sizeof(cc11xLShadowValid); i++)
+  {
+    cc11xLShadowValid[i] = 0;
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLConfigLoad
+ *
+ * @brief       Writes a register table to the radio. Entries with consecutive
+ *              addresses are staged in the shadow and written with a single
+ *              burst access, so a SmartRF Studio export (ascending address
+ *              order) costs one chip select cycle per run instead of one per
+ *              register. Addresses above the configuration space (PA_TABLE)
+ *              are written as they are and not shadowed.
+ *
+ * input parameters
+ *
+ * @param       pSettings - register table
+ * @param       count     - number of entries in the table
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLConfigLoad(const registerSetting_t *pSettings, uint16 count)
+{
+  uint16 i = 0;
+  uint8  first;
+  uint8  len;
+  uint8  data;
+
+  while(i < count)
+  {
+    first = (uint8)pSettings[i].addr;
+    if(first >= CC11XL_NUM_CONFIG_REGS)
+    {
+      data = pSettings[i].data;
+      cc11xLSpiWriteReg(first, &data, 1);
+      i++;
+      continue;
+    }
+
+    // collect the run of consecutive addresses starting at this entry
+    len = 0;
+    while((i < count) && (pSettings[i].addr == (uint16)(first + len))
+          && (pSettings[i].addr < CC11XL_NUM_CONFIG_REGS))
+    {
+      cc11xLShadow[first + len] = pSettings[i].data;
+      SHADOW_SET_VALID(first + len);
+      len++;
+      i++;
+    }
+    cc11xLSpiWriteReg(first, &cc11xLShadow[first], len);
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLConfigGet
+ *
+ * @brief       Returns the value of a configuration register from the shadow.
+ *              A register not written since the last reset is read over SPI
+ *              once and then cached.
+ *
+ * input parameters
+ *
+ * @param       addr - configuration register address (0x00 - 0x2E)
+ *
+ * output parameters
+ *
+ * @return      register value
+ */
+uint8 cc11xLConfigGet(uint8 addr)
+{
+  uint8 data;
+
+  if(addr >= CC11XL_NUM_CONFIG_REGS)
+  {
+    cc11xLSpiReadReg(addr, &data, 1);
+    return (data);
+  }
+  if(!SHADOW_IS_VALID(addr))
+  {
+    cc11xLSpiReadReg(addr, &cc11xLShadow[addr], 1);
+    SHADOW_SET_VALID(addr);
+  }
+  return (cc11xLShadow[addr]);
+}
+
+/******************************************************************************
+ * @fn          cc11xLConfigSet
+ *
+ * @brief       Writes a configuration register through the shadow. The SPI
+ *              access is skipped when the radio already holds the value.
+ *
+ * input parameters
+ *
+ * @param       addr  - configuration register address (0x00 - 0x2E)
+ * @param       value - value to write
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLConfigSet(uint8 addr, uint8 value)
+{
+  if(addr >= CC11XL_NUM_CONFIG_REGS)
+  {
+    cc11xLSpiWriteReg(addr, &value, 1);
+    return;
+  }
+  if(SHADOW_IS_VALID(addr) && (cc11xLShadow[addr] == value))
+  {
+    return;
+  }
+  cc11xLShadow[addr] = value;
+  SHADOW_SET_VALID(addr);
+  cc11xLSpiWriteReg(addr, &cc11xLShadow[addr], 1);
+}
+
+/******************************************************************************
+ * @fn          cc11xLConfigWrite
+ *
+ * @brief       Writes a run of consecutive configuration registers through
+ *              the shadow with a single burst access. The SPI access is
+ *              skipped when the radio already holds all the values.
+ *
+ * input parameters
+ *
+ * @param       addr  - first register address (0x00 - 0x2E)
+ * @param       pData - values to write
+ * @param       len   - number of consecutive registers
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLConfigWrite(uint8 addr, const uint8 *pData, uint8 len)
+{
+  uint8 i;
+  uint8 changed = FALSE;
+
+  if((uint16)addr + len > CC11XL_NUM_CONFIG_REGS)
+  {
+    return;
+  }
+  for(i = 0; i < len; i++)
+  {
+    if(!SHADOW_IS_VALID(addr + i) || (cc11xLShadow[addr + i] != pData[i]))
+    {
+      cc11xLShadow[addr + i] = pData[i];
+      SHADOW_SET_VALID(addr + i);
+      changed = TRUE;
+    }
+  }
+  if(changed)
+  {
+    cc11xLSpiWriteReg(addr, &cc11xLShadow[addr], len);
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLConfigRefresh
+ *
+ * @brief       Reads a run of configuration registers back into the shadow,
+ *              for registers the radio updates itself, e.g. FSCAL3..FSCAL1
+ *              after a calibration.
+ *
+ * input parameters
+ *
+ * @param       addr - first register address (0x00 - 0x2E)
+ * @param       len  - number of consecutive registers
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLConfigRefresh(uint8 addr, uint8 len)
+{
+  uint8 i;
+
+  if((uint16)addr + len > CC11XL_NUM_CONFIG_REGS)
+  {
+    return;
+  }
+  cc11xLSpiReadReg(addr, &cc11xLShadow[addr], len);
+  for(i = addr; i < addr + len; i++)
+  {
+    SHADOW_SET_VALID(i);
+  }
+}
@@ -0,0 +1,41 @@
+/******************************************************************************
+    Filename: cc11xL_config.h  
+    
+    Description: header file for loading a CC11xL register configuration in
+                 burst runs and keeping a RAM shadow of the written values.
+                 
+*******************************************************************************/
+#ifndef CC11xL_CONFIG_H
+#define CC11xL_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "hal_msp_exp430g2_spi.h"
+#include "cc11xL_spi.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Configuration registers 0x00 - 0x2E are shadowed */
+#define CC11XL_NUM_CONFIG_REGS      (sizeof(CC11xL_BURST_REGISTERS))
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+void  cc11xLConfigReset(void);
+void  cc11xLConfigLoad(const registerSetting_t *pSettings, uint16 count);
+uint8 cc11xLConfigGet(uint8 addr);
+void  cc11xLConfigSet(uint8 addr, uint8 value);
+void  cc11xLConfigWrite(uint8 addr, const uint8 *pData, uint8 len);
+void  cc11xLConfigRefresh(uint8 addr, uint8 len);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_CONFIG_H
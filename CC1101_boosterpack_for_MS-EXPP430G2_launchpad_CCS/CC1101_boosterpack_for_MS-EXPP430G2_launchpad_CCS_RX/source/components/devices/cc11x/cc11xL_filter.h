@@ -0,0 +1,75 @@
+/******************************************************************************
+    Filename: cc11xL_filter.h
+
+    Description: header file for hardware packet filtering of the CC11xL:
+                 address check and CRC autoflush, with frames read whole
+                 out of the RX FIFO.
+
+*******************************************************************************/
+#ifndef CC11xL_FILTER_H
+#define CC11xL_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+#include "cc11xL_packet.h"
+#include "cc11xL_stream.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* PKTCTRL1 fields */
+#define CC11XL_PKTCTRL1_ADR_CHK_BM      0x03
+#define CC11XL_PKTCTRL1_APPEND_STATUS   0x04
+#define CC11XL_PKTCTRL1_CRC_AUTOFLUSH   0x08
+
+/* PKTCTRL1 ADR_CHK modes: which address byte, the first after the length
+ * byte, a frame must carry to be kept
+ */
+#define CC11XL_ADR_CHK_NONE             0x00  /* any, no address byte checked */
+#define CC11XL_ADR_CHK_ADDR             0x01  /* ADDR only */
+#define CC11XL_ADR_CHK_ADDR_BCAST0      0x02  /* ADDR or 0x00 */
+#define CC11XL_ADR_CHK_ADDR_BCAST       0x03  /* ADDR, 0x00 or 0xFF */
+
+/* Broadcast addresses */
+#define CC11XL_ADDR_BCAST0              0x00
+#define CC11XL_ADDR_BCAST               0xFF
+
+/* GDOx_CFG: a packet with CRC OK is in the RX FIFO, until its first byte
+ * is read
+ */
+#define CC11XL_GDO_CRC_OK               0x07
+
+/* Longest length byte: with CRC autoflush the frame and its status bytes
+ * must fit the RX FIFO
+ */
+#define CC11XL_FILTER_MAX_LEN           (CC11XL_FIFO_SIZE - 1 - CC11XL_STATUS_LEN)
+
+/* What the GDO wakes the MCU for, cc11xLFilterRxStart() */
+#define CC11XL_FILTER_WAKE_GOOD         0   /* frames with CRC OK only */
+#define CC11XL_FILTER_WAKE_END          1   /* the end of every frame, to count the dropped ones */
+
+/* Return values of cc11xLFilterRxRead() */
+#define CC11XL_FILTER_FRAME             0   /* frame read */
+#define CC11XL_FILTER_FLUSHED           1   /* frame dropped by the radio, nothing read */
+#define CC11XL_FILTER_ERROR             2   /* no complete frame or FIFO overflow, flush */
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+void  cc11xLFilterSet(uint8 addr, uint8 adrChk);
+void  cc11xLFilterOff(void);
+uint8 cc11xLFilterRxStart(uint8 iocfgAddr, uint8 wake, uint8 maxLen);
+uint8 cc11xLFilterRxRead(uint8 *pFrame, cc11xLPacket_t *pPacket);
+void  cc11xLFilterRxEnd(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_FILTER_H
@@ -0,0 +1,57 @@
+/******************************************************************************
+    Filename: cc11xL_fscal.h  
+    
+    Description: header file for the per-channel frequency synthesizer
+                 calibration cache of the CC11xL.
+                 
+*******************************************************************************/
+#ifndef CC11xL_FSCAL_H
+#define CC11xL_FSCAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Channels of the hop set, 4 bytes of RAM each */
+#ifndef CC11XL_FSCAL_MAX_CHANNELS
+#define CC11XL_FSCAL_MAX_CHANNELS       8
+#endif
+
+/* Channel switches a calibration is used for before it is redone */
+#ifndef CC11XL_FSCAL_MAX_AGE
+#define CC11XL_FSCAL_MAX_AGE            200
+#endif
+
+/* Temperature drift in degrees C since calibration that invalidates the cache */
+#ifndef CC11XL_FSCAL_TEMP_DELTA
+#define CC11XL_FSCAL_TEMP_DELTA         20
+#endif
+
+/* MCSM0.FS_AUTOCAL */
+#define CC11XL_MCSM0_FS_AUTOCAL_BM      0x30
+
+/* Returned by cc11xLFscalGetChannel() before the first switch */
+#define CC11XL_FSCAL_NO_CHANNEL         0xFF
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+uint8      cc11xLFscalInit(const uint32 *pFreqs, uint8 numChannels, int8 tempC);
+rfStatus_t cc11xLFscalSetChannel(uint8 channel);
+uint8      cc11xLFscalGetChannel(void);
+void       cc11xLFscalSetTemperature(int8 tempC);
+void       cc11xLFscalInvalidate(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_FSCAL_H
@@ -0,0 +1,97 @@
+/******************************************************************************
+    Filename: cc11xL_packet.c
+
+    Description: received frame descriptors. A frame read out of the RX FIFO
+                 is | length | payload | RSSI | LQI / CRC_OK | with status
+                 appending on; these functions turn it, or just the two
+                 status bytes of a streamed frame, into a cc11xLPacket_t
+                 with the RSSI in dBm, so applications and the rate and
+                 statistics modules share one conversion.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_packet.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * @fn          cc11xLPacketRssiDbm
+ *
+ * @brief       Converts an RSSI reading, appended to a frame or from the
+ *              RSSI status register, to dBm. Readings below -128 dBm, far
+ *              under the sensitivity, are clipped.
+ *
+ * input parameters
+ *
+ * @param       rssi - RSSI, two's complement in half dB steps
+ *
+ * output parameters
+ *
+ * @return      RSSI in dBm
+ */
+int8 cc11xLPacketRssiDbm(uint8 rssi)
+{
+  int16 dbm = (int16)(int8)rssi / 2 - CC11XL_RSSI_OFFSET;
+
+  return ((dbm < -128) ? -128 : (int8)dbm);
+}
+
+/******************************************************************************
+ * @fn          cc11xLPacketSetStatus
+ *
+ * @brief       Fills the link quality of a descriptor from the status bytes
+ *              appended to the frame.
+ *
+ * input parameters
+ *
+ * @param       pStatus - the two status bytes, RSSI and LQI / CRC_OK
+ *
+ * output parameters
+ *
+ * @param       pPacket - gets rssiDbm, lqi and crcOk
+ *
+ * @return      void
+ */
+void cc11xLPacketSetStatus(cc11xLPacket_t *pPacket, const uint8 *pStatus)
+{
+  pPacket->rssiDbm = cc11xLPacketRssiDbm(pStatus[0]);
+  pPacket->lqi     = pStatus[1] & CC11XL_STATUS_LQI_BM;
+  pPacket->crcOk   = (pStatus[1] & CC11XL_STATUS_CRC_OK_BM) ? TRUE : FALSE;
+}
+
+/******************************************************************************
+ * @fn          cc11xLPacketParse
+ *
+ * @brief       Parses a frame read out of the RX FIFO in one piece. Nothing
+ *              is copied, the payload pointer points into pFrame.
+ *
+ * input parameters
+ *
+ * @param       pFrame - frame, starting with the length byte
+ * @param       len    - number of bytes in pFrame, from RXBYTES
+ *
+ * output parameters
+ *
+ * @param       pPacket - the descriptor
+ *
+ * @return      SUCCESS, or FAILED if len does not match the length byte
+ */
+uint8 cc11xLPacketParse(cc11xLPacket_t *pPacket, uint8 *pFrame, uint16 len)
+{
+  if((len < 1 + CC11XL_STATUS_LEN) || (pFrame[0] != len - 1 - CC11XL_STATUS_LEN))
+  {
+    pPacket->pPayload = NULL;
+    pPacket->length   = 0;
+    pPacket->crcOk    = FALSE;
+    return (FAILED);
+  }
+  pPacket->pPayload = &pFrame[1];
+  pPacket->length   = pFrame[0];
+  cc11xLPacketSetStatus(pPacket, &pFrame[len - CC11XL_STATUS_LEN]);
+  return (SUCCESS);
+}
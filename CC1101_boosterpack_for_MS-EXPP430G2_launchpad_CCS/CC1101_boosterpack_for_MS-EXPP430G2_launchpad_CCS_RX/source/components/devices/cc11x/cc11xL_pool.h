@@ -0,0 +1,77 @@
+/******************************************************************************
+    Filename: cc11xL_pool.h
+
+    Description: header file for the frame buffer pool of the CC11xL: fixed
+                 size blocks for frames read whole out of the RX FIFO,
+                 passed between the driver and the application by handle.
+
+*******************************************************************************/
+#ifndef CC11xL_POOL_H
+#define CC11xL_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+#include "cc11xL_filter.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Blocks in the pool */
+#ifndef CC11XL_POOL_BLOCKS
+#define CC11XL_POOL_BLOCKS              4
+#endif
+
+/* Longest length byte a block holds, up to CC11XL_FILTER_MAX_LEN; pass it
+ * to cc11xLFilterRxStart() so the radio drops longer frames
+ */
+#ifndef CC11XL_POOL_MAX_LEN
+#define CC11XL_POOL_MAX_LEN             30
+#endif
+
+/* Block size: length byte, payload and status bytes */
+#define CC11XL_POOL_BLOCK_SIZE          (1 + CC11XL_POOL_MAX_LEN + CC11XL_STATUS_LEN)
+
+/* Handle of no block: the pool was empty */
+#define CC11XL_POOL_NONE                0xFF
+
+#if (CC11XL_POOL_BLOCKS < 1) || (CC11XL_POOL_BLOCKS >= CC11XL_POOL_NONE)
+#error "CC11XL_POOL_BLOCKS must be 1 to 254"
+#endif
+#if CC11XL_POOL_MAX_LEN > CC11XL_FILTER_MAX_LEN
+#error "CC11XL_POOL_MAX_LEN must fit the RX FIFO, see CC11XL_FILTER_MAX_LEN"
+#endif
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* Block handle, 0 to CC11XL_POOL_BLOCKS - 1 */
+typedef uint8 cc11xLBuf_t;
+
+/* Pool counters */
+typedef struct
+{
+  uint16 allocs;                            /* blocks handed out, wraps */
+  uint16 failures;                          /* allocations from an empty pool */
+  uint8  minFree;                           /* fewest blocks left free */
+}cc11xLPoolStats_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+cc11xLBuf_t cc11xLPoolAlloc(void);
+void        cc11xLPoolFree(cc11xLBuf_t buf);
+uint8      *cc11xLPoolData(cc11xLBuf_t buf);
+uint8       cc11xLPoolFreeCount(void);
+const cc11xLPoolStats_t *cc11xLPoolGetStats(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_POOL_H
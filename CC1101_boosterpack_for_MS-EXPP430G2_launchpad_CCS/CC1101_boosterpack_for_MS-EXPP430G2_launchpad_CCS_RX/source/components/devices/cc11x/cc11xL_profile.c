@@ -0,0 +1,138 @@
+/******************************************************************************
+    Filename: cc11xL_profile.c  
+    
+    Description: data rate profiles. A profile holds only the modem registers
+                 that change with the data rate, 12 bytes against the 30 or
+                 so of a full SmartRF Studio export; the base configuration
+                 supplies the rest. The registers fall into six runs of
+                 consecutive addresses, each written with one burst access
+                 through the configuration shadow, and runs that already
+                 hold the values of the new profile are skipped.
+                 
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_profile.h"
+#include "cc11xL_config.h"
+#include "cc11xL_radio.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+#define PROFILE_NUM_RUNS            6
+
+/* MDMCFG1 NUM_PREAMBLE, MDMCFG2 SYNC_MODE and PKTCTRL0 CRC_EN fields */
+#define PROFILE_NUM_PREAMBLE(mdmcfg1)   (((mdmcfg1) >> 4) & 0x07)
+#define PROFILE_SYNC_MODE(mdmcfg2)      ((mdmcfg2) & 0x03)
+#define PROFILE_CRC_EN_BM               0x04
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+/* First address and length of each run, in the order of cc11xLProfile_t.regs */
+static const uint8 profileRuns[PROFILE_NUM_RUNS][2] = {
+  {CC110L_FSCTRL1,  1},             /* FSCTRL1 */
+  {CC110L_MDMCFG4,  2},             /* MDMCFG4, MDMCFG3 */
+  {CC110L_DEVIATN,  1},             /* DEVIATN */
+  {CC110L_FOCCFG,   5},             /* FOCCFG, BSCFG, AGCCTRL2 - AGCCTRL0 */
+  {CC110L_FREND1,   1},             /* FREND1 */
+  {CC110L_TEST2,    2},             /* TEST2, TEST1 */
+};
+
+static const cc11xLProfile_t *pProfileCurrent;
+
+/* Preamble bytes for each NUM_PREAMBLE setting */
+static const uint8 profilePreambleBytes[8] = {2, 3, 4, 6, 8, 12, 16, 24};
+
+/******************************************************************************
+ * @fn          cc11xLProfileSelect
+ *
+ * @brief       Switches the radio to a data rate profile. The radio is put in
+ *              IDLE, where the modem may be reconfigured; enter RX or TX
+ *              afterwards as usual. Both ends of a link must use the same
+ *              profile.
+ *
+ * input parameters
+ *
+ * @param       pProfile - profile to use
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLProfileSelect(const cc11xLProfile_t *pProfile)
+{
+  const uint8 *pRegs = pProfile->regs;
+  uint8        i;
+
+  if(cc11xLRadioGetState() != CC11XL_MARC_IDLE)
+  {
+    cc11xLRadioIdle();
+  }
+  for(i = 0; i < PROFILE_NUM_RUNS; i++)
+  {
+    cc11xLConfigWrite(profileRuns[i][0], pRegs, profileRuns[i][1]);
+    pRegs += profileRuns[i][1];
+  }
+  pProfileCurrent = pProfile;
+  return (cc11xLGetCachedStatus());
+}
+
+/******************************************************************************
+ * @fn          cc11xLProfileGet
+ *
+ * @brief       Returns the profile in use.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      profile, NULL before the first cc11xLProfileSelect()
+ */
+const cc11xLProfile_t *cc11xLProfileGet(void)
+{
+  return (pProfileCurrent);
+}
+
+/******************************************************************************
+ * @fn          cc11xLProfileAirTimeUs
+ *
+ * @brief       Returns the time a frame takes on air at the data rate of the
+ *              profile in use: preamble, sync word, the frame and the CRC,
+ *              as the packet handler is configured.
+ *
+ * input parameters
+ *
+ * @param       frameLen - bytes written to the TX FIFO, length byte included
+ *
+ * output parameters
+ *
+ * @return      air time in microseconds, 0 before the first
+ *              cc11xLProfileSelect()
+ */
+uint32 cc11xLProfileAirTimeUs(uint16 frameLen)
+{
+  uint16 bytes;
+  uint8  sync;
+
+  if(pProfileCurrent == NULL)
+  {
+    return (0);
+  }
+  sync  = PROFILE_SYNC_MODE(cc11xLConfigGet(CC110L_MDMCFG2));
+  bytes = frameLen + profilePreambleBytes[PROFILE_NUM_PREAMBLE(cc11xLConfigGet(CC110L_MDMCFG1))];
+  bytes += (sync == 0) ? 0 : ((sync == 3) ? 4 : 2);
+  if(cc11xLConfigGet(CC110L_PKTCTRL0) & PROFILE_CRC_EN_BM)
+  {
+    bytes += 2;
+  }
+  return ((uint32)bytes * 8000000UL / pProfileCurrent->dataRate);
+}
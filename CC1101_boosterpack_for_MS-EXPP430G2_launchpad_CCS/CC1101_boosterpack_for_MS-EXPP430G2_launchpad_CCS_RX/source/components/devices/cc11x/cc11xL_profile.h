@@ -0,0 +1,54 @@
+/******************************************************************************
+    Filename: cc11xL_profile.h  
+    
+    Description: header file for switching the CC11xL between data rate
+                 profiles at run time.
+                 
+*******************************************************************************/
+#ifndef CC11xL_PROFILE_H
+#define CC11xL_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Registers set by a profile, in the order of cc11xLProfile_t.regs:
+ * FSCTRL1, MDMCFG4, MDMCFG3, DEVIATN, FOCCFG, BSCFG, AGCCTRL2, AGCCTRL1,
+ * AGCCTRL0, FREND1, TEST2, TEST1
+ */
+#define CC11XL_PROFILE_NUM_REGS     12
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* A data rate profile: the modem registers that differ between SmartRF
+ * Studio exports at different data rates. All other registers keep the
+ * base configuration.
+ */
+typedef struct
+{
+  uint32 dataRate;                          /* bit/s */
+  int8   sensitivity;                       /* dBm at 1% PER, typical */
+  uint8  regs[CC11XL_PROFILE_NUM_REGS];
+}cc11xLProfile_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+rfStatus_t             cc11xLProfileSelect(const cc11xLProfile_t *pProfile);
+const cc11xLProfile_t *cc11xLProfileGet(void);
+uint32                 cc11xLProfileAirTimeUs(uint16 frameLen);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_PROFILE_H
@@ -0,0 +1,251 @@
+/******************************************************************************
+    Filename: cc11xL_radio.c  
+    
+    Description: radio state manager. The end of packet behaviour is set in
+                 MCSM1 (RXOFF_MODE / TXOFF_MODE), so the radio can go back to
+                 RX after a received packet, or to RX after a sent one, by
+                 itself. This saves the strobe per packet and, with
+                 FS_AUTOCAL set to calibrate when leaving IDLE, the
+                 calibration in between. The main radio control state is
+                 tracked from the strobes issued and the packets ended, so
+                 redundant strobes are skipped without reading MARCSTATE.
+                 
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_radio.h"
+#include "cc11xL_config.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 radioState = CC11XL_MARC_IDLE;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static uint8 cc11xLRadioOffState(uint8 offMode);
+
+/******************************************************************************
+ * @fn          cc11xLRadioSetMode
+ *
+ * @brief       Sets the states entered at the end of a received and a sent
+ *              packet. The other MCSM1 fields are kept; no SPI access is
+ *              made when the mode is already set.
+ *
+ * input parameters
+ *
+ * @param       mode - CC11XL_RADIO_MODE_IDLE, CC11XL_RADIO_MODE_RX_CONT or
+ *                     CC11XL_RADIO_MODE_TX_LISTEN
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLRadioSetMode(uint8 mode)
+{
+  uint8 mcsm1 = cc11xLConfigGet(CC110L_MCSM1);
+
+  cc11xLConfigSet(CC110L_MCSM1, (mcsm1 & ~(CC11XL_MCSM1_RXOFF_BM | CC11XL_MCSM1_TXOFF_BM)) | mode);
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioRx
+ *
+ * @brief       Enters RX. The SRX strobe is skipped if the radio is in RX
+ *              already, e.g. back there on its own after a packet.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLRadioRx(void)
+{
+  if(radioState == CC11XL_MARC_RX)
+  {
+    return (cc11xLGetCachedStatus());
+  }
+  radioState = CC11XL_MARC_RX;
+  return (cc11xLSpiCmdStrobe(CC110L_SRX));
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioTx
+ *
+ * @brief       Enters TX to send the packet in the TX FIFO.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLRadioTx(void)
+{
+  radioState = CC11XL_MARC_TX;
+  return (cc11xLSpiCmdStrobe(CC110L_STX));
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioIdle
+ *
+ * @brief       Enters IDLE, also to leave the FIFO error states before the
+ *              FIFOs are flushed.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLRadioIdle(void)
+{
+  radioState = CC11XL_MARC_IDLE;
+  return (cc11xLSpiCmdStrobe(CC110L_SIDLE));
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioPacketEnd
+ *
+ * @brief       Follows the transition the radio made at the end of a packet,
+ *              as set in MCSM1. Call once per packet sent or received.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLRadioPacketEnd(void)
+{
+  uint8 mcsm1 = cc11xLConfigGet(CC110L_MCSM1);
+
+  if(radioState == CC11XL_MARC_RX)
+  {
+    radioState = cc11xLRadioOffState(CC11XL_MCSM1_RXOFF(mcsm1));
+  }
+  else if(radioState == CC11XL_MARC_TX)
+  {
+    radioState = cc11xLRadioOffState(CC11XL_MCSM1_TXOFF(mcsm1));
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioGetState
+ *
+ * @brief       Returns the tracked main radio control state.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      CC11XL_MARC_x
+ */
+uint8 cc11xLRadioGetState(void)
+{
+  return (radioState);
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioReadState
+ *
+ * @brief       Reads MARCSTATE and takes it as the tracked state, e.g. after
+ *              a FIFO error. Transitional states (calibration, settling)
+ *              are returned as read.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      CC11XL_MARC_x
+ */
+uint8 cc11xLRadioReadState(void)
+{
+  uint8 marcState;
+
+  cc11xLSpiReadReg(CC110L_MARCSTATE, &marcState, 1);
+  radioState = marcState & CC11XL_MARC_STATE_BM;
+  return (radioState);
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioRxContinuous
+ *
+ * @brief       Receives packet after packet: the radio stays in RX at the end
+ *              of each packet, so only the first call strobes SRX.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLRadioRxContinuous(void)
+{
+  cc11xLRadioSetMode(CC11XL_RADIO_MODE_RX_CONT);
+  return (cc11xLRadioRx());
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioTxThenListen
+ *
+ * @brief       Sends the packet in the TX FIFO, after which the radio goes
+ *              to RX by itself, e.g. to wait for a reply, and stays there
+ *              after received packets.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLRadioTxThenListen(void)
+{
+  cc11xLRadioSetMode(CC11XL_RADIO_MODE_TX_LISTEN);
+  return (cc11xLRadioTx());
+}
+
+/******************************************************************************
+ * @fn          cc11xLRadioOffState
+ *
+ * @brief       Maps an RXOFF_MODE / TXOFF_MODE value to the state entered.
+ *
+ * input parameters
+ *
+ * @param       offMode - 0 IDLE, 1 FSTXON, 2 TX, 3 RX
+ *
+ * output parameters
+ *
+ * @return      CC11XL_MARC_x
+ */
+static uint8 cc11xLRadioOffState(uint8 offMode)
+{
+  static const uint8 offState[4] = {CC11XL_MARC_IDLE, CC11XL_MARC_FSTXON,
+                                    CC11XL_MARC_TX, CC11XL_MARC_RX};
+
+  return (offState[offMode & 0x03]);
+}
@@ -0,0 +1,321 @@
+/******************************************************************************
+    Filename: cc11xL_rate.c  
+    
+    Description: adaptive data rate control. The receiving end of a link
+                 feeds the RSSI, LQI and CRC result of each frame it
+                 receives, and the number of frames it knows were missed,
+                 into windows of CC11XL_RATE_WINDOW frames. It picks the
+                 fastest profile of a table in ascending data rate order
+                 that keeps the packet error rate under the target:
+
+                 - too many bad or missed frames in a window, or a mean RSSI
+                   too close to the sensitivity of the profile, step down at
+                   once
+                 - a number of clean windows in a row, with the mean RSSI
+                   well above the sensitivity of the next profile and a good
+                   mean LQI, step up
+
+                 The different margins and the clean window count keep the
+                 rate from flapping. A step up that fails in its first window
+                 doubles the clean windows needed for the next one.
+
+                 A change is only proposed; the caller tells the peer with a
+                 control frame (cc11xLRateBuildControl()) and then switches
+                 with cc11xLRateApply(). The peer switches when it parses the
+                 frame.
+                 
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_rate.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static const cc11xLProfile_t *pRateProfiles;
+static uint8  rateNumProfiles;
+static uint8  rateProfile;
+
+/* Current window */
+static uint8  rateFrames;       /* frames received or missed */
+static uint8  rateBad;          /* frames missed or with a bad CRC */
+static uint8  rateMeasured;     /* frames with status bytes */
+static int16  rateRssiSum;
+static uint16 rateLqiSum;
+
+/* Hysteresis */
+static uint8  rateUpStreak;
+static uint8  rateUpWindows = CC11XL_RATE_UP_WINDOWS;
+static uint8  rateProbe;        /* first window after a step up */
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static uint8 cc11xLRateEvaluate(void);
+static void  cc11xLRateNewWindow(void);
+
+/******************************************************************************
+ * @fn          cc11xLRateInit
+ *
+ * @brief       Sets the profile table and the profile the link starts at.
+ *              The profile is not selected here.
+ *
+ * input parameters
+ *
+ * @param       pProfiles   - profiles in ascending data rate order
+ * @param       numProfiles - number of profiles
+ * @param       profile     - index of the profile in use
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLRateInit(const cc11xLProfile_t *pProfiles, uint8 numProfiles, uint8 profile)
+{
+  pRateProfiles   = pProfiles;
+  rateNumProfiles = numProfiles;
+  rateProfile     = profile;
+  rateUpStreak    = 0;
+  rateUpWindows   = CC11XL_RATE_UP_WINDOWS;
+  rateProbe       = FALSE;
+  cc11xLRateNewWindow();
+}
+
+/******************************************************************************
+ * @fn          cc11xLRateUpdate
+ *
+ * @brief       Adds a received frame, good or with a bad CRC.
+ *
+ * input parameters
+ *
+ * @param       pPacket - the frame, see cc11xLPacketSetStatus()
+ *
+ * output parameters
+ *
+ * @return      profile to change to, or CC11XL_RATE_NO_CHANGE
+ */
+uint8 cc11xLRateUpdate(const cc11xLPacket_t *pPacket)
+{
+  rateFrames++;
+  rateMeasured++;
+  if(!pPacket->crcOk)
+  {
+    rateBad++;
+  }
+  rateRssiSum += pPacket->rssiDbm;
+  rateLqiSum  += pPacket->lqi;
+
+  return (cc11xLRateEvaluate());
+}
+
+/******************************************************************************
+ * @fn          cc11xLRateMissed
+ *
+ * @brief       Adds frames known to be lost, e.g. from a gap in a sequence
+ *              number.
+ *
+ * input parameters
+ *
+ * @param       count - number of frames missed
+ *
+ * output parameters
+ *
+ * @return      profile to change to, or CC11XL_RATE_NO_CHANGE
+ */
+uint8 cc11xLRateMissed(uint16 count)
+{
+  if(count == 0)
+  {
+    return (CC11XL_RATE_NO_CHANGE);
+  }
+  if(count > CC11XL_RATE_WINDOW)
+  {
+    count = CC11XL_RATE_WINDOW;
+  }
+  rateFrames += (uint8)count;
+  rateBad    += (uint8)count;
+
+  return (cc11xLRateEvaluate());
+}
+
+/******************************************************************************
+ * @fn          cc11xLRateApply
+ *
+ * @brief       Switches the radio to a profile, after the peer was told or
+ *              on a control frame from it, and starts a new window.
+ *
+ * input parameters
+ *
+ * @param       profile - index into the profile table
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLRateApply(uint8 profile)
+{
+  if(profile >= rateNumProfiles)
+  {
+    return;
+  }
+  cc11xLProfileSelect(&pRateProfiles[profile]);
+  rateProbe    = (profile > rateProfile);
+  rateProfile  = profile;
+  rateUpStreak = 0;
+  cc11xLRateNewWindow();
+}
+
+/******************************************************************************
+ * @fn          cc11xLRateGetProfile
+ *
+ * @brief       Returns the profile in use.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      index into the profile table
+ */
+uint8 cc11xLRateGetProfile(void)
+{
+  return (rateProfile);
+}
+
+/******************************************************************************
+ * @fn          cc11xLRateBuildControl
+ *
+ * @brief       Builds the control frame that tells the peer to change to a
+ *              profile, ready for the TX FIFO.
+ *
+ * input parameters
+ *
+ * @param       pFrame  - buffer of CC11XL_RATE_CTRL_LEN + 1 bytes
+ * @param       profile - index into the profile table
+ *
+ * output parameters
+ *
+ * @return      frame length including the length byte
+ */
+uint8 cc11xLRateBuildControl(uint8 *pFrame, uint8 profile)
+{
+  pFrame[0] = CC11XL_RATE_CTRL_LEN;
+  pFrame[1] = CC11XL_RATE_CTRL_SET;
+  pFrame[2] = profile;
+  return (CC11XL_RATE_CTRL_LEN + 1);
+}
+
+/******************************************************************************
+ * @fn          cc11xLRateParseControl
+ *
+ * @brief       Checks a received frame for a control frame.
+ *
+ * input parameters
+ *
+ * @param       pFrame - frame, starting with the length byte
+ * @param       len    - number of bytes in pFrame
+ *
+ * output parameters
+ *
+ * @return      profile to change to, or CC11XL_RATE_NO_CHANGE
+ */
+uint8 cc11xLRateParseControl(const uint8 *pFrame, uint8 len)
+{
+  if((len < CC11XL_RATE_CTRL_LEN + 1) || (pFrame[0] != CC11XL_RATE_CTRL_LEN)
+     || (pFrame[1] != CC11XL_RATE_CTRL_SET) || (pFrame[2] >= rateNumProfiles))
+  {
+    return (CC11XL_RATE_NO_CHANGE);
+  }
+  return (pFrame[2]);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* Decides on a change after each frame. Starts a new window when it
+ * proposes one or when the window is complete.
+ */
+static uint8 cc11xLRateEvaluate(void)
+{
+  int16 rssi;
+  uint8 lqi;
+  uint8 next = CC11XL_RATE_NO_CHANGE;
+
+  if(rateBad >= CC11XL_RATE_BAD_MAX)
+  {
+    // a step up that failed at once: wait longer before the next one
+    if(rateProbe && (rateUpWindows < CC11XL_RATE_UP_WINDOWS_MAX))
+    {
+      rateUpWindows <<= 1;
+    }
+    rateUpStreak = 0;
+    if(rateProfile > 0)
+    {
+      next = rateProfile - 1;
+    }
+    cc11xLRateNewWindow();
+    return (next);
+  }
+  if(rateFrames < CC11XL_RATE_WINDOW)
+  {
+    return (next);
+  }
+  if(rateMeasured == 0)
+  {
+    cc11xLRateNewWindow();
+    return (next);
+  }
+
+  rssi = rateRssiSum / rateMeasured;
+  lqi  = (uint8)(rateLqiSum / rateMeasured);
+  if(rateProbe)
+  {
+    // the step up held for a window
+    rateProbe = FALSE;
+    if(rateUpWindows > CC11XL_RATE_UP_WINDOWS)
+    {
+      rateUpWindows >>= 1;
+    }
+  }
+
+  if(rssi < pRateProfiles[rateProfile].sensitivity + CC11XL_RATE_DOWN_MARGIN)
+  {
+    rateUpStreak = 0;
+    if(rateProfile > 0)
+    {
+      next = rateProfile - 1;
+    }
+  }
+  else if((rateBad == 0) && (rateProfile + 1 < rateNumProfiles)
+          && (rssi >= pRateProfiles[rateProfile + 1].sensitivity + CC11XL_RATE_UP_MARGIN)
+          && (lqi <= CC11XL_RATE_LQI_UP))
+  {
+    if(++rateUpStreak >= rateUpWindows)
+    {
+      rateUpStreak = 0;
+      next = rateProfile + 1;
+    }
+  }
+  else
+  {
+    rateUpStreak = 0;
+  }
+  cc11xLRateNewWindow();
+  return (next);
+}
+
+static void cc11xLRateNewWindow(void)
+{
+  rateFrames   = 0;
+  rateBad      = 0;
+  rateMeasured = 0;
+  rateRssiSum  = 0;
+  rateLqiSum   = 0;
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+    Filename: cc11xL_rate.h  
+    
+    Description: header file for adaptive data rate control of the CC11xL,
+                 driven by the status bytes appended to received frames.
+                 
+*******************************************************************************/
+#ifndef CC11xL_RATE_H
+#define CC11xL_RATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_profile.h"
+#include "cc11xL_packet.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Frames per evaluation window */
+#ifndef CC11XL_RATE_WINDOW
+#define CC11XL_RATE_WINDOW          16
+#endif
+
+/* Bad or missed frames in a window that step the rate down, 2 of 16 is a
+ * PER target of about 10%
+ */
+#ifndef CC11XL_RATE_BAD_MAX
+#define CC11XL_RATE_BAD_MAX         2
+#endif
+
+/* Clean windows in a row before the rate steps up; doubled, up to
+ * CC11XL_RATE_UP_WINDOWS_MAX, each time a step up fails straight away
+ */
+#ifndef CC11XL_RATE_UP_WINDOWS
+#define CC11XL_RATE_UP_WINDOWS      4
+#endif
+#ifndef CC11XL_RATE_UP_WINDOWS_MAX
+#define CC11XL_RATE_UP_WINDOWS_MAX  64
+#endif
+
+/* RSSI margin in dB over the sensitivity of the faster profile to step up,
+ * and over the sensitivity of the current profile below which to step down
+ */
+#ifndef CC11XL_RATE_UP_MARGIN
+#define CC11XL_RATE_UP_MARGIN       5
+#endif
+#ifndef CC11XL_RATE_DOWN_MARGIN
+#define CC11XL_RATE_DOWN_MARGIN     2
+#endif
+
+/* Highest mean LQI to step up at; lower LQI is a better link */
+#ifndef CC11XL_RATE_LQI_UP
+#define CC11XL_RATE_LQI_UP          48
+#endif
+
+/* No change, from cc11xLRateUpdate(), cc11xLRateMissed() and
+ * cc11xLRateParseControl()
+ */
+#define CC11XL_RATE_NO_CHANGE       0xFF
+
+/* Control frame: | length = 2 | CC11XL_RATE_CTRL_SET | profile |. Easy link
+ * data frames have a length of 3 or more.
+ */
+#define CC11XL_RATE_CTRL_LEN        2
+#define CC11XL_RATE_CTRL_SET        0x52
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+void  cc11xLRateInit(const cc11xLProfile_t *pProfiles, uint8 numProfiles, uint8 profile);
+uint8 cc11xLRateUpdate(const cc11xLPacket_t *pPacket);
+uint8 cc11xLRateMissed(uint16 count);
+void  cc11xLRateApply(uint8 profile);
+uint8 cc11xLRateGetProfile(void);
+uint8 cc11xLRateBuildControl(uint8 *pFrame, uint8 profile);
+uint8 cc11xLRateParseControl(const uint8 *pFrame, uint8 len);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_RATE_H
@@ -0,0 +1,96 @@
+/******************************************************************************
+    Filename: cc11xL_rxqueue.h
+
+    Description: header file for the RX frame queue of the CC11xL: frames
+                 read whole by the radio interrupt into pool blocks, handed
+                 to the main loop through a lock-free single producer,
+                 single consumer ring.
+
+                 The radio interrupt makes blocking SPI accesses when it
+                 reads a frame. From cc11xLRxQueueStart() to
+                 cc11xLRxQueueStop() the SPI belongs to it: the main loop
+                 must not touch the radio, through cc11xL_spi.c or any
+                 module on top of it, and only takes entries with the
+                 consumer functions below. Outside that span the interrupt
+                 makes no access. Build with CC11XL_SPI_CHECK to assert the
+                 rule on every SPI access.
+
+                 The interrupt writes an entry, then stores the head index;
+                 the main loop reads the entry once it sees the head past
+                 it. The head store is volatile and preceded by a compiler
+                 barrier, so the entry is complete when it is published.
+
+*******************************************************************************/
+#ifndef CC11xL_RXQUEUE_H
+#define CC11xL_RXQUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+#include "cc11xL_packet.h"
+#include "cc11xL_filter.h"
+#include "cc11xL_pool.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Entries in the ring, a power of two; one frame each. Frames are held in
+ * cc11xL_pool.c blocks, so as many frames wait as there are free blocks,
+ * up to this.
+ */
+#ifndef CC11XL_RXQ_SIZE
+#define CC11XL_RXQ_SIZE                 4
+#endif
+
+#if (CC11XL_RXQ_SIZE & (CC11XL_RXQ_SIZE - 1)) || (CC11XL_RXQ_SIZE > 128)
+#error "CC11XL_RXQ_SIZE must be a power of two up to 128"
+#endif
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* A queued frame, or a frame the radio dropped when the GDO signals the end
+ * of every frame
+ */
+typedef struct
+{
+  cc11xLPacket_t packet;                    /* payload points into block buf */
+  uint8  status;                            /* CC11XL_FILTER_FRAME or CC11XL_FILTER_FLUSHED */
+  cc11xLBuf_t buf;                          /* the frame, CC11XL_POOL_NONE if flushed */
+}cc11xLRxQueueEntry_t;
+
+/* Queue counters, written by the producer only */
+typedef struct
+{
+  uint16 queued;                            /* entries put in, wraps */
+  uint16 overruns;                          /* frames lost to a full ring or pool */
+  uint16 errors;                            /* RX FIFO flushes after read errors */
+  uint8  maxDepth;                          /* most entries waiting at once */
+}cc11xLRxQueueStats_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+/* Main loop, with the radio interrupt taking frames between the two */
+void  cc11xLRxQueueStart(uint8 iocfgAddr, uint8 wake);
+void  cc11xLRxQueueStop(void);
+
+/* Producer, the GDO interrupt; the only SPI user between the two above */
+uint8 cc11xLRxQueueFill(void);
+
+/* Consumer, the main loop */
+uint8 cc11xLRxQueueCount(void);
+const cc11xLRxQueueEntry_t *cc11xLRxQueuePeek(void);
+void  cc11xLRxQueueRelease(void);
+const cc11xLRxQueueStats_t *cc11xLRxQueueGetStats(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_RXQUEUE_H
@@ -0,0 +1,214 @@
+/******************************************************************************
+    Filename: cc11xL_stats.c
+
+    Description: running statistics of a link, built from the descriptors of
+                 the frames received on it: RSSI minimum, mean and maximum,
+                 an LQI histogram, CRC failures and the packet rate. Memory
+                 is fixed, one cc11xLStats_t per link, and only integer
+                 arithmetic is used; adding a frame costs a few additions
+                 and compares, the divisions are left to the functions that
+                 read the results, and to the end of each packet rate
+                 window.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_stats.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static void cc11xLStatsWindow(cc11xLStats_t *pStats, uint32 nowMs);
+
+/******************************************************************************
+ * @fn          cc11xLStatsReset
+ *
+ * @brief       Clears the statistics and starts the first packet rate
+ *              window.
+ *
+ * input parameters
+ *
+ * @param       pStats - statistics of the link
+ * @param       nowMs  - time in milliseconds, e.g. halMcuGetTimeMs()
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLStatsReset(cc11xLStats_t *pStats, uint32 nowMs)
+{
+  uint8 i;
+
+  pStats->packets   = 0;
+  pStats->crcErrors = 0;
+  pStats->flushed   = 0;
+  pStats->rssiSum   = 0;
+  pStats->rssiMin   = 127;
+  pStats->rssiMax   = -128;
+  for(i = 0; i < CC11XL_STATS_LQI_BINS; i++)
+  {
+    pStats->lqiHist[i] = 0;
+  }
+  pStats->windowStartMs = nowMs;
+  pStats->windowPackets = 0;
+  pStats->packetRate    = 0;
+}
+
+/******************************************************************************
+ * @fn          cc11xLStatsAdd
+ *
+ * @brief       Adds a received frame.
+ *
+ * input parameters
+ *
+ * @param       pStats  - statistics of the link
+ * @param       pPacket - the frame
+ * @param       nowMs   - time in milliseconds
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLStatsAdd(cc11xLStats_t *pStats, const cc11xLPacket_t *pPacket, uint32 nowMs)
+{
+  uint16 *pBin;
+
+  if(pStats->packets >= CC11XL_STATS_MAX_PACKETS)
+  {
+    return;
+  }
+  pStats->packets++;
+  if(!pPacket->crcOk)
+  {
+    pStats->crcErrors++;
+  }
+
+  pStats->rssiSum += pPacket->rssiDbm;
+  if(pPacket->rssiDbm < pStats->rssiMin)
+  {
+    pStats->rssiMin = pPacket->rssiDbm;
+  }
+  if(pPacket->rssiDbm > pStats->rssiMax)
+  {
+    pStats->rssiMax = pPacket->rssiDbm;
+  }
+
+  pBin = &pStats->lqiHist[(pPacket->lqi & CC11XL_STATUS_LQI_BM) >> CC11XL_STATS_LQI_SHIFT];
+  if(*pBin != 0xFFFF)
+  {
+    (*pBin)++;
+  }
+
+  if(pStats->windowPackets != 0xFFFF)
+  {
+    pStats->windowPackets++;
+  }
+  cc11xLStatsWindow(pStats, nowMs);
+}
+
+/******************************************************************************
+ * @fn          cc11xLStatsAddFlushed
+ *
+ * @brief       Adds a frame the radio flushed for its bad CRC before it was
+ *              read (PKTCTRL1.CRC_AUTOFLUSH). It counts as a CRC failure
+ *              and in the packet rate; its RSSI and LQI are unknown and
+ *              left out.
+ *
+ * input parameters
+ *
+ * @param       pStats - statistics of the link
+ * @param       nowMs  - time in milliseconds
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLStatsAddFlushed(cc11xLStats_t *pStats, uint32 nowMs)
+{
+  if(pStats->packets >= CC11XL_STATS_MAX_PACKETS)
+  {
+    return;
+  }
+  pStats->packets++;
+  pStats->crcErrors++;
+  pStats->flushed++;
+
+  if(pStats->windowPackets != 0xFFFF)
+  {
+    pStats->windowPackets++;
+  }
+  cc11xLStatsWindow(pStats, nowMs);
+}
+
+/******************************************************************************
+ * @fn          cc11xLStatsRssiMean
+ *
+ * @brief       Returns the mean RSSI of the frames added, flushed frames
+ *              left out.
+ *
+ * input parameters
+ *
+ * @param       pStats - statistics of the link
+ *
+ * output parameters
+ *
+ * @return      mean RSSI in dBm, -128 before the first frame
+ */
+int8 cc11xLStatsRssiMean(const cc11xLStats_t *pStats)
+{
+  uint32 measured = pStats->packets - pStats->flushed;
+
+  if(measured == 0)
+  {
+    return (-128);
+  }
+  return ((int8)(pStats->rssiSum / (int32)measured));
+}
+
+/******************************************************************************
+ * @fn          cc11xLStatsPacketRate
+ *
+ * @brief       Returns the packet rate over the last complete window of at
+ *              least CC11XL_STATS_RATE_WINDOW_MS. A window that has run its
+ *              time is closed here too, so the rate drops to 0 when frames
+ *              stop coming.
+ *
+ * input parameters
+ *
+ * @param       pStats - statistics of the link
+ * @param       nowMs  - time in milliseconds
+ *
+ * output parameters
+ *
+ * @return      packets per second, in tenths
+ */
+uint16 cc11xLStatsPacketRate(cc11xLStats_t *pStats, uint32 nowMs)
+{
+  cc11xLStatsWindow(pStats, nowMs);
+  return (pStats->packetRate);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* Closes the packet rate window once it has lasted long enough */
+static void cc11xLStatsWindow(cc11xLStats_t *pStats, uint32 nowMs)
+{
+  uint32 elapsed = nowMs - pStats->windowStartMs;
+  uint32 rate;
+
+  if(elapsed < CC11XL_STATS_RATE_WINDOW_MS)
+  {
+    return;
+  }
+  rate = (uint32)pStats->windowPackets * 10000 / elapsed;
+  pStats->packetRate    = (rate > 0xFFFF) ? 0xFFFF : (uint16)rate;
+  pStats->windowStartMs = nowMs;
+  pStats->windowPackets = 0;
+}
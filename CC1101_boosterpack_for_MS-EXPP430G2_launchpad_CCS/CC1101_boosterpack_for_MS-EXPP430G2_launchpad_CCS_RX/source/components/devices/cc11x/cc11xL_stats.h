@@ -0,0 +1,72 @@
+/******************************************************************************
+    Filename: cc11xL_stats.h
+
+    Description: header file for running link statistics of received CC11xL
+                 frames.
+
+*******************************************************************************/
+#ifndef CC11xL_STATS_H
+#define CC11xL_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_packet.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* LQI histogram, LQI 0 - 127 in bins of 1 << CC11XL_STATS_LQI_SHIFT */
+#ifndef CC11XL_STATS_LQI_SHIFT
+#define CC11XL_STATS_LQI_SHIFT      4
+#endif
+#define CC11XL_STATS_LQI_BINS       (128 >> CC11XL_STATS_LQI_SHIFT)
+
+/* Shortest interval the packet rate is measured over */
+#ifndef CC11XL_STATS_RATE_WINDOW_MS
+#define CC11XL_STATS_RATE_WINDOW_MS 1000
+#endif
+
+/* Frames added before the statistics stop, so the RSSI sum cannot overflow
+ * even at -128 dBm; about 46 hours at 100 packets per second
+ */
+#define CC11XL_STATS_MAX_PACKETS    0x00FFFFFFUL
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* Statistics of one link, 42 bytes with the default histogram. Counters
+ * saturate rather than wrap; reset to start over.
+ */
+typedef struct
+{
+  uint32 packets;                           /* frames, good and bad CRC */
+  uint32 crcErrors;
+  uint32 flushed;                           /* bad CRC frames not read, no RSSI or LQI */
+  int32  rssiSum;                           /* dBm, for the mean */
+  int8   rssiMin;                           /* dBm */
+  int8   rssiMax;                           /* dBm */
+  uint16 lqiHist[CC11XL_STATS_LQI_BINS];
+  uint32 windowStartMs;
+  uint16 windowPackets;
+  uint16 packetRate;                        /* packets/s * 10, last window */
+}cc11xLStats_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+void   cc11xLStatsReset(cc11xLStats_t *pStats, uint32 nowMs);
+void   cc11xLStatsAdd(cc11xLStats_t *pStats, const cc11xLPacket_t *pPacket, uint32 nowMs);
+void   cc11xLStatsAddFlushed(cc11xLStats_t *pStats, uint32 nowMs);
+int8   cc11xLStatsRssiMean(const cc11xLStats_t *pStats);
+uint16 cc11xLStatsPacketRate(cc11xLStats_t *pStats, uint32 nowMs);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_STATS_H
@@ -0,0 +1,411 @@
+/******************************************************************************
+    Filename: cc11xL_txpower.c
+
+    Description: closed loop TX power control. Each destination starts at the
+                 top setting of a table of measured PATABLE values. The peer
+                 reports the RSSI it receives the destination's frames at;
+                 the level moves towards the lowest setting that keeps that
+                 RSSI CC11XL_TXPOWER_MARGIN dB over the sensitivity of the
+                 data rate in use:
+
+                 - a report under the target raises the power straight to the
+                   setting that reaches it
+                 - a report over the target lowers it one setting at a time,
+                   and only as far as the target still holds
+                 - a report that does not come raises the power one setting
+
+                 PA table: with a ramp of n, FREND0.PA_POWER = n and PATABLE
+                 entries 0 to n - 1 hold the n settings below the level, so
+                 the PA ramps up and down through them at the start and end
+                 of each frame. The table is only written when the level
+                 changes, with one burst access; entries above 0 are lost
+                 in SLEEP and put back by cc11xLTxPowerRestore().
+
+                 Each frame sent is charged with its air time at the TX
+                 current of the setting, and at the top setting for
+                 comparison, so the energy per delivered packet shows what
+                 the control saves.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_txpower.h"
+#include "cc11xL_config.h"
+#include "cc11xL_profile.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+#define TXPOWER_NO_LEVEL            0xFF
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static const cc11xLPaSetting_t *pPaTable;
+static uint8  paNumSettings;
+static uint8  paRampLen;
+
+/* Level of each destination, index into the setting table */
+static uint8  txPowerLevel[CC11XL_TXPOWER_MAX_DEST];
+static cc11xLTxPowerStats_t txPowerStats[CC11XL_TXPOWER_MAX_DEST];
+
+/* Level the PATABLE holds, TXPOWER_NO_LEVEL if unknown */
+static uint8  paLoadedLevel = TXPOWER_NO_LEVEL;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static uint32 cc11xLTxPowerEnergyUj(uint8 level, uint32 airUs);
+static void   cc11xLTxPowerAdd(uint32 *pCounter, uint32 value);
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerInit
+ *
+ * @brief       Sets the PATABLE settings and the PA ramp, and puts all
+ *              destinations at the top setting. The PATABLE is written by
+ *              the next cc11xLTxPowerSelect().
+ *
+ * input parameters
+ *
+ * @param       pTable      - settings in ascending power order
+ * @param       numSettings - number of settings
+ * @param       rampLen     - PATABLE entries to ramp through below the
+ *                            level, 0 for none, up to
+ *                            CC11XL_TXPOWER_MAX_RAMP
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLTxPowerInit(const cc11xLPaSetting_t *pTable, uint8 numSettings, uint8 rampLen)
+{
+  uint8 i;
+
+  pPaTable      = pTable;
+  paNumSettings = numSettings;
+  paRampLen     = (rampLen > CC11XL_TXPOWER_MAX_RAMP) ? CC11XL_TXPOWER_MAX_RAMP : rampLen;
+  paLoadedLevel = TXPOWER_NO_LEVEL;
+  for(i = 0; i < CC11XL_TXPOWER_MAX_DEST; i++)
+  {
+    txPowerLevel[i]             = numSettings - 1;
+    txPowerStats[i].sent        = 0;
+    txPowerStats[i].delivered   = 0;
+    txPowerStats[i].energyUj    = 0;
+    txPowerStats[i].energyMaxUj = 0;
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerSelect
+ *
+ * @brief       Sets the PA up for a frame to a destination. Call before the
+ *              STX strobe; nothing is written if the PATABLE already holds
+ *              the level.
+ *
+ * input parameters
+ *
+ * @param       dest - destination, 0 to CC11XL_TXPOWER_MAX_DEST - 1
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLTxPowerSelect(uint8 dest)
+{
+  uint8 paTable[CC11XL_TXPOWER_MAX_RAMP + 1];
+  uint8 level;
+  uint8 i;
+
+  if((pPaTable == NULL) || (dest >= CC11XL_TXPOWER_MAX_DEST))
+  {
+    return (cc11xLGetCachedStatus());
+  }
+  level = txPowerLevel[dest];
+  if(level == paLoadedLevel)
+  {
+    return (cc11xLGetCachedStatus());
+  }
+
+  // ramp entries first, lowest at index 0, the level itself last
+  for(i = 0; i < paRampLen; i++)
+  {
+    paTable[i] = pPaTable[(level + i >= paRampLen) ? level + i - paRampLen : 0].pa;
+  }
+  paTable[paRampLen] = pPaTable[level].pa;
+  cc11xLSpiWriteReg(CC11xL_PA_TABLE0, paTable, paRampLen + 1);
+  cc11xLConfigSet(CC110L_FREND0, (cc11xLConfigGet(CC110L_FREND0) & ~CC11XL_FREND0_PA_POWER_BM)
+                                 | paRampLen);
+  paLoadedLevel = level;
+  return (cc11xLGetCachedStatus());
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerSent
+ *
+ * @brief       Charges a frame sent to a destination to its energy account.
+ *
+ * input parameters
+ *
+ * @param       dest     - destination
+ * @param       frameLen - bytes written to the TX FIFO, length byte included
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLTxPowerSent(uint8 dest, uint16 frameLen)
+{
+  cc11xLTxPowerStats_t *pStats;
+  uint32 airUs;
+
+  if((pPaTable == NULL) || (dest >= CC11XL_TXPOWER_MAX_DEST))
+  {
+    return;
+  }
+  pStats = &txPowerStats[dest];
+  airUs  = cc11xLProfileAirTimeUs(frameLen);
+  cc11xLTxPowerAdd(&pStats->sent, 1);
+  cc11xLTxPowerAdd(&pStats->energyUj, cc11xLTxPowerEnergyUj(txPowerLevel[dest], airUs));
+  cc11xLTxPowerAdd(&pStats->energyMaxUj, cc11xLTxPowerEnergyUj(paNumSettings - 1, airUs));
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerFeedback
+ *
+ * @brief       Adjusts the level of a destination to a report from it.
+ *
+ * input parameters
+ *
+ * @param       dest     - destination
+ * @param       rssiDbm  - RSSI the peer received the destination's frames at
+ * @param       received - frames the peer received since its last report
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLTxPowerFeedback(uint8 dest, int8 rssiDbm, uint8 received)
+{
+  const cc11xLProfile_t *pProfile = cc11xLProfileGet();
+  int16 target;
+  int16 desired;
+  uint8 level;
+
+  if((pPaTable == NULL) || (dest >= CC11XL_TXPOWER_MAX_DEST) || (pProfile == NULL))
+  {
+    return;
+  }
+  cc11xLTxPowerAdd(&txPowerStats[dest].delivered, received);
+
+  // output power that would give the target RSSI over the same path
+  level   = txPowerLevel[dest];
+  target  = pProfile->sensitivity + CC11XL_TXPOWER_MARGIN;
+  desired = pPaTable[level].dbm + (target - rssiDbm);
+
+  if(desired > pPaTable[level].dbm)
+  {
+    while((level + 1 < paNumSettings) && (pPaTable[level].dbm < desired))
+    {
+      level++;
+    }
+  }
+  else if((level > 0) && (pPaTable[level - 1].dbm >= desired))
+  {
+    level--;
+  }
+  txPowerLevel[dest] = level;
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerMissed
+ *
+ * @brief       Raises the level of a destination one setting, for a report
+ *              that was expected but did not come.
+ *
+ * input parameters
+ *
+ * @param       dest - destination
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLTxPowerMissed(uint8 dest)
+{
+  if((pPaTable == NULL) || (dest >= CC11XL_TXPOWER_MAX_DEST))
+  {
+    return;
+  }
+  if(txPowerLevel[dest] + 1 < paNumSettings)
+  {
+    txPowerLevel[dest]++;
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerGetDbm
+ *
+ * @brief       Returns the output power used for a destination.
+ *
+ * input parameters
+ *
+ * @param       dest - destination
+ *
+ * output parameters
+ *
+ * @return      output power in dBm
+ */
+int8 cc11xLTxPowerGetDbm(uint8 dest)
+{
+  if((pPaTable == NULL) || (dest >= CC11XL_TXPOWER_MAX_DEST))
+  {
+    return (0);
+  }
+  return (pPaTable[txPowerLevel[dest]].dbm);
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerGetStats
+ *
+ * @brief       Returns the energy account of a destination.
+ *
+ * input parameters
+ *
+ * @param       dest - destination
+ *
+ * output parameters
+ *
+ * @return      the account, NULL for a destination out of range
+ */
+const cc11xLTxPowerStats_t *cc11xLTxPowerGetStats(uint8 dest)
+{
+  if(dest >= CC11XL_TXPOWER_MAX_DEST)
+  {
+    return (NULL);
+  }
+  return (&txPowerStats[dest]);
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerEnergyPerPacket
+ *
+ * @brief       Returns the TX energy spent per frame the peer received.
+ *
+ * input parameters
+ *
+ * @param       dest - destination
+ *
+ * output parameters
+ *
+ * @return      microjoules per delivered frame, 0 before the first report
+ */
+uint16 cc11xLTxPowerEnergyPerPacket(uint8 dest)
+{
+  uint32 energy;
+
+  if((dest >= CC11XL_TXPOWER_MAX_DEST) || (txPowerStats[dest].delivered == 0))
+  {
+    return (0);
+  }
+  energy = txPowerStats[dest].energyUj / txPowerStats[dest].delivered;
+  return ((energy > 0xFFFF) ? 0xFFFF : (uint16)energy);
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerRestore
+ *
+ * @brief       Has the next cc11xLTxPowerSelect() write the PATABLE again,
+ *              after SLEEP or a reset of the radio.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLTxPowerRestore(void)
+{
+  paLoadedLevel = TXPOWER_NO_LEVEL;
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerBuildFeedback
+ *
+ * @brief       Builds the report of the receiving end, ready for the TX
+ *              FIFO.
+ *
+ * input parameters
+ *
+ * @param       pFrame   - buffer of CC11XL_TXPOWER_FB_LEN + 1 bytes
+ * @param       rssiDbm  - RSSI the peer's frames were received at
+ * @param       received - frames received since the last report
+ *
+ * output parameters
+ *
+ * @return      frame length including the length byte
+ */
+uint8 cc11xLTxPowerBuildFeedback(uint8 *pFrame, int8 rssiDbm, uint8 received)
+{
+  pFrame[0] = CC11XL_TXPOWER_FB_LEN;
+  pFrame[1] = CC11XL_TXPOWER_FB;
+  pFrame[2] = (uint8)rssiDbm;
+  pFrame[3] = received;
+  return (CC11XL_TXPOWER_FB_LEN + 1);
+}
+
+/******************************************************************************
+ * @fn          cc11xLTxPowerParseFeedback
+ *
+ * @brief       Checks a received frame for a report.
+ *
+ * input parameters
+ *
+ * @param       pFrame - frame, starting with the length byte
+ * @param       len    - number of bytes in pFrame
+ *
+ * output parameters
+ *
+ * @param       pRssiDbm  - the RSSI reported
+ * @param       pReceived - the frames reported received
+ *
+ * @return      SUCCESS, or FAILED if the frame is not a report
+ */
+uint8 cc11xLTxPowerParseFeedback(const uint8 *pFrame, uint8 len, int8 *pRssiDbm,
+                                 uint8 *pReceived)
+{
+  if((len < CC11XL_TXPOWER_FB_LEN + 1) || (pFrame[0] != CC11XL_TXPOWER_FB_LEN)
+     || (pFrame[1] != CC11XL_TXPOWER_FB))
+  {
+    return (FAILED);
+  }
+  *pRssiDbm  = (int8)pFrame[2];
+  *pReceived = pFrame[3];
+  return (SUCCESS);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* Energy of airUs at a setting. Power in 0.1 mW times up to ~1.7 s of air
+ * time stays within 32 bits.
+ */
+static uint32 cc11xLTxPowerEnergyUj(uint8 level, uint32 airUs)
+{
+  uint32 power = (uint32)pPaTable[level].current * CC11XL_TXPOWER_VCC_MV / 1000;
+
+  return (power * airUs / 10000);
+}
+
+/* Adds to a counter, saturating */
+static void cc11xLTxPowerAdd(uint32 *pCounter, uint32 value)
+{
+  *pCounter = (*pCounter > 0xFFFFFFFFUL - value) ? 0xFFFFFFFFUL : *pCounter + value;
+}
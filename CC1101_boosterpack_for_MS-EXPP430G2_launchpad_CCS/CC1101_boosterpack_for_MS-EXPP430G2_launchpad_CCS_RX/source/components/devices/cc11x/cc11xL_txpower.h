@@ -0,0 +1,96 @@
+/******************************************************************************
+    Filename: cc11xL_txpower.h
+
+    Description: header file for closed loop TX power control of the CC11xL,
+                 per destination, from the RSSI the peer reports back.
+
+*******************************************************************************/
+#ifndef CC11xL_TXPOWER_H
+#define CC11xL_TXPOWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Destinations with a power level of their own, 17 bytes of RAM each */
+#ifndef CC11XL_TXPOWER_MAX_DEST
+#define CC11XL_TXPOWER_MAX_DEST     2
+#endif
+
+/* RSSI the peer should see, in dB over the sensitivity of the data rate
+ * profile in use; covers fading between two reports
+ */
+#ifndef CC11XL_TXPOWER_MARGIN
+#define CC11XL_TXPOWER_MARGIN       10
+#endif
+
+/* Supply voltage for the energy figures */
+#ifndef CC11XL_TXPOWER_VCC_MV
+#define CC11XL_TXPOWER_VCC_MV       3000
+#endif
+
+/* Longest PA ramp, FREND0.PA_POWER selects PATABLE index 0 - 7 */
+#define CC11XL_TXPOWER_MAX_RAMP     7
+
+/* FREND0 fields */
+#define CC11XL_FREND0_PA_POWER_BM   0x07
+
+/* Feedback frame: | length = 3 | CC11XL_TXPOWER_FB | RSSI dBm | frames |,
+ * the RSSI and number of frames the peer received since its last report
+ */
+#define CC11XL_TXPOWER_FB_LEN       3
+#define CC11XL_TXPOWER_FB           0x50
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* A PATABLE setting with its output power and TX current, measured on the
+ * board. Tables are in ascending power order.
+ */
+typedef struct
+{
+  int8   dbm;                               /* output power */
+  uint8  pa;                                /* PATABLE value */
+  uint16 current;                           /* TX current, 0.1 mA */
+}cc11xLPaSetting_t;
+
+/* Energy account of a destination. The energy at the top setting is what
+ * the same frames would have cost without power control.
+ */
+typedef struct
+{
+  uint32 sent;
+  uint32 delivered;                         /* as reported by the peer */
+  uint32 energyUj;
+  uint32 energyMaxUj;
+}cc11xLTxPowerStats_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+void       cc11xLTxPowerInit(const cc11xLPaSetting_t *pTable, uint8 numSettings, uint8 rampLen);
+rfStatus_t cc11xLTxPowerSelect(uint8 dest);
+void       cc11xLTxPowerSent(uint8 dest, uint16 frameLen);
+void       cc11xLTxPowerFeedback(uint8 dest, int8 rssiDbm, uint8 received);
+void       cc11xLTxPowerMissed(uint8 dest);
+int8       cc11xLTxPowerGetDbm(uint8 dest);
+const cc11xLTxPowerStats_t *cc11xLTxPowerGetStats(uint8 dest);
+uint16     cc11xLTxPowerEnergyPerPacket(uint8 dest);
+void       cc11xLTxPowerRestore(void);
+uint8      cc11xLTxPowerBuildFeedback(uint8 *pFrame, int8 rssiDbm, uint8 received);
+uint8      cc11xLTxPowerParseFeedback(const uint8 *pFrame, uint8 len, int8 *pRssiDbm,
+                                      uint8 *pReceived);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_TXPOWER_H
@@ -0,0 +1,1023 @@
+/******************************************************************************
+    Filename: cc110L_sim.c
+
+    Description: Behavioural CC110L model for host builds, see cc110L_sim.h.
+                 Register addresses, strobes and bit fields follow the CC110L
+                 data sheet; analogue behaviour (RSSI, LQI, frequency error)
+                 is reduced to the values handed in with each received frame.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include <string.h>
+#include "cc110L_sim.h"
+#include "cc11xL_spi.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+#define SIM_AIR_IDLE          0
+#define SIM_AIR_TX_PREAMBLE   1
+#define SIM_AIR_TX_DATA       2
+#define SIM_AIR_TX_CRC        3
+#define SIM_AIR_RX_PREAMBLE   4
+#define SIM_AIR_RX_DATA       5
+#define SIM_AIR_RX_CRC        6
+
+/* Register fields used by the model */
+#define SIM_GDO_CFG_BM        0x3F
+#define SIM_GDO_INV_BM        0x40
+#define SIM_FIFO_THR_BM       0x0F
+#define SIM_CRC_AUTOFLUSH_BM  0x08
+#define SIM_APPEND_STATUS_BM  0x04
+#define SIM_ADR_CHK_BM        0x03
+#define SIM_CRC_EN_BM         0x04
+#define SIM_LENGTH_CONFIG_BM  0x03
+#define SIM_LENGTH_FIXED      0
+#define SIM_LENGTH_VARIABLE   1
+#define SIM_CCA_MODE(mcsm1)   (((mcsm1) >> 4) & 0x03)
+#define SIM_RXOFF_MODE(mcsm1) (((mcsm1) >> 2) & 0x03)
+#define SIM_TXOFF_MODE(mcsm1) ((mcsm1) & 0x03)
+
+#define SIM_VERSION           0x07
+#define SIM_LQI               0x14
+
+/* Synthesizer timing, data sheet figures at 26 MHz scaled to 27 MHz:
+ * calibration, and settling without it
+ */
+#define SIM_CAL_US            694
+#define SIM_SETTLE_US         85
+
+/* RX to TX turnaround after a STX the channel assessment lets through */
+#define SIM_RXTX_US           10
+
+/* Synthesizer phases */
+#define SIM_FS_NONE           0
+#define SIM_FS_CAL            1
+#define SIM_FS_SETTLE         2
+#define SIM_FS_SWITCH         3
+
+#define SIM_FS_AUTOCAL(mcsm0) (((mcsm0) >> 4) & 0x03)
+
+/* Crystal 27 MHz, as on the BoosterPack:
+ * byte time in us = 8 * 2^28 / ((256 + M) * 2^E * 27)
+ */
+#define SIM_BYTE_TIME_NUM     79536431UL
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static const uint8 simResetRegs[CC110L_SIM_NUM_REGS] = {
+  0x29, 0x2E, 0x3F, 0x07, 0xD3, 0x91, 0xFF, 0x04,   /* 0x00 - 0x07 */
+  0x45, 0x00, 0x00, 0x0F, 0x00, 0x1E, 0xC4, 0xEC,   /* 0x08 - 0x0F */
+  0x8C, 0x22, 0x02, 0x22, 0xF8, 0x47, 0x07, 0x30,   /* 0x10 - 0x17 */
+  0x04, 0x36, 0x6C, 0x03, 0x40, 0x91, 0x87, 0x6B,   /* 0x18 - 0x1F */
+  0xF8, 0x56, 0x10, 0xA9, 0x0A, 0x20, 0x0D, 0x41,   /* 0x20 - 0x27 */
+  0x00, 0x59, 0x7F, 0x3F, 0x88, 0x31, 0x0B          /* 0x28 - 0x2E */
+};
+
+static const uint8 simPreambleBytes[8] = {2, 3, 4, 6, 8, 12, 16, 24};
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static void  simReset(cc110LSim_t *pSim);
+static uint8 simStatusByte(const cc110LSim_t *pSim, uint8 readAccess);
+static void  simStrobe(cc110LSim_t *pSim, uint8 cmd);
+static uint8 simRead(cc110LSim_t *pSim, uint8 addr);
+static void  simWrite(cc110LSim_t *pSim, uint8 addr, uint8 data);
+static void  simEnterState(cc110LSim_t *pSim, uint8 marcState);
+static void  simStartFs(cc110LSim_t *pSim, uint8 target, uint8 calibrate);
+static void  simFsStep(cc110LSim_t *pSim);
+static void  simFsResult(const cc110LSim_t *pSim, uint8 *pFscal);
+static void  simLeaveRxTx(cc110LSim_t *pSim, uint8 marcState);
+static void  simAirByte(cc110LSim_t *pSim);
+static void  simTxByte(cc110LSim_t *pSim);
+static void  simRxByte(cc110LSim_t *pSim);
+static void  simTxDone(cc110LSim_t *pSim);
+static void  simRxDone(cc110LSim_t *pSim);
+static void  simRxPush(cc110LSim_t *pSim, uint8 data);
+static void  simRxFlush(cc110LSim_t *pSim);
+static uint8 simPacketEnded(const cc110LSim_t *pSim);
+static uint16 simSyncBytes(const cc110LSim_t *pSim);
+static uint8 simCarrierSense(const cc110LSim_t *pSim);
+static uint8 simAddressMatch(const cc110LSim_t *pSim, uint8 addr);
+static uint8 simGdoLevel(const cc110LSim_t *pSim, uint8 iocfg);
+static void  simUpdateGdo(cc110LSim_t *pSim);
+
+/******************************************************************************
+ * @fn          cc110LSimInit
+ *
+ * @brief       Puts the model in its power-on state: reset register values,
+ *              empty FIFOs, IDLE, model time 0. Hooks must be set after.
+ *
+ * input parameters
+ *
+ * @param       pSim - model instance
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc110LSimInit(cc110LSim_t *pSim)
+{
+  memset(pSim, 0, sizeof(cc110LSim_t));
+  pSim->tempC = 25;
+  simReset(pSim);
+}
+
+/******************************************************************************
+ * @fn          cc110LSimSelect
+ *
+ * @brief       CS_N pulled low. Wakes the radio from SLEEP.
+ *
+ * input parameters
+ *
+ * @param       pSim - model instance
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc110LSimSelect(cc110LSim_t *pSim)
+{
+  pSim->csActive = TRUE;
+  pSim->spiIndex = 0;
+  if(pSim->marcState == CC110L_SIM_MARC_SLEEP)
+  {
+    simEnterState(pSim, CC110L_SIM_MARC_IDLE);
+  }
+  simUpdateGdo(pSim);
+}
+
+/******************************************************************************
+ * @fn          cc110LSimSpiByte
+ *
+ * @brief       Exchanges one byte on the virtual SPI bus. The first byte of
+ *              an access is the header, answered with the chip status byte;
+ *              strobes execute on the header. Single accesses take one data
+ *              byte, after which the next byte is a new header. Burst
+ *              accesses auto-increment the address below the PA table.
+ *
+ * input parameters
+ *
+ * @param       pSim - model instance
+ * @param       mosi - byte from the MCU
+ *
+ * output parameters
+ *
+ * @return      byte to the MCU
+ */
+uint8 cc110LSimSpiByte(cc110LSim_t *pSim, uint8 mosi)
+{
+  uint8 miso;
+
+  if(!pSim->csActive)
+  {
+    return (0xFF);
+  }
+
+  if(pSim->spiIndex == 0)
+  {
+    pSim->header = mosi;
+    pSim->addr   = mosi & 0x3F;
+    miso = simStatusByte(pSim, mosi & RADIO_READ_ACCESS);
+    if((pSim->addr >= CC110L_SRES) && (pSim->addr <= CC110L_SNOP)
+       && !(mosi & RADIO_BURST_ACCESS))
+    {
+      simStrobe(pSim, pSim->addr);
+    }
+    else
+    {
+      pSim->spiIndex = 1;
+    }
+    simUpdateGdo(pSim);
+    return (miso);
+  }
+
+  if(pSim->header & RADIO_READ_ACCESS)
+  {
+    miso = simRead(pSim, pSim->addr);
+  }
+  else
+  {
+    miso = simStatusByte(pSim, FALSE);
+    simWrite(pSim, pSim->addr, mosi);
+  }
+
+  if(!(pSim->header & RADIO_BURST_ACCESS))
+  {
+    pSim->spiIndex = 0;
+  }
+  else
+  {
+    pSim->spiIndex++;
+    if(pSim->addr < CC110L_SIM_NUM_REGS - 1)
+    {
+      pSim->addr++;
+    }
+  }
+  simUpdateGdo(pSim);
+  return (miso);
+}
+
+/******************************************************************************
+ * @fn          cc110LSimDeselect
+ *
+ * @brief       CS_N released. Resets the PA table index and enters SLEEP if
+ *              SPWD was strobed during the access.
+ *
+ * input parameters
+ *
+ * @param       pSim - model instance
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc110LSimDeselect(cc110LSim_t *pSim)
+{
+  pSim->csActive = FALSE;
+  pSim->paIndex  = 0;
+  if(pSim->sleepPending)
+  {
+    pSim->sleepPending = FALSE;
+    simEnterState(pSim, CC110L_SIM_MARC_SLEEP);
+  }
+  simUpdateGdo(pSim);
+}
+
+/******************************************************************************
+ * @fn          cc110LSimAdvance
+ *
+ * @brief       Moves model time forward, completing synthesizer calibration
+ *              and settling, and sending or receiving the bytes of the
+ *              frame on air that fall due in the interval.
+ *
+ * input parameters
+ *
+ * @param       pSim - model instance
+ * @param       us   - time step in microseconds
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc110LSimAdvance(cc110LSim_t *pSim, uint32 us)
+{
+  uint32 end = pSim->timeUs + us;
+
+  while((pSim->fsPhase != SIM_FS_NONE) && ((int32)(end - pSim->fsDue) >= 0))
+  {
+    pSim->timeUs = pSim->fsDue;
+    simFsStep(pSim);
+    simUpdateGdo(pSim);
+  }
+  while((pSim->airPhase != SIM_AIR_IDLE) && ((int32)(end - pSim->airDue) >= 0))
+  {
+    pSim->timeUs  = pSim->airDue;
+    pSim->airDue += cc110LSimByteTimeUs(pSim);
+    simAirByte(pSim);
+    simUpdateGdo(pSim);
+  }
+  pSim->timeUs = end;
+}
+
+/******************************************************************************
+ * @fn          cc110LSimAirReceive
+ *
+ * @brief       Offers a frame from the air. It is accepted only while the
+ *              radio is in RX and not already receiving; the bytes then
+ *              arrive in the RX FIFO at the programmed data rate. The frame
+ *              holds the bytes as they were written to the sender's TX FIFO,
+ *              the CRC is represented by crcOk.
+ *
+ * input parameters
+ *
+ * @param       pSim    - model instance
+ * @param       pFrame  - frame bytes
+ * @param       len     - number of bytes
+ * @param       rssiDbm - signal strength reported with the frame
+ * @param       crcOk   - FALSE to simulate a corrupted frame
+ *
+ * output parameters
+ *
+ * @return      TRUE if the frame is being received
+ */
+uint8 cc110LSimAirReceive(cc110LSim_t *pSim, const uint8 *pFrame, uint16 len,
+                          int8 rssiDbm, uint8 crcOk)
+{
+  // an unlocked synthesizer listens off the channel
+  if((pSim->marcState != CC110L_SIM_MARC_RX) || (pSim->airPhase != SIM_AIR_IDLE)
+     || !pSim->fsLocked)
+  {
+    return (FALSE);
+  }
+  if(len > CC110L_SIM_MAX_FRAME)
+  {
+    len = CC110L_SIM_MAX_FRAME;
+  }
+  memcpy(pSim->airBuf, pFrame, len);
+  pSim->airFrameLen = len;
+  pSim->airPos      = 0;
+  pSim->airLen      = 0;
+  pSim->rxCrcOk     = crcOk;
+  pSim->rxRssiDbm   = rssiDbm;
+  pSim->airCount    = simPreambleBytes[(pSim->regs[CC110L_MDMCFG1] >> 4) & 0x07]
+                      + simSyncBytes(pSim);
+  pSim->airPhase    = SIM_AIR_RX_PREAMBLE;
+  pSim->airDue      = pSim->timeUs + cc110LSimByteTimeUs(pSim);
+  simUpdateGdo(pSim);
+  return (TRUE);
+}
+
+/******************************************************************************
+ * @fn          cc110LSimByteTimeUs
+ *
+ * @brief       Air time of one byte at the data rate in MDMCFG4/MDMCFG3.
+ *
+ * input parameters
+ *
+ * @param       pSim - model instance
+ *
+ * output parameters
+ *
+ * @return      byte time in microseconds
+ */
+uint32 cc110LSimByteTimeUs(const cc110LSim_t *pSim)
+{
+  uint32 div = (256UL + pSim->regs[CC110L_MDMCFG3]) << (pSim->regs[CC110L_MDMCFG4] & 0x0F);
+  uint32 t   = SIM_BYTE_TIME_NUM / div;
+
+  return (t ? t : 1);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void simReset(cc110LSim_t *pSim)
+{
+  uint8 i;
+
+  memcpy(pSim->regs, simResetRegs, sizeof(simResetRegs));
+  pSim->paTable[0] = 0xC6;
+  for(i = 1; i < sizeof(pSim->paTable); i++)
+  {
+    pSim->paTable[i] = 0x00;
+  }
+  pSim->paIndex      = 0;
+  pSim->txCount      = 0;
+  pSim->txUnderflow  = FALSE;
+  simRxFlush(pSim);
+  pSim->rxOverflow   = FALSE;
+  pSim->airPhase     = SIM_AIR_IDLE;
+  pSim->syncActive   = FALSE;
+  pSim->crcOkPending = FALSE;
+  pSim->rxPktDone    = FALSE;
+  pSim->lastCrcOk    = FALSE;
+  pSim->sleepPending = FALSE;
+  pSim->fsPhase      = SIM_FS_NONE;
+  pSim->fsLocked     = FALSE;
+  pSim->autoCalCount = 0;
+  pSim->marcState    = CC110L_SIM_MARC_IDLE;
+}
+
+static uint8 simStatusByte(const cc110LSim_t *pSim, uint8 readAccess)
+{
+  uint8 state;
+  uint8 bytes;
+
+  switch(pSim->marcState)
+  {
+    case CC110L_SIM_MARC_SLEEP:            return (STATUS_CHIP_RDYn_BM);
+    case CC110L_SIM_MARC_RX:               state = CC110L_STATE_RX;            break;
+    case CC110L_SIM_MARC_TX:               state = CC110L_STATE_TX;            break;
+    case CC110L_SIM_MARC_FSTXON:           state = CC110L_STATE_FSTXON;        break;
+    case CC110L_SIM_MARC_RXFIFO_OVERFLOW:  state = CC110L_STATE_RXFIFO_ERROR;  break;
+    case CC110L_SIM_MARC_TXFIFO_UNDERFLOW: state = CC110L_STATE_TXFIFO_ERROR;  break;
+    case CC110L_SIM_MARC_MANCAL:
+    case CC110L_SIM_MARC_STARTCAL:         state = CC110L_STATE_CALIBRATE;     break;
+    case CC110L_SIM_MARC_FS_LOCK:
+    case CC110L_SIM_MARC_RXTX_SWITCH:      state = CC110L_STATE_SETTLING;      break;
+    default:                               state = CC110L_STATE_IDLE;          break;
+  }
+  bytes = readAccess ? pSim->rxCount : (CC110L_SIM_FIFO_SIZE - pSim->txCount);
+  if(bytes > STATUS_FIFO_BYTES_AVAILABLE_BM)
+  {
+    bytes = STATUS_FIFO_BYTES_AVAILABLE_BM;
+  }
+  return (state | bytes);
+}
+
+static void simStrobe(cc110LSim_t *pSim, uint8 cmd)
+{
+  uint8 state = pSim->marcState;
+
+  switch(cmd)
+  {
+    case CC110L_SRES:
+      simReset(pSim);
+      break;
+    case CC110L_SFSTXON:
+      if(state == CC110L_SIM_MARC_IDLE)
+      {
+        simStartFs(pSim, CC110L_SIM_MARC_FSTXON, FALSE);
+      }
+      break;
+    case CC110L_SCAL:
+      if(state == CC110L_SIM_MARC_IDLE)
+      {
+        simStartFs(pSim, CC110L_SIM_MARC_IDLE, TRUE);
+      }
+      break;
+    case CC110L_SRX:
+      if(state == CC110L_SIM_MARC_IDLE)
+      {
+        simStartFs(pSim, CC110L_SIM_MARC_RX, FALSE);
+      }
+      else if(state == CC110L_SIM_MARC_FSTXON)
+      {
+        simEnterState(pSim, CC110L_SIM_MARC_RX);
+      }
+      break;
+    case CC110L_STX:
+      if(state == CC110L_SIM_MARC_IDLE)
+      {
+        simStartFs(pSim, CC110L_SIM_MARC_TX, FALSE);
+      }
+      else if(state == CC110L_SIM_MARC_FSTXON)
+      {
+        simEnterState(pSim, CC110L_SIM_MARC_TX);
+      }
+      else if(state == CC110L_SIM_MARC_RX)
+      {
+        // only leave RX if the channel assessment passes, through
+        // RXTX_SWITCH with the synthesizer kept locked
+        if((SIM_CCA_MODE(pSim->regs[CC110L_MCSM1]) == 0) || !simCarrierSense(pSim))
+        {
+          pSim->fsTarget = CC110L_SIM_MARC_TX;
+          pSim->fsPhase  = SIM_FS_SWITCH;
+          pSim->fsDue    = pSim->timeUs + SIM_RXTX_US;
+          simEnterState(pSim, CC110L_SIM_MARC_RXTX_SWITCH);
+        }
+      }
+      break;
+    case CC110L_SIDLE:
+      if(state != CC110L_SIM_MARC_SLEEP)
+      {
+        // also aborts a calibration in progress
+        pSim->fsPhase = SIM_FS_NONE;
+        simEnterState(pSim, CC110L_SIM_MARC_IDLE);
+      }
+      break;
+    case CC110L_SPWD:
+      if(state == CC110L_SIM_MARC_IDLE)
+      {
+        pSim->sleepPending = TRUE;
+      }
+      break;
+    case CC110L_SFRX:
+      if((state == CC110L_SIM_MARC_IDLE) || (state == CC110L_SIM_MARC_RXFIFO_OVERFLOW))
+      {
+        simRxFlush(pSim);
+        pSim->rxOverflow   = FALSE;
+        pSim->rxPktDone    = FALSE;
+        pSim->crcOkPending = FALSE;
+        simEnterState(pSim, CC110L_SIM_MARC_IDLE);
+      }
+      break;
+    case CC110L_SFTX:
+      if((state == CC110L_SIM_MARC_IDLE) || (state == CC110L_SIM_MARC_TXFIFO_UNDERFLOW))
+      {
+        pSim->txCount     = 0;
+        pSim->txUnderflow = FALSE;
+        simEnterState(pSim, CC110L_SIM_MARC_IDLE);
+      }
+      break;
+    default:
+      // SXOFF, SNOP and the WOR strobes have no modelled effect
+      break;
+  }
+}
+
+static uint8 simRead(cc110LSim_t *pSim, uint8 addr)
+{
+  uint8 data;
+
+  if(addr < CC110L_SIM_NUM_REGS)
+  {
+    return (pSim->regs[addr]);
+  }
+  switch(addr)
+  {
+    case CC110L_PARTNUM:
+      return (0x00);
+    case CC110L_VERSION:
+      return (SIM_VERSION);
+    case CC110L_LQI:
+      return ((pSim->lastCrcOk ? CC110L_CRC_OK_BM : 0) | SIM_LQI);
+    case CC110L_RSSI:
+      return ((uint8)((pSim->rxRssiDbm + 74) * 2));
+    case CC110L_MARCSTATE:
+      return (pSim->marcState);
+    case CC110L_PKTSTATUS:
+      return ((pSim->lastCrcOk ? 0x80 : 0) | (simCarrierSense(pSim) ? 0x40 : 0)
+              | (((pSim->marcState == CC110L_SIM_MARC_RX) && !simCarrierSense(pSim)) ? 0x10 : 0)
+              | (pSim->syncActive ? 0x08 : 0) | (pSim->gdo[2] ? 0x04 : 0)
+              | (pSim->gdo[0] ? 0x01 : 0));
+    case CC110L_TXBYTES:
+      return ((pSim->txUnderflow ? CC11XL_RXFIFO_OVERFLOW_BM : 0) | pSim->txCount);
+    case CC110L_RXBYTES:
+      return ((pSim->rxOverflow ? CC11XL_RXFIFO_OVERFLOW_BM : 0) | pSim->rxCount);
+    case CC11xL_PA_TABLE0:
+      return (pSim->paTable[pSim->paIndex++ & 0x07]);
+    case CC11xL_FIFO:
+      if(pSim->rxCount == 0)
+      {
+        return (0x00);
+      }
+      data = pSim->rxFifo[pSim->rxHead];
+      pSim->rxHead = (pSim->rxHead + 1) % CC110L_SIM_FIFO_SIZE;
+      pSim->rxCount--;
+      pSim->rxPopped++;
+      while(pSim->rxEndCount && (pSim->rxPopped >= pSim->rxEnds[pSim->rxEndHead]))
+      {
+        pSim->rxEndHead = (pSim->rxEndHead + 1) % CC110L_SIM_RX_ENDS;
+        pSim->rxEndCount--;
+        pSim->framesRead++;
+      }
+      pSim->crcOkPending = FALSE;
+      if(pSim->rxCount == 0)
+      {
+        pSim->rxPktDone = FALSE;
+      }
+      return (data);
+    default:
+      return (0x00);
+  }
+}
+
+static void simWrite(cc110LSim_t *pSim, uint8 addr, uint8 data)
+{
+  if(addr < CC110L_SIM_NUM_REGS)
+  {
+    pSim->regs[addr] = data;
+  }
+  else if(addr == CC11xL_PA_TABLE0)
+  {
+    pSim->paTable[pSim->paIndex++ & 0x07] = data;
+  }
+  else if(addr == CC11xL_FIFO)
+  {
+    if(pSim->txCount < CC110L_SIM_FIFO_SIZE)
+    {
+      pSim->txFifo[pSim->txCount++] = data;
+    }
+    else
+    {
+      // written to a full FIFO: the byte is lost
+      pSim->txUnderflow = TRUE;
+    }
+  }
+}
+
+static void simEnterState(cc110LSim_t *pSim, uint8 marcState)
+{
+  // leaving TX or RX aborts the frame on air
+  pSim->airPhase   = SIM_AIR_IDLE;
+  pSim->syncActive = FALSE;
+  pSim->marcState  = marcState;
+
+  if(marcState == CC110L_SIM_MARC_TX)
+  {
+    pSim->airCount = simPreambleBytes[(pSim->regs[CC110L_MDMCFG1] >> 4) & 0x07]
+                     + simSyncBytes(pSim);
+    pSim->airPos   = 0;
+    pSim->airLen   = 0;
+    pSim->airPhase = SIM_AIR_TX_PREAMBLE;
+    pSim->airDue   = pSim->timeUs + cc110LSimByteTimeUs(pSim);
+  }
+}
+
+/* Starts the synthesizer on the way out of IDLE, calibrating first when
+ * asked to (SCAL) or when FS_AUTOCAL says so, and settling unless the
+ * target is IDLE.
+ */
+static void simStartFs(cc110LSim_t *pSim, uint8 target, uint8 calibrate)
+{
+  pSim->fsTarget = target;
+  if(calibrate || (SIM_FS_AUTOCAL(pSim->regs[CC110L_MCSM0]) == 1))
+  {
+    pSim->fsPhase = SIM_FS_CAL;
+    pSim->fsDue   = pSim->timeUs + SIM_CAL_US;
+    simEnterState(pSim, calibrate ? CC110L_SIM_MARC_MANCAL : CC110L_SIM_MARC_STARTCAL);
+  }
+  else
+  {
+    pSim->fsPhase = SIM_FS_SETTLE;
+    pSim->fsDue   = pSim->timeUs + SIM_SETTLE_US;
+    simEnterState(pSim, CC110L_SIM_MARC_FS_LOCK);
+  }
+}
+
+static void simFsStep(cc110LSim_t *pSim)
+{
+  uint8 fscal[3];
+
+  if(pSim->fsPhase == SIM_FS_SWITCH)
+  {
+    pSim->fsPhase = SIM_FS_NONE;
+    simEnterState(pSim, pSim->fsTarget);
+    return;
+  }
+  if(pSim->fsPhase == SIM_FS_CAL)
+  {
+    simFsResult(pSim, fscal);
+    pSim->regs[CC110L_FSCAL3] = fscal[0];
+    pSim->regs[CC110L_FSCAL2] = fscal[1];
+    pSim->regs[CC110L_FSCAL1] = fscal[2];
+    pSim->calibrations++;
+    if(pSim->fsTarget == CC110L_SIM_MARC_IDLE)
+    {
+      pSim->fsPhase = SIM_FS_NONE;
+      simEnterState(pSim, CC110L_SIM_MARC_IDLE);
+      return;
+    }
+    pSim->fsPhase = SIM_FS_SETTLE;
+    pSim->fsDue  += SIM_SETTLE_US;
+    simEnterState(pSim, CC110L_SIM_MARC_FS_LOCK);
+    return;
+  }
+
+  // locks only with the calibration result for this frequency
+  simFsResult(pSim, fscal);
+  pSim->fsLocked = ((pSim->regs[CC110L_FSCAL3] & 0x0F) == (fscal[0] & 0x0F))
+                   && ((pSim->regs[CC110L_FSCAL2] & 0x3F) == fscal[1])
+                   && ((pSim->regs[CC110L_FSCAL1] & 0x3F) == fscal[2]);
+  pSim->fsPhase  = SIM_FS_NONE;
+  simEnterState(pSim, pSim->fsTarget);
+}
+
+/* FSCAL3, FSCAL2 and FSCAL1 a calibration gives for the programmed
+ * frequency: a made-up but fixed function of the frequency word, shifted
+ * by temperature.
+ */
+static void simFsResult(const cc110LSim_t *pSim, uint8 *pFscal)
+{
+  uint32 freq = ((uint32)pSim->regs[CC110L_FREQ2] << 16)
+                | ((uint32)pSim->regs[CC110L_FREQ1] << 8) | pSim->regs[CC110L_FREQ0];
+
+  pFscal[0] = (pSim->regs[CC110L_FSCAL3] & 0xF0) | (uint8)((freq >> 13) & 0x0F);
+  pFscal[1] = (pSim->regs[CC110L_FREQ2] >= 0x21) ? 0x2A : 0x0A;
+  pFscal[2] = (uint8)((freq >> 9) + (pSim->tempC - 25) / 16) & 0x3F;
+}
+
+/* End of packet transition to IDLE, calibrating on the way if FS_AUTOCAL
+ * asks for it (always, or every fourth time).
+ */
+static void simLeaveRxTx(cc110LSim_t *pSim, uint8 marcState)
+{
+  uint8 autocal = SIM_FS_AUTOCAL(pSim->regs[CC110L_MCSM0]);
+
+  if((autocal == 2) || ((autocal == 3) && ((++pSim->autoCalCount & 0x03) == 0)))
+  {
+    simStartFs(pSim, marcState, TRUE);
+    // still the automatic calibration state
+    pSim->marcState = CC110L_SIM_MARC_STARTCAL;
+    return;
+  }
+  simEnterState(pSim, marcState);
+}
+
+static void simAirByte(cc110LSim_t *pSim)
+{
+  switch(pSim->airPhase)
+  {
+    case SIM_AIR_TX_PREAMBLE:
+    case SIM_AIR_TX_DATA:
+    case SIM_AIR_TX_CRC:
+      simTxByte(pSim);
+      break;
+    default:
+      simRxByte(pSim);
+      break;
+  }
+}
+
+static void simTxByte(cc110LSim_t *pSim)
+{
+  uint8 data;
+
+  switch(pSim->airPhase)
+  {
+    case SIM_AIR_TX_PREAMBLE:
+      // preamble is repeated until the first byte is in the FIFO
+      if((pSim->airCount > 1) || (pSim->txCount != 0))
+      {
+        pSim->airCount--;
+      }
+      if(pSim->airCount == 0)
+      {
+        pSim->syncActive = TRUE;
+        pSim->airPhase   = SIM_AIR_TX_DATA;
+      }
+      break;
+
+    case SIM_AIR_TX_DATA:
+      if(pSim->txCount == 0)
+      {
+        pSim->txUnderflow = TRUE;
+        simEnterState(pSim, CC110L_SIM_MARC_TXFIFO_UNDERFLOW);
+        return;
+      }
+      data = pSim->txFifo[0];
+      pSim->txCount--;
+      memmove(pSim->txFifo, &pSim->txFifo[1], pSim->txCount);
+      if(pSim->airPos < CC110L_SIM_MAX_FRAME)
+      {
+        pSim->airBuf[pSim->airPos] = data;
+      }
+      pSim->airPos++;
+      if(pSim->airPos == 1)
+      {
+        pSim->airLen = (uint16)data + 1;
+      }
+      if(simPacketEnded(pSim))
+      {
+        if(pSim->regs[CC110L_PKTCTRL0] & SIM_CRC_EN_BM)
+        {
+          pSim->airCount = 2;
+          pSim->airPhase = SIM_AIR_TX_CRC;
+        }
+        else
+        {
+          simTxDone(pSim);
+        }
+      }
+      break;
+
+    case SIM_AIR_TX_CRC:
+      if(--pSim->airCount == 0)
+      {
+        simTxDone(pSim);
+      }
+      break;
+  }
+}
+
+static void simRxByte(cc110LSim_t *pSim)
+{
+  uint8 data;
+
+  switch(pSim->airPhase)
+  {
+    case SIM_AIR_RX_PREAMBLE:
+      if(--pSim->airCount == 0)
+      {
+        pSim->syncActive = TRUE;
+        pSim->airPhase   = SIM_AIR_RX_DATA;
+      }
+      break;
+
+    case SIM_AIR_RX_DATA:
+      data = pSim->airBuf[pSim->airPos];
+      if(pSim->airPos == 0)
+      {
+        pSim->airLen = (uint16)data + 1;
+        // packet length filtering in variable length mode
+        if(((pSim->regs[CC110L_PKTCTRL0] & SIM_LENGTH_CONFIG_BM) == SIM_LENGTH_VARIABLE)
+           && (data > pSim->regs[CC110L_PKTLEN]))
+        {
+          pSim->framesDropped++;
+          pSim->airPhase   = SIM_AIR_IDLE;
+          pSim->syncActive = FALSE;
+          return;
+        }
+      }
+      // address check on the byte after the length byte: a frame for
+      // another node is dropped, length byte included, and RX goes on
+      if((pSim->airPos == 1) && (pSim->regs[CC110L_PKTCTRL1] & SIM_ADR_CHK_BM)
+         && !simAddressMatch(pSim, data))
+      {
+        pSim->rxCount--;
+        pSim->rxPushed--;
+        pSim->framesFiltered++;
+        pSim->airPhase   = SIM_AIR_IDLE;
+        pSim->syncActive = FALSE;
+        return;
+      }
+      simRxPush(pSim, data);
+      if(pSim->marcState != CC110L_SIM_MARC_RX)
+      {
+        pSim->framesDropped++;
+        return;
+      }
+      pSim->airPos++;
+      if(simPacketEnded(pSim) || (pSim->airPos >= pSim->airFrameLen))
+      {
+        if(pSim->regs[CC110L_PKTCTRL0] & SIM_CRC_EN_BM)
+        {
+          pSim->airCount = 2;
+          pSim->airPhase = SIM_AIR_RX_CRC;
+        }
+        else
+        {
+          simRxDone(pSim);
+        }
+      }
+      break;
+
+    case SIM_AIR_RX_CRC:
+      if(--pSim->airCount == 0)
+      {
+        simRxDone(pSim);
+      }
+      break;
+  }
+}
+
+static void simTxDone(cc110LSim_t *pSim)
+{
+  uint16 len = pSim->airPos;
+
+  pSim->airPhase   = SIM_AIR_IDLE;
+  pSim->syncActive = FALSE;
+  pSim->framesSent++;
+  if(pSim->pfnTxFrame)
+  {
+    pSim->pfnTxFrame(pSim, pSim->airBuf, (len < CC110L_SIM_MAX_FRAME) ? len : CC110L_SIM_MAX_FRAME);
+  }
+  if(!pSim->fsLocked)
+  {
+    pSim->framesUnlocked++;
+  }
+  switch(SIM_TXOFF_MODE(pSim->regs[CC110L_MCSM1]))
+  {
+    case 1:  simEnterState(pSim, CC110L_SIM_MARC_FSTXON); break;
+    case 2:  simEnterState(pSim, CC110L_SIM_MARC_TX);     break;
+    case 3:  simEnterState(pSim, CC110L_SIM_MARC_RX);     break;
+    default: simLeaveRxTx(pSim, CC110L_SIM_MARC_IDLE);    break;
+  }
+}
+
+static void simRxDone(cc110LSim_t *pSim)
+{
+  uint8 crcOk = (pSim->regs[CC110L_PKTCTRL0] & SIM_CRC_EN_BM) ? pSim->rxCrcOk : TRUE;
+
+  pSim->airPhase   = SIM_AIR_IDLE;
+  pSim->syncActive = FALSE;
+  pSim->lastCrcOk  = crcOk;
+
+  if(!crcOk && (pSim->regs[CC110L_PKTCTRL1] & SIM_CRC_AUTOFLUSH_BM))
+  {
+    simRxFlush(pSim);
+    pSim->framesDropped++;
+  }
+  else
+  {
+    if(pSim->regs[CC110L_PKTCTRL1] & SIM_APPEND_STATUS_BM)
+    {
+      simRxPush(pSim, (uint8)((pSim->rxRssiDbm + 74) * 2));
+      simRxPush(pSim, (crcOk ? CC110L_CRC_OK_BM : 0) | SIM_LQI);
+      if(pSim->marcState != CC110L_SIM_MARC_RX)
+      {
+        pSim->framesDropped++;
+        return;
+      }
+    }
+    pSim->crcOkPending = crcOk;
+    pSim->rxPktDone    = TRUE;
+    pSim->framesReceived++;
+    if(pSim->rxEndCount < CC110L_SIM_RX_ENDS)
+    {
+      pSim->rxEnds[(pSim->rxEndHead + pSim->rxEndCount) % CC110L_SIM_RX_ENDS] = pSim->rxPushed;
+      pSim->rxEndCount++;
+    }
+    if(crcOk)
+    {
+      pSim->framesCrcOk++;
+    }
+  }
+
+  switch(SIM_RXOFF_MODE(pSim->regs[CC110L_MCSM1]))
+  {
+    case 1:  simEnterState(pSim, CC110L_SIM_MARC_FSTXON); break;
+    case 2:  simEnterState(pSim, CC110L_SIM_MARC_TX);     break;
+    case 3:  break;
+    default: simLeaveRxTx(pSim, CC110L_SIM_MARC_IDLE);    break;
+  }
+}
+
+static void simRxPush(cc110LSim_t *pSim, uint8 data)
+{
+  if(pSim->rxCount == CC110L_SIM_FIFO_SIZE)
+  {
+    pSim->rxOverflow = TRUE;
+    simEnterState(pSim, CC110L_SIM_MARC_RXFIFO_OVERFLOW);
+    return;
+  }
+  pSim->rxFifo[(pSim->rxHead + pSim->rxCount) % CC110L_SIM_FIFO_SIZE] = data;
+  pSim->rxCount++;
+  pSim->rxPushed++;
+}
+
+/* Empties the RX FIFO; frames in it are lost, not read */
+static void simRxFlush(cc110LSim_t *pSim)
+{
+  pSim->rxHead     = 0;
+  pSim->rxCount    = 0;
+  pSim->rxPopped   = pSim->rxPushed;
+  pSim->rxEndCount = 0;
+}
+
+static uint8 simPacketEnded(const cc110LSim_t *pSim)
+{
+  switch(pSim->regs[CC110L_PKTCTRL0] & SIM_LENGTH_CONFIG_BM)
+  {
+    case SIM_LENGTH_FIXED:
+      // the byte counter is 8 bits wide, PKTLEN = 0 means 256 bytes
+      return ((pSim->airPos & 0xFF) == pSim->regs[CC110L_PKTLEN]);
+    case SIM_LENGTH_VARIABLE:
+      return (pSim->airPos == pSim->airLen);
+    default:
+      return (FALSE);
+  }
+}
+
+static uint16 simSyncBytes(const cc110LSim_t *pSim)
+{
+  switch(pSim->regs[CC110L_MDMCFG2] & 0x07)
+  {
+    case 0:
+    case 4:  return (0);
+    case 3:
+    case 7:  return (4);
+    default: return (2);
+  }
+}
+
+static uint8 simCarrierSense(const cc110LSim_t *pSim)
+{
+  return (pSim->ccaBusy || (pSim->airPhase >= SIM_AIR_RX_PREAMBLE));
+}
+
+/* ADR_CHK 1: ADDR only, 2: or 0x00, 3: or 0x00 and 0xFF */
+static uint8 simAddressMatch(const cc110LSim_t *pSim, uint8 addr)
+{
+  uint8 adrChk = pSim->regs[CC110L_PKTCTRL1] & SIM_ADR_CHK_BM;
+
+  return ((addr == pSim->regs[CC110L_ADDR])
+          || ((adrChk >= 2) && (addr == 0x00))
+          || ((adrChk == 3) && (addr == 0xFF)));
+}
+
+static uint8 simGdoLevel(const cc110LSim_t *pSim, uint8 iocfg)
+{
+  uint8 thr   = pSim->regs[CC110L_FIFOTHR] & SIM_FIFO_THR_BM;
+  uint8 level;
+
+  switch(iocfg & SIM_GDO_CFG_BM)
+  {
+    case 0x00: level = (pSim->rxCount >= 4 * (thr + 1));                              break;
+    case 0x01: level = (pSim->rxCount >= 4 * (thr + 1))
+                       || (pSim->rxPktDone && pSim->rxCount);                        break;
+    case 0x02: level = (pSim->txCount >= 61 - 4 * thr);                               break;
+    case 0x03: level = (pSim->txCount == CC110L_SIM_FIFO_SIZE);                       break;
+    case 0x04: level = pSim->rxOverflow;                                              break;
+    case 0x05: level = pSim->txUnderflow;                                             break;
+    case 0x06: level = pSim->syncActive;                                              break;
+    case 0x07: level = pSim->crcOkPending;                                            break;
+    case 0x09: level = (pSim->marcState == CC110L_SIM_MARC_RX) && !simCarrierSense(pSim); break;
+    case 0x0E: level = (pSim->marcState == CC110L_SIM_MARC_RX) && simCarrierSense(pSim);  break;
+    case 0x29: level = (pSim->marcState == CC110L_SIM_MARC_SLEEP);                    break;
+    default:   level = 0;                                                             break;
+  }
+  if(iocfg & SIM_GDO_INV_BM)
+  {
+    level = !level;
+  }
+  return (level ? 1 : 0);
+}
+
+static void simUpdateGdo(cc110LSim_t *pSim)
+{
+  static const uint8 iocfgAddr[3] = {CC110L_IOCFG0, CC110L_IOCFG1, CC110L_IOCFG2};
+  uint8 gdo;
+  uint8 level;
+
+  for(gdo = 0; gdo < 3; gdo++)
+  {
+    level = simGdoLevel(pSim, pSim->regs[iocfgAddr[gdo]]);
+    if(level != pSim->gdo[gdo])
+    {
+      pSim->gdo[gdo] = level;
+      if(pSim->pfnGdoEdge)
+      {
+        pSim->pfnGdoEdge(pSim, gdo, level);
+      }
+    }
+  }
+}
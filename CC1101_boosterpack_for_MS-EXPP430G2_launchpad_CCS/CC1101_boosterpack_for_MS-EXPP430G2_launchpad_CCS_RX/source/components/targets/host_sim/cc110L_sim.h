@@ -0,0 +1,151 @@
+/******************************************************************************
+    Filename: cc110L_sim.h
+
+    Description: Behavioural model of the CC110L for host builds. The model
+                 is driven byte by byte over a virtual SPI bus and covers the
+                 configuration and status registers, PA table, 64 byte TX
+                 and RX FIFOs, the main radio control state machine, packet
+                 handling (length modes, address check, append status, CRC
+                 autoflush), GDO outputs and the chip status byte. Air time
+                 is simulated from the programmed data rate, preamble and
+                 sync word settings.
+                 Frequency synthesizer calibration (SCAL and FS_AUTOCAL) and
+                 settling take their datasheet time; the synthesizer locks
+                 only if FSCAL3..1 hold the calibration result for the
+                 programmed frequency and model temperature.
+
+*******************************************************************************/
+#ifndef CC110L_SIM_H
+#define CC110L_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+#define CC110L_SIM_FIFO_SIZE        64
+#define CC110L_SIM_NUM_REGS         0x2F
+#define CC110L_SIM_MAX_FRAME        512
+/* Complete frames tracked in the RX FIFO, the most of 3 bytes that fit */
+#define CC110L_SIM_RX_ENDS          32
+
+/* MARCSTATE values used by the model */
+#define CC110L_SIM_MARC_SLEEP             0x00
+#define CC110L_SIM_MARC_IDLE              0x01
+#define CC110L_SIM_MARC_MANCAL            0x05
+#define CC110L_SIM_MARC_STARTCAL          0x08
+#define CC110L_SIM_MARC_FS_LOCK           0x0A
+#define CC110L_SIM_MARC_RX                0x0D
+#define CC110L_SIM_MARC_RXFIFO_OVERFLOW   0x11
+#define CC110L_SIM_MARC_FSTXON            0x12
+#define CC110L_SIM_MARC_TX                0x13
+#define CC110L_SIM_MARC_RXTX_SWITCH       0x15
+#define CC110L_SIM_MARC_TXFIFO_UNDERFLOW  0x16
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+typedef struct cc110LSim
+{
+  /* Register file */
+  uint8   regs[CC110L_SIM_NUM_REGS];
+  uint8   paTable[8];
+  uint8   paIndex;
+  uint8   marcState;
+  uint8   sleepPending;
+
+  /* Frequency synthesizer calibration and settling in progress */
+  uint8   fsPhase;
+  uint8   fsTarget;
+  uint32  fsDue;
+  uint8   fsLocked;
+  uint8   autoCalCount;
+  int8    tempC;
+
+  /* FIFOs */
+  uint8   txFifo[CC110L_SIM_FIFO_SIZE];
+  uint8   txCount;
+  uint8   txUnderflow;
+  uint8   rxFifo[CC110L_SIM_FIFO_SIZE];
+  uint8   rxHead;
+  uint8   rxCount;
+  uint8   rxOverflow;
+  /* Bytes through the RX FIFO, and where the complete frames in it end */
+  uint32  rxPushed;
+  uint32  rxPopped;
+  uint32  rxEnds[CC110L_SIM_RX_ENDS];
+  uint8   rxEndHead;
+  uint8   rxEndCount;
+
+  /* SPI transaction in progress */
+  uint8   csActive;
+  uint8   header;
+  uint8   addr;
+  uint16  spiIndex;
+
+  /* Frame on air, TX or RX */
+  uint8   airPhase;
+  uint16  airCount;
+  uint16  airPos;
+  uint16  airLen;
+  uint16  airFrameLen;
+  uint32  airDue;
+  uint8   airBuf[CC110L_SIM_MAX_FRAME];
+  uint8   rxCrcOk;
+  int8    rxRssiDbm;
+
+  /* Signals behind the GDO pins */
+  uint8   syncActive;
+  uint8   crcOkPending;
+  uint8   rxPktDone;
+  uint8   ccaBusy;
+  uint8   lastCrcOk;
+  uint8   gdo[3];
+
+  /* Model time in microseconds */
+  uint32  timeUs;
+
+  /* Hooks to the environment, may be NULL */
+  void  (*pfnTxFrame)(struct cc110LSim *pSim, const uint8 *pFrame, uint16 len);
+  void  (*pfnGdoEdge)(struct cc110LSim *pSim, uint8 gdo, uint8 level);
+  void   *pUser;
+
+  /* Counters */
+  uint32  framesSent;
+  uint32  framesReceived;
+  uint32  framesCrcOk;
+  uint32  framesDropped;
+  uint32  framesFiltered;
+  uint32  framesRead;       /* received frames read out of the RX FIFO whole */
+  uint32  framesUnlocked;
+  uint32  calibrations;
+}cc110LSim_t;
+
+/******************************************************************************
+ * PROTOTYPES
+ */
+void   cc110LSimInit(cc110LSim_t *pSim);
+
+/* Virtual SPI bus, CS_N low/high and one byte exchanged per call */
+void   cc110LSimSelect(cc110LSim_t *pSim);
+uint8  cc110LSimSpiByte(cc110LSim_t *pSim, uint8 mosi);
+void   cc110LSimDeselect(cc110LSim_t *pSim);
+
+/* Air interface */
+void   cc110LSimAdvance(cc110LSim_t *pSim, uint32 us);
+uint8  cc110LSimAirReceive(cc110LSim_t *pSim, const uint8 *pFrame, uint16 len,
+                           int8 rssiDbm, uint8 crcOk);
+uint32 cc110LSimByteTimeUs(const cc110LSim_t *pSim);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC110L_SIM_H
@@ -0,0 +1,143 @@
+/******************************************************************************
+    Filename: hal_host_sim.h
+
+    Description: Host simulation target. Implements the board, radio SPI and
+                 radio interrupt interfaces of the msp_exp430g2 target on
+                 Linux, with a CC110L model (cc110L_sim.c) on the far side of
+                 the SPI transport. The target is selected at build time by
+                 compiling this directory instead of targets/msp_exp430g2, so
+                 the MSP430 build keeps calling the register level functions
+                 directly. The directory is excluded from the CCS projects.
+
+                 Build from the project directory, e.g. for the TX app:
+
+                 gcc -std=gnu99 -O2 -pthread -DHAL_HOST_SIM \
+                   -Isource/components/targets/host_sim \
+                   -Isource/components/targets/msp_exp430g2 \
+                   -Isource/components/targets/interface \
+                   -Isource/components/common \
+                   -Isource/components/devices/cc11x \
+                   -Isource/apps/cc1120_easyLink_vchip_boosterpack \
+                   source/apps/cc1120_easyLink_vchip_boosterpack/cc110L_easy_link_msp_exp_430g2_tx.c \
+                   source/components/common/hal_sched.c \
+                   source/components/devices/cc11x/cc11xL_spi.c \
+                   source/components/devices/cc11x/cc11xL_config.c \
+                   source/components/devices/cc11x/cc11xL_stream.c \
+                   source/components/devices/cc11x/cc11xL_radio.c \
+                   source/components/devices/cc11x/cc11xL_fscal.c \
+                   source/components/devices/cc11x/cc11xL_profile.c \
+                   source/components/devices/cc11x/cc11xL_rate.c \
+                   source/components/devices/cc11x/cc11xL_packet.c \
+                   source/components/devices/cc11x/cc11xL_stats.c \
+                   source/components/devices/cc11x/cc11xL_txpower.c \
+                   source/components/devices/cc11x/cc11xL_lbt.c \
+                   source/components/devices/cc11x/cc11xL_filter.c \
+                   source/components/devices/cc11x/cc11xL_rxqueue.c \
+                   source/components/devices/cc11x/cc11xL_pool.c \
+                   source/components/targets/host_sim/cc110L_sim.c \
+                   source/components/targets/host_sim/hal_host_sim_board.c \
+                   source/components/targets/host_sim/hal_host_sim_int_rf.c \
+                   source/components/targets/host_sim/hal_host_sim_spi.c \
+                   source/components/targets/host_sim/hal_host_sim_air.c \
+                   -o easylink_tx_sim
+
+                 The run is controlled through environment variables:
+                 HOST_SIM_FRAMES      frames to send or receive before exit (100)
+                 HOST_SIM_SPEEDUP     simulated time per real time (100)
+                 HOST_SIM_RX_PERIOD   ms of simulated time between frames
+                                      offered to the radio while in RX (500)
+                 HOST_SIM_BURST       frames offered back to back per
+                                      period, each as soon as the radio
+                                      listens again (1)
+                 HOST_SIM_PAYLOAD     length byte of offered frames (30)
+                 HOST_SIM_CRC_ERRORS  percentage of offered frames with a
+                                      bad CRC (0)
+                 HOST_SIM_RSSI        RSSI of offered frames in dBm (-60);
+                                      frames below the sensitivity of the
+                                      programmed data rate get CRC errors
+                 HOST_SIM_PATH_LOSS   dB between the PA and the peer, 0 for
+                                      none (0); when set the peer hears the
+                                      frames sent at the PA output power
+                                      less this, and answers with TX power
+                                      reports instead of offering frames
+                 HOST_SIM_DEST        address byte of offered frames, sent
+                                      after the length byte; none if not
+                                      set
+                 HOST_SIM_FOREIGN     percentage of offered frames sent to
+                                      another node's address (0)
+                 HOST_SIM_NODES       nodes on the channel, this one
+                                      included (1); the others contend
+                                      for it with the application, and
+                                      no frames are offered to the radio
+                                      in RX; see hal_host_sim_air.c
+                 HOST_SIM_NODE_PERIOD ms from the end of one frame of
+                                      another node to its next frame, 0
+                                      to always have one waiting (0)
+                 HOST_SIM_CSMA        0 to have the other nodes send
+                                      after their backoff without
+                                      assessing the channel (1)
+                 HOST_SIM_VERBOSE     print every frame on air when set
+
+                 Add -DTRX_SPI_TRACE to print the SPI transaction trace the
+                 apps drain after each packet; the drain takes the time of
+                 the target's UART.
+
+                 hal_host_sim_packet_check.c is a separate program that
+                 checks the packet descriptors and link statistics; leave
+                 it out of the simulation build, see the file for its own.
+
+                 Waits in the application take whole simulation ticks of
+                 0.1 ms of real time times HOST_SIM_SPEEDUP; lower the
+                 speedup so a tick is well below the LBT slot when nodes
+                 contend.
+
+*******************************************************************************/
+#ifndef HAL_HOST_SIM_H
+#define HAL_HOST_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc110L_sim.h"
+
+/******************************************************************************
+ * PROTOTYPES
+ */
+/* Radio model behind the SPI transport */
+cc110LSim_t *halHostSimRadio(void);
+
+/* Interrupt emulation: simulated ISRs run with the lock held, so code
+ * holding it (HAL_INT_LOCK, SPI transactions) is not interrupted.
+ */
+void  halHostSimIntLock(void);
+void  halHostSimIntUnlock(void);
+void  halHostSimIntDispatch(void);
+
+/* Radio interrupt pins, hal_host_sim_int_rf.c */
+void  halHostSimRfGdoEdge(cc110LSim_t *pSim, uint8 gdo, uint8 level);
+void  halHostSimRfDispatch(void);
+void  halHostSimRfReport(void);
+
+/* SPI transport statistics, hal_host_sim_spi.c */
+void  halHostSimSpiReport(void);
+
+/* Shared channel with other nodes, hal_host_sim_air.c */
+void  halHostSimAirInit(uint8 frameLen);
+void  halHostSimAirRun(cc110LSim_t *pSim);
+uint8 halHostSimAirNodes(void);
+void  halHostSimAirTxFrame(cc110LSim_t *pSim, uint16 len);
+void  halHostSimAirReport(const cc110LSim_t *pSim);
+
+/* Numeric run setting from the environment, hal_host_sim_board.c */
+uint32 halHostSimEnv(const char *pName, uint32 def);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// HAL_HOST_SIM_H
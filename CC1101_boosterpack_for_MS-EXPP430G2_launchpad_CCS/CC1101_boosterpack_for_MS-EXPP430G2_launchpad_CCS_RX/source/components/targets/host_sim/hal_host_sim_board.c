@@ -0,0 +1,975 @@
+/******************************************************************************
+    Filename: hal_host_sim_board.c
+
+    Description: Board support of the host simulation target: port register
+                 storage, status register and low power mode emulation,
+                 system clock bookkeeping, main loop events and CPU load,
+                 and the simulation thread that
+                 advances the radio model, plays the peer node on the air
+                 and runs simulated interrupts. See hal_host_sim.h for how to
+                 build and control a run.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "msp430.h"
+#include "hal_board.h"
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_mcu.h"
+#include "hal_msp_exp430g2_spi.h"
+#include "hal_host_sim.h"
+#include "hal_sched.h"
+#include "cc11xL_rate.h"
+#include "cc11xL_txpower.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+#define SIM_TICK_NS           100000L
+#define SIM_RSSI_DBM          (-60)
+#define SIM_PEER_WAIT_US      1000000UL
+#define SIM_PEER_PA_DBM       12
+/* HOST_SIM_DEST not set: frames carry no address byte */
+#define SIM_NO_DEST           0x100
+
+/******************************************************************************
+ * GLOBAL VARIABLES
+ */
+volatile unsigned char P1IN, P1OUT, P1DIR, P1IFG, P1IES, P1IE, P1SEL, P1SEL2, P1REN;
+volatile unsigned char P2IN, P2OUT, P2DIR, P2IFG, P2IES, P2IE, P2SEL, P2SEL2, P2REN;
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static cc110LSim_t     simRadio;
+static uint8           systemClock;
+
+/* Interrupt emulation */
+static pthread_mutex_t simLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  simWake = PTHREAD_COND_INITIALIZER;
+static pthread_t       simLockOwner;
+static volatile uint8  simLockDepth;
+static uint8           simWakeup;
+static unsigned short  simStatusReg;
+
+/* Main loop events, and model time asleep */
+static volatile uint16 simEvents;
+static uint8           simTimeoutArmed;
+static uint32          simTimeoutUs;
+static uint32          simLpm0Us;
+static uint32          simLpm3Us;
+
+/* Run control, see hal_host_sim.h */
+static uint32          simFrames     = 100;
+static uint32          simSpeedup    = 100;
+static uint32          simRxPeriodUs = 500000UL;
+static uint8           simPayload    = 30;
+static uint8           simCrcErrors;
+static int8            simRssiDbm    = SIM_RSSI_DBM;
+static uint8           simPathLoss;
+static uint16          simDest       = SIM_NO_DEST;
+static uint8           simForeign;
+static uint8           simBurst      = 1;
+static uint8           simVerbose;
+
+/* Peer node */
+static uint32          peerOffered;
+static uint32          peerForeign;      /* offered frames for other nodes */
+static uint32          peerLastUs;
+static uint8           peerBurstLeft;    /* frames still to offer back to back */
+static uint32          txBytes;
+static uint32          rateControls;
+static uint8           rateLastProfile;
+static uint16          peerCounter;
+static int32           peerRssiSum;      /* frames heard since the last report */
+static uint8           peerHeard;
+static uint8           peerReportDue;    /* the last frame sent was heard */
+static uint32          peerDelivered;
+static struct timespec simStart;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static void  *halHostSimThread(void *pArg);
+static void   halHostSimPeer(void);
+static void   halHostSimTxFrame(cc110LSim_t *pSim, const uint8 *pFrame, uint16 len);
+static void   halHostSimReport(void);
+static void   halHostSimPeerReport(void);
+static uint16 halHostSimPeerErrors(int8 rssiDbm);
+static int8   halHostSimPaDbm(const cc110LSim_t *pSim);
+
+/******************************************************************************
+ * @fn          halInitMCU
+ *
+ * @brief       Reads the run settings, powers up the radio model and starts
+ *              the simulation thread.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halInitMCU(void)
+{
+  pthread_t thread;
+
+  simFrames     = halHostSimEnv("HOST_SIM_FRAMES", simFrames);
+  simSpeedup    = halHostSimEnv("HOST_SIM_SPEEDUP", simSpeedup);
+  simRxPeriodUs = halHostSimEnv("HOST_SIM_RX_PERIOD", simRxPeriodUs / 1000UL) * 1000UL;
+  simPayload    = (uint8)halHostSimEnv("HOST_SIM_PAYLOAD", simPayload);
+  simCrcErrors  = (uint8)halHostSimEnv("HOST_SIM_CRC_ERRORS", 0);
+  simRssiDbm    = (int8)(int32)halHostSimEnv("HOST_SIM_RSSI", (uint32)(int32)simRssiDbm);
+  simPathLoss   = (uint8)halHostSimEnv("HOST_SIM_PATH_LOSS", 0);
+  simDest       = (uint16)halHostSimEnv("HOST_SIM_DEST", simDest);
+  simForeign    = (uint8)halHostSimEnv("HOST_SIM_FOREIGN", 0);
+  simBurst      = (uint8)halHostSimEnv("HOST_SIM_BURST", simBurst);
+  simVerbose    = (getenv("HOST_SIM_VERBOSE") != NULL);
+  halHostSimAirInit(simPayload);
+
+  cc110LSimInit(&simRadio);
+  simRadio.pfnTxFrame = halHostSimTxFrame;
+  simRadio.pfnGdoEdge = halHostSimRfGdoEdge;
+
+  halMcuSetSystemClock(HAL_MCU_SYSCLK_1MHZ);
+  clock_gettime(CLOCK_MONOTONIC, &simStart);
+  atexit(halHostSimReport);
+  pthread_create(&thread, NULL, halHostSimThread, NULL);
+
+  // Enable global interrupt
+  _BIS_SR(GIE);
+}
+
+/******************************************************************************
+ * @fn          halMcuSetSystemClock
+ *
+ * @brief       Records the clock setting and passes it on to the SPI
+ *              transport. Accepts the settings the target supports.
+ *
+ * input parameters
+ *
+ * @param       systemClockSpeed - HAL_MCU_SYSCLK_xMHZ
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuSetSystemClock(unsigned char systemClockSpeed)
+{
+  switch(systemClockSpeed)
+  {
+    case HAL_MCU_SYSCLK_1MHZ:
+    case HAL_MCU_SYSCLK_8MHZ:
+    case HAL_MCU_SYSCLK_12MHZ:
+    case HAL_MCU_SYSCLK_16MHZ:
+      break;
+    default:
+      return;
+  }
+  systemClock = systemClockSpeed;
+  exp430RfSpiSetClock(systemClockSpeed);
+}
+
+/******************************************************************************
+ * @fn          halMcuGetSystemClock
+ *
+ * @brief       Returns the setting of the last halMcuSetSystemClock() call.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      HAL_MCU_SYSCLK_xMHZ
+ */
+uint8 halMcuGetSystemClock(void)
+{
+  return(systemClock);
+}
+
+/******************************************************************************
+ * @fn          halMcuWaitUs
+ *
+ * @brief       Waits until the model time has advanced by usec
+ *              microseconds, to the resolution of the simulation tick.
+ *
+ * input parameters
+ *
+ * @param       usec - microseconds to wait
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuWaitUs(uint16 usec)
+{
+  struct timespec tick  = {0, SIM_TICK_NS};
+  uint32          start = simRadio.timeUs;
+
+  while(simRadio.timeUs - start < usec)
+  {
+    nanosleep(&tick, NULL);
+  }
+}
+
+/******************************************************************************
+ * @fn          halMcuWaitMs
+ *
+ * @brief       Waits until the model time has advanced by msec
+ *              milliseconds.
+ *
+ * input parameters
+ *
+ * @param       msec - milliseconds to wait
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuWaitMs(uint16 msec)
+{
+  while(msec--)
+  {
+    halMcuWaitUs(1000);
+  }
+}
+
+/******************************************************************************
+ * @fn          halMcuTimeInit
+ *
+ * @brief       The time base is the model time, nothing to start.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuTimeInit(void)
+{
+}
+
+/******************************************************************************
+ * @fn          halMcuGetTimeMs
+ *
+ * @brief       Returns the model time in milliseconds. Wraps with the
+ *              model time, after about 71 minutes.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      time in milliseconds
+ */
+uint32 halMcuGetTimeMs(void)
+{
+  return (simRadio.timeUs / 1000);
+}
+
+/******************************************************************************
+ * @fn          halMcuGetTimeTicks
+ *
+ * @brief       Returns the model time in microseconds, the ticks of this
+ *              target. Code runs in no model time: a task is timed by the
+ *              waits and SPI transfers in it.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      ticks
+ */
+uint32 halMcuGetTimeTicks(void)
+{
+  return (simRadio.timeUs);
+}
+
+/******************************************************************************
+ * @fn          halMcuTicksToUs
+ *
+ * @brief       Ticks are microseconds already.
+ *
+ * input parameters
+ *
+ * @param       ticks - halMcuGetTimeTicks() ticks
+ *
+ * output parameters
+ *
+ * @return      microseconds
+ */
+uint32 halMcuTicksToUs(uint32 ticks)
+{
+  return (ticks);
+}
+
+/******************************************************************************
+ * @fn          halMcuEventSet
+ *
+ * @brief       Sets events for halMcuEventWait().
+ *
+ * input parameters
+ *
+ * @param       events - bitmask, defined by the application
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuEventSet(uint16 events)
+{
+  halHostSimIntLock();
+  simEvents |= events;
+  halHostSimIntUnlock();
+}
+
+/******************************************************************************
+ * @fn          halMcuEventClear
+ *
+ * @brief       Drops events set so far.
+ *
+ * input parameters
+ *
+ * @param       events - bitmask
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuEventClear(uint16 events)
+{
+  halHostSimIntLock();
+  simEvents &= ~events;
+  halHostSimIntUnlock();
+}
+
+/******************************************************************************
+ * @fn          halMcuEventWait
+ *
+ * @brief       Sleeps until one of the events is set, and takes the ones
+ *              set: in LPM0 while an SPI transaction submitted with
+ *              trxSpiSubmit() is outstanding, else in LPM3. The timeout is
+ *              kept by the simulation thread.
+ *
+ * input parameters
+ *
+ * @param       events    - bitmask
+ * @param       timeoutMs - 0 to wait for ever, else HAL_MCU_EVENT_TIMEOUT
+ *                          is set after as many milliseconds
+ *
+ * output parameters
+ *
+ * @return      the events taken, HAL_MCU_EVENT_TIMEOUT if none came
+ */
+uint16 halMcuEventWait(uint16 events, uint16 timeoutMs)
+{
+  uint16 taken;
+
+  halHostSimIntLock();
+  if(timeoutMs)
+  {
+    simTimeoutUs    = simRadio.timeUs + (uint32)timeoutMs * 1000UL;
+    simTimeoutArmed = TRUE;
+    simEvents      &= ~HAL_MCU_EVENT_TIMEOUT;
+    events         |= HAL_MCU_EVENT_TIMEOUT;
+  }
+  while(!(simEvents & events))
+  {
+    __bis_SR_register((trxSpiAsyncPending() ? LPM0_bits : LPM3_bits) + GIE);
+  }
+  simTimeoutArmed = FALSE;
+  taken      = simEvents & events;
+  simEvents &= ~taken;
+  halHostSimIntUnlock();
+  return (taken);
+}
+
+/******************************************************************************
+ * @fn          halMcuGetCpuStats
+ *
+ * @brief       Returns the model time spent awake and asleep, in us, and
+ *              the average MCU supply current from the typical figures in
+ *              hal_board.h. Code runs in no model time: awake is the time
+ *              spent in waits, SPI transfers and the like.
+ *
+ * input parameters
+ *
+ * output parameters
+ *
+ * @param       pStats - gets the figures
+ *
+ * @return      void
+ */
+void halMcuGetCpuStats(halMcuCpuStats_t *pStats)
+{
+  uint64_t total;
+  uint16   lpm0Pm;
+  uint16   lpm3Pm;
+
+  halHostSimIntLock();
+  pStats->totalTicks = simRadio.timeUs;
+  pStats->lpm0Ticks  = simLpm0Us;
+  pStats->lpm3Ticks  = simLpm3Us;
+  halHostSimIntUnlock();
+
+  total  = pStats->totalTicks;
+  lpm0Pm = total ? (uint16)((uint64_t)pStats->lpm0Ticks * 1000 / total) : 0;
+  lpm3Pm = total ? (uint16)((uint64_t)pStats->lpm3Ticks * 1000 / total) : 0;
+  pStats->activePermille = total ? 1000 - lpm0Pm - lpm3Pm : 1000;
+  pStats->currentNa = (HAL_BOARD_AM_NA * pStats->activePermille
+                       + HAL_BOARD_LPM0_NA * lpm0Pm
+                       + HAL_BOARD_LPM3_NA * lpm3Pm) / 1000;
+}
+
+/******************************************************************************
+ * @fn          halMcuCompilerBarrier
+ *
+ * @brief       Compiler barrier as a call, see HAL_MCU_COMPILER_BARRIER();
+ *              GCC builds use the asm form instead.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuCompilerBarrier(void)
+{
+  HAL_MCU_COMPILER_BARRIER();
+}
+
+/******************************************************************************
+ * @fn          halAssertHandler
+ *
+ * @brief       Called by HAL_ASSERT() on a failed check: reports it and
+ *              aborts the run.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void, does not return
+ */
+void halAssertHandler(void)
+{
+  fprintf(stderr, "HAL_ASSERT failed\n");
+  abort();
+}
+
+/******************************************************************************
+ * LEDs and button. The button reads as pushed, so button driven loops run
+ * continuously; no push is posted to a task.
+ */
+void halLedInit(void)
+{
+  LED_DIR |= LED1 + LED2;
+  LED_OUT &= ~(LED1 + LED2);
+}
+
+void halLedSet(uint8 led_id)
+{
+  LED_OUT |= led_id;
+}
+
+void halLedClear(uint8 led_id)
+{
+  LED_OUT &= ~(led_id);
+}
+
+void halLedToggle(uint8 led_id)
+{
+  LED_OUT ^= led_id;
+}
+
+void halButtonInit(void)
+{
+}
+
+void halButtonInterruptEnable(void)
+{
+}
+
+uint8 halButtonPushed(void)
+{
+  return (BUTTON_PRESSED);
+}
+
+void halButtonSetTask(uint8 task, uint16 events)
+{
+  (void)task;
+  (void)events;
+}
+
+/******************************************************************************
+ * @fn          halHostSimRadio
+ *
+ * @brief       Returns the radio model behind the SPI transport.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      model instance
+ */
+cc110LSim_t *halHostSimRadio(void)
+{
+  return (&simRadio);
+}
+
+/******************************************************************************
+ * @fn          halHostSimIntLock
+ *
+ * @brief       Holds off simulated interrupts. Nests within a thread.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimIntLock(void)
+{
+  if(simLockDepth && pthread_equal(simLockOwner, pthread_self()))
+  {
+    simLockDepth++;
+    return;
+  }
+  pthread_mutex_lock(&simLock);
+  simLockOwner = pthread_self();
+  simLockDepth = 1;
+}
+
+/******************************************************************************
+ * @fn          halHostSimIntUnlock
+ *
+ * @brief       Releases one level of halHostSimIntLock().
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimIntUnlock(void)
+{
+  if(--simLockDepth == 0)
+  {
+    pthread_mutex_unlock(&simLock);
+  }
+}
+
+/******************************************************************************
+ * @fn          halHostSimIntDispatch
+ *
+ * @brief       Runs pending simulated ISRs, unless the caller is inside a
+ *              nested lock (interrupts disabled on the target). Called with
+ *              the lock held.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimIntDispatch(void)
+{
+  if(simLockDepth == 1)
+  {
+    halHostSimRfDispatch();
+  }
+}
+
+/******************************************************************************
+ * Status register intrinsics, see msp430.h. Entering a low power mode waits
+ * for __low_power_mode_off_on_exit() from a simulated ISR; the interrupt
+ * lock is released meanwhile, as LPM entry sets GIE on the target.
+ */
+void __bis_SR_register(unsigned short bits)
+{
+  uint8  depth;
+  uint32 sleepUs;
+
+  halHostSimIntLock();
+  simStatusReg |= bits;
+  if(bits & CPUOFF)
+  {
+    depth        = simLockDepth;
+    simLockDepth = 0;
+    simWakeup    = FALSE;
+    sleepUs      = simRadio.timeUs;
+    while(!simWakeup)
+    {
+      pthread_cond_wait(&simWake, &simLock);
+    }
+    simLockOwner  = pthread_self();
+    simLockDepth  = depth;
+    simStatusReg &= ~(LPM4_bits);
+    // time asleep, by the clocks left running
+    sleepUs = simRadio.timeUs - sleepUs;
+    if(bits & (SCG0 | SCG1))
+    {
+      simLpm3Us += sleepUs;
+    }
+    else
+    {
+      simLpm0Us += sleepUs;
+    }
+  }
+  halHostSimIntUnlock();
+}
+
+void __bic_SR_register(unsigned short bits)
+{
+  halHostSimIntLock();
+  simStatusReg &= ~bits;
+  halHostSimIntUnlock();
+}
+
+unsigned short _get_SR_register(void)
+{
+  return (simStatusReg);
+}
+
+void __low_power_mode_off_on_exit(void)
+{
+  simWakeup = TRUE;
+  pthread_cond_broadcast(&simWake);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void *halHostSimThread(void *pArg)
+{
+  struct timespec tick = {0, SIM_TICK_NS};
+  struct timespec last;
+  struct timespec now;
+  uint64_t        elapsedNs;
+
+  (void)pArg;
+  clock_gettime(CLOCK_MONOTONIC, &last);
+  for(;;)
+  {
+    nanosleep(&tick, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsedNs = (uint64_t)(now.tv_sec - last.tv_sec) * 1000000000ULL
+                + (uint64_t)now.tv_nsec - (uint64_t)last.tv_nsec;
+    last = now;
+
+    halHostSimIntLock();
+    cc110LSimAdvance(&simRadio, (uint32)(elapsedNs * simSpeedup / 1000ULL));
+    halHostSimAirRun(&simRadio);
+    halHostSimPeer();
+    if(simTimeoutArmed && ((int32)(simRadio.timeUs - simTimeoutUs) >= 0))
+    {
+      simTimeoutArmed = FALSE;
+      simEvents      |= HAL_MCU_EVENT_TIMEOUT;
+      __low_power_mode_off_on_exit();
+    }
+    halHostSimIntDispatch();
+    halHostSimIntUnlock();
+  }
+  return (NULL);
+}
+
+/* Offers an easy link style frame whenever the radio listens, and ends the
+ * run once enough frames have gone either way. With HOST_SIM_BURST above 1
+ * the frames come in bursts, each frame of a burst offered as soon as the
+ * radio listens again after the one before. After the last frame offered
+ * the run waits for the radio to finish it, up to a second. With
+ * HOST_SIM_DEST set the address byte follows the length byte, and frames
+ * for other nodes go to address 0x01, or 0x02 if that is the destination;
+ * they do not advance the packet counter.
+ */
+static void halHostSimPeer(void)
+{
+  uint8  frame[256];
+  uint8  pos = 1;
+  uint8  foreign;
+  uint16 i;
+  uint32 sinceLastUs = simRadio.timeUs - peerLastUs;
+
+  if((simRadio.framesSent >= simFrames)
+     || ((peerOffered >= simFrames) && (sinceLastUs >= simRxPeriodUs)
+         && ((simRadio.framesReceived + simRadio.framesDropped
+              + simRadio.framesFiltered >= peerOffered)
+             || (sinceLastUs >= simRxPeriodUs + SIM_PEER_WAIT_US))))
+  {
+    exit(0);
+  }
+  if(simPathLoss)
+  {
+    halHostSimPeerReport();
+    return;
+  }
+  // other nodes make the traffic on a shared channel
+  if(halHostSimAirNodes() > 1)
+  {
+    return;
+  }
+  if((peerOffered >= simFrames) || (!peerBurstLeft && (sinceLastUs < simRxPeriodUs)))
+  {
+    return;
+  }
+
+  foreign  = ((uint8)(rand() % 100) < simForeign);
+  frame[0] = simPayload;
+  if(simDest != SIM_NO_DEST)
+  {
+    frame[pos++] = !foreign ? (uint8)simDest : (simDest == 0x01) ? 0x02 : 0x01;
+  }
+  frame[pos++] = (uint8)(peerCounter >> 8);
+  frame[pos++] = (uint8)peerCounter;
+  for(i = pos; i <= simPayload; i++)
+  {
+    frame[i] = (uint8)rand();
+  }
+  if(cc110LSimAirReceive(&simRadio, frame, (uint16)simPayload + 1, simRssiDbm,
+                         ((uint8)(rand() % 100) >= simCrcErrors)
+                         && ((uint16)(rand() % 1000) >= halHostSimPeerErrors(simRssiDbm))))
+  {
+    peerOffered++;
+    peerBurstLeft = (peerBurstLeft ? peerBurstLeft : (simBurst ? simBurst : 1)) - 1;
+    if(foreign)
+    {
+      peerForeign++;
+    }
+    else
+    {
+      peerCounter++;
+    }
+    peerLastUs = simRadio.timeUs;
+  }
+}
+
+/* With a path loss set the peer receives instead: it answers a frame it
+ * heard with a TX power report as soon as the radio listens, like the easy
+ * link RX app does in the slots the TX app listens in.
+ */
+static void halHostSimPeerReport(void)
+{
+  uint8 frame[CC11XL_TXPOWER_FB_LEN + 1];
+  int8  rssiDbm = SIM_PEER_PA_DBM - (int16)simPathLoss;
+
+  if(!peerReportDue)
+  {
+    return;
+  }
+  cc11xLTxPowerBuildFeedback(frame, (int8)(peerRssiSum / peerHeard), peerHeard);
+  if(cc110LSimAirReceive(&simRadio, frame, sizeof(frame), rssiDbm,
+                         (uint16)(rand() % 1000) >= halHostSimPeerErrors(rssiDbm)))
+  {
+    peerRssiSum   = 0;
+    peerHeard     = 0;
+    peerReportDue = FALSE;
+  }
+}
+
+static void halHostSimTxFrame(cc110LSim_t *pSim, const uint8 *pFrame, uint16 len)
+{
+  uint16 i;
+
+  int8   rssiDbm;
+
+  txBytes += len;
+  halHostSimAirTxFrame(pSim, len);
+  if((len == CC11XL_RATE_CTRL_LEN + 1) && (pFrame[0] == CC11XL_RATE_CTRL_LEN)
+     && (pFrame[1] == CC11XL_RATE_CTRL_SET))
+  {
+    rateControls++;
+    rateLastProfile = pFrame[2];
+  }
+  else if(simPathLoss)
+  {
+    // the peer hears the frame at the PA output power less the path loss
+    rssiDbm       = (int8)(halHostSimPaDbm(pSim) - simPathLoss);
+    peerReportDue = ((uint16)(rand() % 1000) >= halHostSimPeerErrors(rssiDbm));
+    if(peerReportDue)
+    {
+      peerRssiSum += rssiDbm;
+      peerHeard    = (peerHeard < 0xFF) ? peerHeard + 1 : peerHeard;
+      peerDelivered++;
+    }
+  }
+  if(simVerbose)
+  {
+    printf("%10lu us tx %3u:", (unsigned long)pSim->timeUs, len);
+    for(i = 0; i < len; i++)
+    {
+      printf(" %02X", pFrame[i]);
+    }
+    printf("\n");
+  }
+}
+
+static void halHostSimReport(void)
+{
+  struct timespec now;
+  uint32          wallMs;
+  uint64_t        bytes;
+  uint64_t        rate;
+  uint32          kept = peerOffered - simRadio.framesFiltered;
+  const cc11xLTxPowerStats_t *pPower = cc11xLTxPowerGetStats(0);
+  halMcuCpuStats_t cpu;
+  const halSchedStats_t *pTask;
+  uint8           task;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  wallMs = (uint32)((now.tv_sec - simStart.tv_sec) * 1000L
+                    + (now.tv_nsec - simStart.tv_nsec) / 1000000L);
+  printf("radio: %lu sent, %lu received, %lu dropped; peer offered %lu\n",
+         (unsigned long)simRadio.framesSent, (unsigned long)simRadio.framesReceived,
+         (unsigned long)simRadio.framesDropped, (unsigned long)peerOffered);
+  printf("time: %lu ms simulated, %lu ms wall\n",
+         (unsigned long)(simRadio.timeUs / 1000UL), (unsigned long)wallMs);
+  halMcuGetCpuStats(&cpu);
+  printf("cpu: %u.%u%% active, %lu.%lu uA average MCU current\n",
+         cpu.activePermille / 10, cpu.activePermille % 10,
+         (unsigned long)(cpu.currentNa / 1000), (unsigned long)(cpu.currentNa % 1000 / 100));
+  // longest run and wait for a run of each task, by priority
+  for(task = 0; task < halSchedGetTaskCount(); task++)
+  {
+    pTask = halSchedGetStats(task);
+    printf("task %u: %u runs, longest %lu us, longest wait %lu us\n", task, pTask->runs,
+           (unsigned long)halMcuTicksToUs(pTask->maxRunTicks),
+           (unsigned long)halMcuTicksToUs(pTask->maxWaitTicks));
+  }
+  // payload throughput over the run and packet error rate of offered
+  // frames the address check kept
+  bytes = txBytes + (uint64_t)simRadio.framesCrcOk * ((uint16)simPayload + 1);
+  printf("link: %lu bit/s", (unsigned long)(simRadio.timeUs ? bytes * 8000000ULL / simRadio.timeUs : 0));
+  if(kept)
+  {
+    printf(", PER %lu.%lu%%", (unsigned long)((kept - simRadio.framesCrcOk) * 100UL / kept),
+           (unsigned long)((kept - simRadio.framesCrcOk) * 1000UL / kept % 10));
+  }
+  printf("\n");
+  if(simRadio.framesRead && simRadio.timeUs)
+  {
+    rate = (uint64_t)simRadio.framesRead * 10000000ULL / simRadio.timeUs;
+    printf("rx: %lu frames read whole, %lu.%lu packets/s\n", (unsigned long)simRadio.framesRead,
+           (unsigned long)(rate / 10), (unsigned long)(rate % 10));
+  }
+  if(peerForeign || simRadio.framesFiltered)
+  {
+    printf("filter: %lu frames for other nodes offered, %lu dropped by the address check\n",
+           (unsigned long)peerForeign, (unsigned long)simRadio.framesFiltered);
+  }
+  if(rateControls)
+  {
+    printf("rate: %lu control frames sent, last to profile %u\n",
+           (unsigned long)rateControls, rateLastProfile);
+  }
+  if(simPathLoss)
+  {
+    printf("peer: %lu dB path loss, %lu of %lu frames heard\n", (unsigned long)simPathLoss,
+           (unsigned long)peerDelivered, (unsigned long)simRadio.framesSent);
+  }
+  if(pPower->sent)
+  {
+    printf("power: %d dBm, %u uJ per delivered packet, %lu uJ at full power\n",
+           cc11xLTxPowerGetDbm(0), cc11xLTxPowerEnergyPerPacket(0),
+           (unsigned long)(pPower->delivered ? pPower->energyMaxUj / pPower->delivered : 0));
+  }
+  printf("synth: %lu calibrations, %lu frames sent unlocked\n",
+         (unsigned long)simRadio.calibrations, (unsigned long)simRadio.framesUnlocked);
+  halHostSimAirReport(&simRadio);
+  halHostSimRfReport();
+  halHostSimSpiReport();
+}
+
+/* Frame errors in per mille at an RSSI. The sensitivity (1% PER)
+ * follows the data rate the radio is programmed for, stepped like the easy
+ * link profiles; every 2 dB below it gives ten times the errors.
+ */
+static uint16 halHostSimPeerErrors(int8 rssiDbm)
+{
+  static const int8   sensDbm[4] = {-112, -104, -99, -95};
+  static const uint16 perMille[6] = {0, 1, 10, 100, 500, 1000};
+  uint32 byteUs = cc110LSimByteTimeUs(&simRadio);
+  uint8  rate;
+  int16  margin;
+
+  rate   = (byteUs >= 3000) ? 0 : (byteUs >= 150) ? 1 : (byteUs >= 60) ? 2 : 3;
+  margin = rssiDbm - sensDbm[rate];
+  if(margin >= 4)
+  {
+    return (perMille[0]);
+  }
+  if(margin < -4)
+  {
+    return (perMille[5]);
+  }
+  // 2 dB steps from [2, 4) down to [-4, -2)
+  return (perMille[(5 - margin) / 2]);
+}
+
+/* Output power of the PATABLE entry FREND0 selects, from the typical
+ * figures the easy link PA settings use; 0 dBm for other values
+ */
+static int8 halHostSimPaDbm(const cc110LSim_t *pSim)
+{
+  static const uint8 paValue[] = {0x03, 0x0F, 0x1E, 0x27, 0x50, 0x81, 0xCB, 0xC2, 0xC0};
+  static const int8  paDbm[]   = { -30,  -20,  -15,  -10,    0,    5,    7,   10,   12};
+  uint8 pa = pSim->paTable[pSim->regs[CC110L_FREND0] & CC11XL_FREND0_PA_POWER_BM];
+  uint8 i;
+
+  for(i = 0; i < sizeof(paValue); i++)
+  {
+    if(paValue[i] == pa)
+    {
+      return (paDbm[i]);
+    }
+  }
+  return (0);
+}
+
+/******************************************************************************
+ * @fn          halHostSimEnv
+ *
+ * @brief       Reads a numeric run setting from the environment.
+ *
+ * input parameters
+ *
+ * @param       pName - variable name
+ * @param       def   - value if it is not set
+ *
+ * output parameters
+ *
+ * @return      the value
+ */
+uint32 halHostSimEnv(const char *pName, uint32 def)
+{
+  const char *pValue = getenv(pName);
+
+  return (pValue ? (uint32)strtoul(pValue, NULL, 0) : def);
+}
@@ -0,0 +1,201 @@
+/******************************************************************************
+    Filename: hal_host_sim_packet_check.c
+
+    Description: Host check of the received packet descriptors
+                 (cc11xL_packet.c) and the link statistics (cc11xL_stats.c):
+                 the RSSI conversion at its edges, the length checks of the
+                 frame parser, and the RSSI range and mean, LQI histogram,
+                 CRC failures and packet rate window of the statistics.
+                 A program of its own, not part of the simulation build.
+
+                 Build and run from the project directory:
+
+                 gcc -std=gnu99 -O2 -DHAL_HOST_SIM \
+                   -Isource/components/targets/host_sim \
+                   -Isource/components/targets/msp_exp430g2 \
+                   -Isource/components/targets/interface \
+                   -Isource/components/common \
+                   -Isource/components/devices/cc11x \
+                   source/components/targets/host_sim/hal_host_sim_packet_check.c \
+                   source/components/devices/cc11x/cc11xL_packet.c \
+                   source/components/devices/cc11x/cc11xL_stats.c \
+                   -o packet_check && ./packet_check
+
+                 It prints each failed check and exits non-zero if any
+                 failed.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "cc11xL_packet.h"
+#include "cc11xL_stats.h"
+
+/******************************************************************************
+ * MACROS
+ */
+#define CHECK(expr) st( checks++; if(!(expr)) { failures++; \
+                        printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #expr); } )
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static uint16 checks;
+static uint16 failures;
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void checkRssi(void);
+static void checkParse(void);
+static void checkStats(void);
+
+/******************************************************************************
+ * @fn          main
+ *
+ * @brief       Runs the checks and reports the result.
+ *
+ * input parameters
+ *
+ * output parameters
+ *
+ * @return      0 if all checks passed, 1 otherwise
+ */
+int main(void)
+{
+  checkRssi();
+  checkParse();
+  checkStats();
+
+  printf("packet check: %u checks, %u failed\n", checks, failures);
+  return (failures ? 1 : 0);
+}
+
+/******************************************************************************
+ * @fn          checkRssi
+ *
+ * @brief       RSSI register to dBm at both ends of the two's complement
+ *              range and across the sign change; half dB steps
+ *              truncate toward zero.
+ *
+ * input parameters
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void checkRssi(void)
+{
+  CHECK(cc11xLPacketRssiDbm(0x00) == -74);
+  CHECK(cc11xLPacketRssiDbm(0x01) == -74);
+  CHECK(cc11xLPacketRssiDbm(0x7F) == -11);
+  CHECK(cc11xLPacketRssiDbm(0xFF) == -74);
+  CHECK(cc11xLPacketRssiDbm(0xD0) == -98);
+  CHECK(cc11xLPacketRssiDbm(0x80) == -128);
+}
+
+/******************************************************************************
+ * @fn          checkParse
+ *
+ * @brief       A frame held in one buffer: the descriptor points into it,
+ *              and frames whose length byte does not match the bytes read
+ *              are refused.
+ *
+ * input parameters
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void checkParse(void)
+{
+  // length byte, 5 payload bytes, RSSI, CRC_OK | LQI
+  uint8 frame[8] = {5, 1, 2, 3, 4, 5, 0xD0, 0x80 | 17};
+  cc11xLPacket_t packet;
+
+  CHECK(cc11xLPacketParse(&packet, frame, sizeof(frame)) == SUCCESS);
+  CHECK(packet.length == 5);
+  CHECK(packet.pPayload == &frame[1]);
+  CHECK(packet.rssiDbm == -98);
+  CHECK(packet.lqi == 17);
+  CHECK(packet.crcOk);
+
+  // status bytes missing, and too short for even a length byte and status
+  CHECK(cc11xLPacketParse(&packet, frame, sizeof(frame) - 1) == FAILED);
+  CHECK(!packet.crcOk);
+  CHECK(cc11xLPacketParse(&packet, frame, 2) == FAILED);
+
+  frame[7] = 17;
+  CHECK(cc11xLPacketParse(&packet, frame, sizeof(frame)) == SUCCESS);
+  CHECK(!packet.crcOk);
+}
+
+/******************************************************************************
+ * @fn          checkStats
+ *
+ * @brief       25 frames 100 ms apart, every fifth with a bad CRC, RSSI
+ *              rising from -98 dBm and LQI from 0 in steps of 5, then a
+ *              flushed frame and a silence that closes the rate window.
+ *
+ * input parameters
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void checkStats(void)
+{
+  cc11xLStats_t stats;
+  cc11xLPacket_t packet;
+  uint8 status[2];
+  uint16 histTotal;
+  uint8 i;
+
+  cc11xLStatsReset(&stats, 1000);
+  CHECK(stats.packets == 0);
+  CHECK(cc11xLStatsRssiMean(&stats) == -128);
+  CHECK(cc11xLStatsPacketRate(&stats, 1500) == 0);
+
+  for(i = 0; i < 25; i++)
+  {
+    status[0] = 0xD0 + i;
+    status[1] = (i % 5 ? 0x80 : 0) | (i * 5);
+    cc11xLPacketSetStatus(&packet, status);
+    cc11xLStatsAdd(&stats, &packet, 1000 + i * 100UL);
+  }
+  CHECK(stats.packets == 25);
+  CHECK(stats.crcErrors == 5);
+  CHECK(stats.rssiMin == -98);
+  CHECK(stats.rssiMax == -86);
+  CHECK(cc11xLStatsRssiMean(&stats) == -91);
+
+  // LQI 0 - 120 in bins of 16
+  histTotal = 0;
+  for(i = 0; i < CC11XL_STATS_LQI_BINS; i++)
+  {
+    histTotal += stats.lqiHist[i];
+  }
+  CHECK(histTotal == 25);
+  CHECK(stats.lqiHist[0] == 4);
+  CHECK(stats.lqiHist[CC11XL_STATS_LQI_BINS - 1] == 2);
+
+  // 10 frames in the window closed at 2000 ms, 10 in the one at 3000 ms
+  CHECK(stats.packetRate == 100);
+  CHECK(stats.windowPackets == 4);
+
+  // a flushed frame counts as a CRC failure, and not in the RSSI mean
+  cc11xLStatsAddFlushed(&stats, 3500);
+  CHECK(stats.packets == 26);
+  CHECK(stats.crcErrors == 6);
+  CHECK(stats.flushed == 1);
+  CHECK(cc11xLStatsRssiMean(&stats) == -91);
+
+  // 4 frames and the flushed one since 3000 ms, closed by the silence
+  CHECK(cc11xLStatsPacketRate(&stats, 10000) == 7);
+  CHECK(cc11xLStatsPacketRate(&stats, 12000) == 0);
+}
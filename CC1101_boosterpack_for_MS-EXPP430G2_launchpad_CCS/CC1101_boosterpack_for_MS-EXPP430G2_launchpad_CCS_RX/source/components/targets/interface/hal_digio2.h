@@ -48,6 +48,16 @@
 #include "hal_digio.h"
 
 
+/******************************************************************************
+* MACROS
+*/
+/* Called by a pin handler to have the main loop woken from low power mode
+ * when the port ISR returns. Handlers that only record or rearm something
+ * leave it out, and the CPU stays in LPM.
+ */
+#define HAL_DIGIO2_WAKE_ON_EXIT()   st( halDigio2WakeOnExit = TRUE; )
+
+
 /******************************************************************************
 * TYPEDEFS
 */
@@ -57,6 +67,12 @@ typedef struct {
 } digio;
 
 
+/******************************************************************************
+* GLOBAL VARIABLES
+*/
+extern uint8 halDigio2WakeOnExit;
+
+
 /******************************************************************************
 * GLOBAL FUNCTIONS
 */
@@ -82,6 +82,37 @@ enum {
     HAL_MCU_SYSCLK_25MHZ = 6
 };
 
+// Event set by halMcuEventWait() when its timeout expires
+#define HAL_MCU_EVENT_TIMEOUT   0x8000
+
+
+/*******************************************************************************
+ * MACROS
+ */
+// Compiler barrier: memory accesses are not moved across it. GCC takes an
+// empty asm that clobbers memory; other compilers get a call to a function
+// they cannot see into.
+#if defined(__GNUC__) && !defined(__TI_COMPILER_VERSION__)
+#define HAL_MCU_COMPILER_BARRIER()  __asm__ __volatile__("" ::: "memory")
+#else
+#define HAL_MCU_COMPILER_BARRIER()  halMcuCompilerBarrier()
+#endif
+
+
+/*******************************************************************************
+ * TYPEDEFS
+ */
+// Time spent asleep in halMcuEventWait(), in time base ticks, and what the
+// MCU draws on average as a result
+typedef struct
+{
+    uint32 totalTicks;      // since halMcuTimeInit(), wraps
+    uint32 lpm0Ticks;
+    uint32 lpm3Ticks;
+    uint16 activePermille;  // the rest, CPU on
+    uint32 currentNa;       // average MCU supply current, typical figures
+} halMcuCpuStats_t;
+
 
 /*******************************************************************************
  * GLOBAL FUNCTIONS
@@ -92,6 +123,20 @@ void halMcuInit(void);
 void halMcuWaitUs(uint16 usec);
 void halMcuWaitMs(uint16 msec);
 
+// Time base, a free running millisecond count
+void halMcuTimeInit(void);
+uint32 halMcuGetTimeMs(void);
+// and its ticks, for timing short stretches of code
+uint32 halMcuGetTimeTicks(void);
+uint32 halMcuTicksToUs(uint32 ticks);
+
+// Events, a bitmask set by ISRs; the main loop sleeps until one it waits
+// for is set
+void halMcuEventSet(uint16 events);
+void halMcuEventClear(uint16 events);
+uint16 halMcuEventWait(uint16 events, uint16 timeoutMs);
+void halMcuGetCpuStats(halMcuCpuStats_t *pStats);
+
 void halMcuSetLowPowerMode(uint8 mode);
 uint8 halMcuGetResetCause(void);
 
@@ -105,6 +150,7 @@ void halMcuSetSystemClock(unsigned char systemClockSpeed);
 /* NOTE: function holds the syctem clock speed set by a call to halMcuSetSystemClock */
 uint8 halMcuGetSystemClock(void);
 void halMcuDisablePeripheralClockRequest(uint16 bitMask);
+void halMcuCompilerBarrier(void);
 
 void halMcuSetRfIrqPriority(uint8 level);
 
@@ -39,6 +39,18 @@ extern "C" {
 #define     BUTTON_PRESSED        1
 #define     BUTTON_IDLE           0
 
+/* Typical MSP430G2553 supply current at 3 V with MCLK = SMCLK = 1 MHz, from
+ * the data sheet, in nA; LPM3 with ACLK from the VLO, or from a 32768 Hz
+ * crystal with HAL_MCU_ACLK_XT1
+ */
+#define     HAL_BOARD_AM_NA       330000UL
+#define     HAL_BOARD_LPM0_NA     73000UL
+#ifdef HAL_MCU_ACLK_XT1
+#define     HAL_BOARD_LPM3_NA     900UL
+#else
+#define     HAL_BOARD_LPM3_NA     600UL
+#endif
+
 
 
 /******************************************************************************
@@ -52,6 +64,7 @@ void  halLedToggle(uint8 led_id);
 void  halButtonInit(void);
 void  halButtonInterruptEnable(void);
 uint8 halButtonPushed(void);
+void  halButtonSetTask(uint8 task, uint16 events);
 
 
 
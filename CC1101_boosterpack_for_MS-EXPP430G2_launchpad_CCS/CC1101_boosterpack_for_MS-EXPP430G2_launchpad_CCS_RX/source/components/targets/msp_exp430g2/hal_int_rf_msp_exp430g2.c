@@ -22,15 +22,17 @@
 * CONSTANTS
 */
 
-/* Interrupt port and pin */
-#define TRXEM_INT_PORT_IN P1IN
-
-digio gpio3 = {1,0};
-digio gpio2 = {1,0};
-digio gpio0 = {2,6};
+/* ISR table slots of the radio GPIOs in hal_digio2.c */
+static const digio gpio3 = {TRX_GPIO3_PORT, TRX_GPIO3_PIN};
+static const digio gpio2 = {TRX_GPIO2_PORT, TRX_GPIO2_PIN};
+static const digio gpio0 = {TRX_GPIO0_PORT, TRX_GPIO0_PIN};
 
 /******************************************************************************
  * FUNCTIONS
+ *
+ * Run time selection of the GPIO for callers that do not know it at compile
+ * time. Each case is the compile time binding of hal_int_rf_msp_exp430g2.h,
+ * unknown values select GPIO_0.
  */
  
 
@@ -50,28 +52,25 @@ digio gpio0 = {2,6};
  */ 
 void trxIsrConnect(uint8 gpio, uint8 edge, ISR_FUNC_PTR pF)
 {
-  digio io;
+  const digio *pIo;
   
   switch(gpio)
   {
    case GPIO_3:
-    io = gpio3;
+    pIo = &gpio3;
     break;
    case GPIO_2:
-    io = gpio2;
-    break;
-   case GPIO_0:
-    io = gpio0;
+    pIo = &gpio2;
     break;
    default:
-    io = gpio0;
+    pIo = &gpio0;
     break;
   }
   
   // Assigning ISR function
-  halDigio2IntConnect(io, pF);
+  halDigio2IntConnect(*pIo, pF);
   // Setting rising or falling edge trigger
-  halDigio2IntSetEdge(io, edge);
+  trxSetIntEdge(gpio, edge);
   return;
 }
 /*******************************************************************************
@@ -89,25 +88,49 @@ void trxIsrConnect(uint8 gpio, uint8 edge, ISR_FUNC_PTR pF)
  */
 void trxClearIntFlag(uint8 gpio)
 {
-  digio io;
-  
   switch(gpio)
   {
    case GPIO_3:
-    io = gpio3;
+    TRX_INT_CLEAR(GPIO_3);
     break;
    case GPIO_2:
-    io = gpio2;
+    TRX_INT_CLEAR(GPIO_2);
     break;
-   case GPIO_0:
-    io = gpio0;
+   default:
+    TRX_INT_CLEAR(GPIO_0);
+    break;
+  }
+  return;
+}
+
+/*******************************************************************************
+ * @fn          trxSetIntEdge
+ *
+ * @brief       Selects the edge the sync interrupt triggers on
+ *
+ * input parameters
+ *
+ * @param       gpio - GPIO_0, GPIO_2 or GPIO_3
+ * @param       edge - RISING_EDGE or FALLING_EDGE
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxSetIntEdge(uint8 gpio, uint8 edge)
+{
+  switch(gpio)
+  {
+   case GPIO_3:
+    TRX_INT_SET_EDGE(GPIO_3, edge);
+    break;
+   case GPIO_2:
+    TRX_INT_SET_EDGE(GPIO_2, edge);
     break;
    default:
-    io = gpio0;
+    TRX_INT_SET_EDGE(GPIO_0, edge);
     break;
   }
-  
-  halDigio2IntClear(io);
   return;
 }
 
@@ -126,25 +149,18 @@ void trxClearIntFlag(uint8 gpio)
  */ 
 void trxEnableInt(uint8 gpio)
 {
-  digio io;
-  
   switch(gpio)
   {
    case GPIO_3:
-    io = gpio3;
+    TRX_INT_ENABLE(GPIO_3);
     break;
    case GPIO_2:
-    io = gpio2;
-    break;
-   case GPIO_0:
-    io = gpio0;
+    TRX_INT_ENABLE(GPIO_2);
     break;
    default:
-    io = gpio0;
+    TRX_INT_ENABLE(GPIO_0);
     break;
   }
-  
-  halDigio2IntEnable(io);
   return;
 }
 
@@ -163,25 +179,18 @@ void trxEnableInt(uint8 gpio)
  */ 
 void trxDisableInt(uint8 gpio)
 {
-  digio io;
-  
   switch(gpio)
   {
    case GPIO_3:
-    io = gpio3;
+    TRX_INT_DISABLE(GPIO_3);
     break;
    case GPIO_2:
-    io = gpio2;
-    break;
-   case GPIO_0:
-    io = gpio0;
+    TRX_INT_DISABLE(GPIO_2);
     break;
    default:
-    io = gpio0;
+    TRX_INT_DISABLE(GPIO_0);
     break;
   }
-  
-  halDigio2IntDisable(io);
   return;
 }
 
@@ -200,25 +209,15 @@ void trxDisableInt(uint8 gpio)
  */
 uint8 trxSampleSyncPin(uint8 gpio)
 {
-  digio io;
-  
   switch(gpio)
   {
    case GPIO_3:
-    io = gpio3;
-    break;
+    return (TRX_SAMPLE_PIN(GPIO_3));
    case GPIO_2:
-    io = gpio2;
-    break;
-   case GPIO_0:
-    io = gpio0;
-    break;
+    return (TRX_SAMPLE_PIN(GPIO_2));
    default:
-    io = gpio0;
-    break;
+    return (TRX_SAMPLE_PIN(GPIO_0));
   }
-  
-  return ((TRXEM_INT_PORT_IN & (0x01<<io.pin))>>io.pin);
 }
 
 
@@ -41,16 +41,120 @@
 #include "msp430.h"
 #include "hal_msp_exp430g2_spi.h"
 #include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_int.h"
+#include "hal_mcu.h"
+#include "hal_assert.h"
+#ifdef TRX_SPI_TRACE
+#include "hal_board.h"
+#endif
+
+/******************************************************************************
+* CONSTANTS
+*/
+/* Phases of the transaction currently driven by the USCIAB0RX ISR */
+#define SPI_ASYNC_PHASE_HEADER    0
+#define SPI_ASYNC_PHASE_REG_ADDR  1
+#define SPI_ASYNC_PHASE_DATA      2
+
+/* Application UART baud rate of the trace output. The launchpad's USB
+ * back channel only passes 9600 baud.
+ */
+#define SPI_TRACE_BAUDRATE        9600UL
+
+/* Smallest UCB0BR0 burst reads are pipelined at. With the next dummy byte
+ * queued, the current one must be read within the 8 * UCB0BR0 MCLK cycles
+ * the next takes to shift in. From UCB0RXIFG to the read of UCB0RXBUF
+ * takes up to about 21 cycles: a SPI_RX_WAIT() poll just missed (12), the
+ * UCOE sample (3) and the read (6). Below it, that is at 1 to 12 MHz, each
+ * byte is read before the next is sent.
+ */
+#ifndef TRX_SPI_PIPELINE_MIN_BR
+#define TRX_SPI_PIPELINE_MIN_BR   3
+#endif
+
+/******************************************************************************
+* MACROS
+*/
+/* Pull CS_N low and wait for SO to go low before communication starts. With
+ * TRX_SPI_TRACE the start time and the CHIP_RDYn wait are sampled from TA1R
+ * into the locals declared by SPI_TRACE_VARS, for SPI_TRACE() to log with
+ * the duration once the transaction is over. Without it the macros add no
+ * code.
+ */
+#ifdef TRX_SPI_TRACE
+#define SPI_TRACE_VARS            uint16 traceTime; uint16 traceWait;
+#define SPI_BEGIN_WAIT_RDY()      st( traceTime = TA1R;                       \
+                                      SPI_BEGIN();                            \
+                                      while(SPI_PORT_IN & SPI_MISO_PIN);      \
+                                      traceWait = TA1R - traceTime; )
+#define SPI_TRACE(hdr,len,status) trxSpiTraceLog((hdr), (len), (status), traceTime, traceWait, \
+                                                 TA1R - traceTime)
+#else
+#define SPI_TRACE_VARS
+#define SPI_BEGIN_WAIT_RDY()      st( SPI_BEGIN(); while(SPI_PORT_IN & SPI_MISO_PIN); )
+#define SPI_TRACE(hdr,len,status)
+#endif
 
 /******************************************************************************
 * LOCAL VARIABLES
 */
+/* UCB0BR0 per HAL_MCU_SYSCLK_xMHZ setting: the fastest SCLK not above the
+ * 6.5 MHz the CC110L accepts for burst access (SMCLK = DCO).
+ */
+static const uint8 spiPrescaler[] = {
+  1,  /*  1 MHz -> 1 MHz    */
+  1,  /*  4 MHz -> 4 MHz    */
+  2,  /*  8 MHz -> 4 MHz    */
+  2,  /* 12 MHz -> 6 MHz    */
+  3,  /* 16 MHz -> 5.33 MHz */
+  4,  /* 20 MHz -> 5 MHz    */
+  4,  /* 25 MHz -> 6.25 MHz */
+};
+
+/* Submitted transactions, head is the one on the bus when spiAsyncActive */
+static trxSpiTrans_t * volatile pSpiQueueHead;
+static trxSpiTrans_t * volatile pSpiQueueTail;
+static volatile uint8  spiAsyncActive;
+static volatile uint8  spiBusLocked;
+static uint8           spiAsyncPhase;
+static uint16          spiAsyncIndex;
 
+#ifdef TRX_SPI_TRACE
+/* UCA0BR per HAL_MCU_SYSCLK_xMHZ setting for SPI_TRACE_BAUDRATE from SMCLK */
+static const uint16 spiTraceBaudDiv[] = {
+  (uint16)(1000000UL  / SPI_TRACE_BAUDRATE),
+  (uint16)(4000000UL  / SPI_TRACE_BAUDRATE),
+  (uint16)(8000000UL  / SPI_TRACE_BAUDRATE),
+  (uint16)(12000000UL / SPI_TRACE_BAUDRATE),
+  (uint16)(16000000UL / SPI_TRACE_BAUDRATE),
+  (uint16)(20000000UL / SPI_TRACE_BAUDRATE),
+  (uint16)(25000000UL / SPI_TRACE_BAUDRATE),
+};
+
+static trxSpiTraceEntry_t spiTrace[TRX_SPI_TRACE_SIZE];
+static uint8              spiTraceHead;
+static uint8              spiTraceCount;
+static uint16             spiTraceLost;
+/* Start of the asynchronous transaction on the bus */
+static uint16             spiAsyncTraceTime;
+static uint16             spiAsyncTraceWait;
+#endif
 
 /******************************************************************************
 * STATIC FUNCTIONS
 */
 static void trxReadWriteBurstSingle(uint8 addr,uint8 *pData,uint16 len) ;
+static void trxSpiAsyncStart(void);
+static uint8 trxSpiBusLock(void);
+static void  trxSpiBusUnlock(uint8 wasLocked);
+#ifdef TRX_SPI_TRACE
+static void trxSpiTraceLog(uint8 header, uint16 len, uint8 status, uint16 timestamp, uint16 rdyWait,
+                           uint16 duration);
+static void trxSpiTraceUartInit(void);
+static void trxSpiTraceUartPutc(uint8 c);
+static void trxSpiTraceUartHex(uint16 value, uint8 digits, uint8 separator);
+#endif
 
 /******************************************************************************
  * @fn          function name
@@ -85,7 +189,7 @@ void exp430RfSpiInit(void)
   UCB0CTL1 |=  UCSSEL_3;
   //data rate:
   UCB0BR1   =  0x00;
-  UCB0BR0   =  0x01; // division factor of clock source
+  UCB0BR0   =  spiPrescaler[halMcuGetSystemClock()]; // division factor of clock source
   // 3) Configure ports
   // MISO -> P1.6
   // MOSI -> P1.7
@@ -119,6 +223,47 @@ void exp430RfSpiInit(void)
   UCB0CTL1 &= ~UCSWRST;
   // 5) Enable interrupts UCxRXIE and UCxTXIE
   
+#ifdef TRX_SPI_TRACE
+  // free running Timer_A1 on SMCLK timestamps the trace; Timer_A0 is the
+  // ACLK time base of hal_board.c, too coarse for the CHIP_RDYn wait
+  TA1CTL = TASSEL_2 + MC_2 + TACLR;
+#endif
+}
+/******************************************************************************
+ * @fn          exp430RfSpiSetClock
+ *
+ * @brief       Re-derives the SPI prescaler after the system clock changed.
+ *              Waits for a transaction on the bus to finish first. Called by
+ *              halMcuSetSystemClock().
+ *
+ * input parameters
+ *
+ * @param       systemClock - HAL_MCU_SYSCLK_xMHZ setting now in use
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void exp430RfSpiSetClock(uint8 systemClock)
+{
+  uint8 inReset;
+  uint8 wasLocked;
+
+  if(systemClock >= sizeof(spiPrescaler))
+  {
+    return;
+  }
+  wasLocked = trxSpiBusLock();
+  inReset = UCB0CTL1 & UCSWRST;
+  // bit rate registers may only be changed while the USCI is held in reset
+  UCB0CTL1 |= UCSWRST;
+  UCB0BR1   = 0x00;
+  UCB0BR0   = spiPrescaler[systemClock];
+  if(!inReset)
+  {
+    UCB0CTL1 &= ~UCSWRST;
+  }
+  trxSpiBusUnlock(wasLocked);
 }
 /******************************************************************************
  * @fn          function name
@@ -132,21 +277,73 @@ void exp430RfSpiInit(void)
 uint8 trx8BitRegAccess(uint8 accessType, uint8 addrByte, uint8 *pData, uint16 len)
 {
   uint8 readValue;
+  uint8 wasLocked;
+  SPI_TRACE_VARS
 
+  wasLocked = trxSpiBusLock();
   //Pull CS_N low and wait for SO to go low before communication starts
-  SPI_BEGIN();
-  while(SPI_PORT_IN & SPI_MISO_PIN);
+  SPI_BEGIN_WAIT_RDY();
   // send register address byte
   SPI_TX(accessType|addrByte);
   SPI_WAIT_DONE();
   // Storing chip status
   readValue = SPI_RX();
-  
+
   trxReadWriteBurstSingle(accessType|addrByte,pData,len);
   SPI_END();
+  SPI_TRACE(accessType|addrByte, len, readValue);
+  trxSpiBusUnlock(wasLocked);
   // return the status byte value */
   return(readValue);
 }
+/******************************************************************************
+ * @fn          trx8BitRegAccessSg
+ *
+ * @brief       Burst access moving the data through a list of segments in
+ *              one chip select window: a gather write sends the segments
+ *              back to back, a scatter read splits the incoming bytes across
+ *              them. Lets callers keep e.g. header, payload and trailer of a
+ *              frame in separate buffers without copying them together.
+ *              Segments of zero length are skipped.
+ *
+ * input parameters
+ *
+ * @param       accessType - RADIO_READ_ACCESS or RADIO_WRITE_ACCESS, burst
+ *                           access is implied
+ * @param       addrByte   - address of the burst, normally the FIFO
+ * @param       *pSegs     - segment list, read into or written from
+ * @param       numSegs    - number of segments
+ *
+ * output parameters
+ *
+ * @return      chip status byte
+ */
+uint8 trx8BitRegAccessSg(uint8 accessType, uint8 addrByte, const trxSpiSeg_t *pSegs, uint8 numSegs)
+{
+  uint8 readValue;
+  uint8 wasLocked;
+  uint16 total = 0;
+  SPI_TRACE_VARS
+
+  accessType |= RADIO_BURST_ACCESS;
+  wasLocked = trxSpiBusLock();
+  SPI_BEGIN_WAIT_RDY();
+  SPI_TX(accessType|addrByte);
+  SPI_WAIT_DONE();
+  readValue = SPI_RX();
+
+  while(numSegs--)
+  {
+    trxReadWriteBurstSingle(accessType|addrByte, pSegs->pData, pSegs->len);
+    total += pSegs->len;
+    pSegs++;
+  }
+  SPI_END();
+  SPI_TRACE(accessType|addrByte, total, readValue);
+  trxSpiBusUnlock(wasLocked);
+  (void)total;
+  return(readValue);
+}
 /******************************************************************************
  * @fn          trx16BitRegAccess
  *
@@ -171,9 +368,11 @@ uint8 trx8BitRegAccess(uint8 accessType, uint8 addrByte, uint8 *pData, uint16 le
 rfStatus_t trx16BitRegAccess(uint8 accessType, uint8 extAddr, uint8 regAddr, uint8 *pData, uint8 len)
 {
   uint8 readValue;
+  uint8 wasLocked;
+  SPI_TRACE_VARS
 
-  SPI_BEGIN();
-  while(SPI_PORT_IN & SPI_MISO_PIN);
+  wasLocked = trxSpiBusLock();
+  SPI_BEGIN_WAIT_RDY();
   /* send extended address byte with access type bits set */
   SPI_TX(accessType|extAddr);
   SPI_WAIT_DONE();
@@ -184,6 +383,8 @@ rfStatus_t trx16BitRegAccess(uint8 accessType, uint8 extAddr, uint8 regAddr, uin
   /* Communicate len number of bytes */
   trxReadWriteBurstSingle(accessType|extAddr,pData,len);
   SPI_END();
+  SPI_TRACE(accessType|extAddr, len, readValue);
+  trxSpiBusUnlock(wasLocked);
   /* return the status byte value */
   return(readValue);
 }
@@ -205,14 +406,480 @@ rfStatus_t trx16BitRegAccess(uint8 accessType, uint8 extAddr, uint8 regAddr, uin
 rfStatus_t trxSpiCmdStrobe(uint8 cmd)
 {
     uint8 rc;
-    SPI_BEGIN();
-    while(SPI_PORT_IN & SPI_MISO_PIN);
+    uint8 wasLocked;
+    SPI_TRACE_VARS
+    wasLocked = trxSpiBusLock();
+    SPI_BEGIN_WAIT_RDY();
     SPI_TX(cmd);
     SPI_WAIT_DONE();
     rc = SPI_RX();
     SPI_END();
+    SPI_TRACE(cmd, 0, rc);
+    trxSpiBusUnlock(wasLocked);
     return(rc);
 }
+/*******************************************************************************
+ * @fn          trxSpiSubmit
+ *
+ * @brief       Queues a radio SPI transaction and returns immediately. The
+ *              transaction is clocked out byte by byte from the USCIAB0RX
+ *              ISR, so the caller can keep working or enter LPM0 meanwhile.
+ *
+ *              The descriptor is owned by the driver until done is set and
+ *              must stay valid until then. header holds the access type and
+ *              address (or a command strobe), regAddr is the second address
+ *              byte sent when extended is set (CC112X), len data bytes are
+ *              read to or written from pData. For a command strobe use
+ *              len = 0. status receives the chip status byte.
+ *
+ *              The callback, if any, is called from ISR context when the
+ *              transaction completes. It may submit new transactions but
+ *              must not call the blocking access functions.
+ *
+ * input parameters
+ *
+ * @param       pTrans - transaction descriptor
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxSpiSubmit(trxSpiTrans_t *pTrans)
+{
+  istate_t key;
+
+  pTrans->pNext = NULL;
+  pTrans->done  = FALSE;
+  // single accesses communicate one data byte, as in trxReadWriteBurstSingle
+  if(!(pTrans->header & RADIO_BURST_ACCESS) && (pTrans->len > 1))
+  {
+    pTrans->len = 1;
+  }
+
+  HAL_INT_LOCK(key);
+  if(pSpiQueueHead == NULL)
+  {
+    pSpiQueueHead = pTrans;
+  }
+  else
+  {
+    pSpiQueueTail->pNext = pTrans;
+  }
+  pSpiQueueTail = pTrans;
+
+  if(!spiAsyncActive && !spiBusLocked)
+  {
+    trxSpiAsyncStart();
+  }
+  HAL_INT_UNLOCK(key);
+}
+/*******************************************************************************
+ * @fn          trxSpiAsyncPending
+ *
+ * @brief       Tells whether submitted transactions are still outstanding.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      TRUE if the queue is not empty
+ */
+uint8 trxSpiAsyncPending(void)
+{
+  return(pSpiQueueHead != NULL);
+}
+/*******************************************************************************
+ * @fn          trxSpiAsyncStart
+ *
+ * @brief       Selects the radio and sends the header byte of the transaction
+ *              at the head of the queue. Called with interrupts disabled.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void trxSpiAsyncStart(void)
+{
+  SPI_TRACE_VARS
+
+  spiAsyncActive = TRUE;
+  spiAsyncPhase  = SPI_ASYNC_PHASE_HEADER;
+  spiAsyncIndex  = 0;
+
+  SPI_BEGIN_WAIT_RDY();
+#ifdef TRX_SPI_TRACE
+  spiAsyncTraceTime = traceTime;
+  spiAsyncTraceWait = traceWait;
+#endif
+  SPI_TX(pSpiQueueHead->header);
+  IE2 |= UCB0RXIE;
+}
+/*******************************************************************************
+ * @fn          trxSpiBusLock
+ *
+ * @brief       Claims the SPI bus for a blocking access. Queued transactions
+ *              are held back at the next transaction boundary and the one on
+ *              the bus, if any, is allowed to finish first. Nests: a claim
+ *              made while the bus is claimed already, e.g. by
+ *              exp430RfSpiSetClock() during a clock change around an access,
+ *              leaves it claimed when released.
+ *
+ *              NOTE: Must not be reached from an ISR while an asynchronous
+ *              transaction is on the bus, as that would never complete.
+ *              A blocking access from an ISR is only allowed while the main
+ *              loop cannot be inside one: the lock keeps the asynchronous
+ *              queue off the bus, not an interrupted caller, whose
+ *              transaction would be corrupted. See cc11xL_rxqueue.h.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      TRUE if the bus was claimed already, for trxSpiBusUnlock()
+ */
+static uint8 trxSpiBusLock(void)
+{
+  uint8 wasLocked = spiBusLocked;
+
+  spiBusLocked = TRUE;
+  while(spiAsyncActive);
+  return(wasLocked);
+}
+/*******************************************************************************
+ * @fn          trxSpiBusUnlock
+ *
+ * @brief       Releases the bus after a blocking access and restarts the
+ *              asynchronous queue if transactions were held back. Leaves
+ *              the bus claimed if it was when trxSpiBusLock() was called.
+ *
+ * input parameters
+ *
+ * @param       wasLocked - return value of the matching trxSpiBusLock()
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void trxSpiBusUnlock(uint8 wasLocked)
+{
+  istate_t key;
+
+  if(wasLocked)
+  {
+    return;
+  }
+  /* A submit racing with this either starts the queue itself or is seen
+   * below, so the lock is only needed when something is waiting.
+   */
+  spiBusLocked = FALSE;
+  if(pSpiQueueHead != NULL)
+  {
+    HAL_INT_LOCK(key);
+    if(pSpiQueueHead != NULL && !spiAsyncActive && !spiBusLocked)
+    {
+      trxSpiAsyncStart();
+    }
+    HAL_INT_UNLOCK(key);
+  }
+}
+/*******************************************************************************
+ * @fn          usciAB0RxISR
+ *
+ * @brief       Advances the asynchronous transaction at the head of the queue
+ *              by one byte. Completes it, calls its callback and starts the
+ *              next one when all bytes have been communicated. Wakes the main
+ *              loop from low power mode on completion.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+#pragma vector=USCIAB0RX_VECTOR
+__interrupt void usciAB0RxISR(void)
+{
+  trxSpiTrans_t *pTrans = pSpiQueueHead;
+  uint8 rxByte;
+
+  if(!(IE2 & UCB0RXIE) || !(IFG2 & UCB0RXIFG))
+  {
+    return;
+  }
+  rxByte = SPI_RX();
+
+  switch(spiAsyncPhase)
+  {
+    case SPI_ASYNC_PHASE_HEADER:
+      pTrans->status = rxByte;
+      if(pTrans->extended)
+      {
+        spiAsyncPhase = SPI_ASYNC_PHASE_REG_ADDR;
+        SPI_TX(pTrans->regAddr);
+        return;
+      }
+      break;
+    case SPI_ASYNC_PHASE_REG_ADDR:
+      break;
+    default:
+      if(pTrans->header & RADIO_READ_ACCESS)
+      {
+        pTrans->pData[spiAsyncIndex] = rxByte;
+      }
+      spiAsyncIndex++;
+      break;
+  }
+  spiAsyncPhase = SPI_ASYNC_PHASE_DATA;
+
+  if(spiAsyncIndex < pTrans->len)
+  {
+    SPI_TX((pTrans->header & RADIO_READ_ACCESS) ? 0 : pTrans->pData[spiAsyncIndex]);
+    return;
+  }
+
+  // transaction complete
+  SPI_END();
+  IE2 &= ~UCB0RXIE;
+  pSpiQueueHead  = pTrans->pNext;
+  spiAsyncActive = FALSE;
+  pTrans->done   = TRUE;
+#ifdef TRX_SPI_TRACE
+  trxSpiTraceLog(pTrans->header, pTrans->len, pTrans->status,
+                 spiAsyncTraceTime, spiAsyncTraceWait, TA1R - spiAsyncTraceTime);
+#endif
+  if(pTrans->callback != NULL)
+  {
+    pTrans->callback(pTrans);
+  }
+  if(pSpiQueueHead != NULL && !spiAsyncActive && !spiBusLocked)
+  {
+    trxSpiAsyncStart();
+  }
+  __low_power_mode_off_on_exit();
+}
+#ifdef TRX_SPI_TRACE
+/*******************************************************************************
+ * @fn          trxSpiTraceRead
+ *
+ * @brief       Takes the oldest entry out of the transaction trace.
+ *
+ *              timestamp, rdyWait and duration are in Timer_A1 ticks,
+ *              SMCLK cycles at the system clock of the time; the timer
+ *              stops in LPM3. A long rdyWait means the radio was still
+ *              waking up from SLEEP or XOFF when the access started. The
+ *              duration of a burst gives its throughput, len * SMCLK /
+ *              duration bytes/s less the header byte; asynchronous
+ *              transactions include the ISR latency.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @param       pEntry - receives the entry
+ *
+ * @return      TRUE if an entry was returned, FALSE if the trace is empty
+ */
+uint8 trxSpiTraceRead(trxSpiTraceEntry_t *pEntry)
+{
+  istate_t key;
+  uint8    found = FALSE;
+
+  HAL_INT_LOCK(key);
+  if(spiTraceCount)
+  {
+    *pEntry = spiTrace[(uint8)(spiTraceHead - spiTraceCount) & (TRX_SPI_TRACE_SIZE - 1)];
+    spiTraceCount--;
+    found = TRUE;
+  }
+  HAL_INT_UNLOCK(key);
+  return(found);
+}
+/*******************************************************************************
+ * @fn          trxSpiTraceDrain
+ *
+ * @brief       Empties the transaction trace to the application UART (USCI_A0
+ *              TXD on P1.1) as one line of hex fields per entry:
+ *
+ *              tttt hh llll ss wwww dddd
+ *
+ *              timestamp, header, length, status, CHIP_RDYn wait and
+ *              duration. A line
+ *              "Lnnnn" first reports entries overwritten since the
+ *              previous drain. Transmission is polled, about 26 ms per entry
+ *              at 9600 baud, so call it where the radio can wait.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxSpiTraceDrain(void)
+{
+  trxSpiTraceEntry_t entry;
+  istate_t key;
+  uint16   lost;
+
+  trxSpiTraceUartInit();
+
+  HAL_INT_LOCK(key);
+  lost         = spiTraceLost;
+  spiTraceLost = 0;
+  HAL_INT_UNLOCK(key);
+  if(lost)
+  {
+    trxSpiTraceUartPutc('L');
+    trxSpiTraceUartHex(lost, 4, '\n');
+  }
+
+  while(trxSpiTraceRead(&entry))
+  {
+    trxSpiTraceUartHex(entry.timestamp, 4, ' ');
+    trxSpiTraceUartHex(entry.header, 2, ' ');
+    trxSpiTraceUartHex(entry.len, 4, ' ');
+    trxSpiTraceUartHex(entry.status, 2, ' ');
+    trxSpiTraceUartHex(entry.rdyWait, 4, ' ');
+    trxSpiTraceUartHex(entry.duration, 4, '\n');
+  }
+}
+/*******************************************************************************
+ * @fn          trxSpiTraceLog
+ *
+ * @brief       Appends a transaction to the trace, overwriting the oldest
+ *              entry when the ring is full. Called from the access functions
+ *              and the USCIAB0RX ISR.
+ *
+ * input parameters
+ *
+ * @param       header    - access type | address, or command strobe
+ * @param       len       - data bytes communicated
+ * @param       status    - chip status byte
+ * @param       timestamp - TA1R when CS_N was pulled low
+ * @param       rdyWait   - TA1R ticks spent waiting for CHIP_RDYn
+ * @param       duration  - TA1R ticks from CS_N low to CS_N high
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void trxSpiTraceLog(uint8 header, uint16 len, uint8 status, uint16 timestamp, uint16 rdyWait,
+                           uint16 duration)
+{
+  trxSpiTraceEntry_t *pEntry;
+  istate_t key;
+
+  HAL_INT_LOCK(key);
+  pEntry       = &spiTrace[spiTraceHead];
+  spiTraceHead = (spiTraceHead + 1) & (TRX_SPI_TRACE_SIZE - 1);
+  if(spiTraceCount < TRX_SPI_TRACE_SIZE)
+  {
+    spiTraceCount++;
+  }
+  else
+  {
+    spiTraceLost++;
+  }
+  pEntry->timestamp = timestamp;
+  pEntry->rdyWait   = rdyWait;
+  pEntry->duration  = duration;
+  pEntry->len       = len;
+  pEntry->header    = header;
+  pEntry->status    = status;
+  HAL_INT_UNLOCK(key);
+}
+/*******************************************************************************
+ * @fn          trxSpiTraceUartInit
+ *
+ * @brief       Sets up USCI_A0 as 8N1 UART transmitter on P1.1 at
+ *              SPI_TRACE_BAUDRATE from the current SMCLK. Done on every
+ *              drain, as the system clock may have changed meanwhile.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void trxSpiTraceUartInit(void)
+{
+  uint16 div = spiTraceBaudDiv[halMcuGetSystemClock()];
+
+  UCA0CTL1 |= UCSWRST;
+  UCA0CTL0  = 0x00;
+  UCA0CTL1 |= UCSSEL_2;
+  UCA0BR0   = (uint8)div;
+  UCA0BR1   = (uint8)(div >> 8);
+  UCA0MCTL  = 0x00;
+  P1SEL    |= TXD;
+  P1SEL2   |= TXD;
+  UCA0CTL1 &= ~UCSWRST;
+}
+/*******************************************************************************
+ * @fn          trxSpiTraceUartHex
+ *
+ * @brief       Sends a value as hex digits followed by a separator. A newline
+ *              separator is sent as CR LF.
+ *
+ * input parameters
+ *
+ * @param       value     - value to send
+ * @param       digits    - number of hex digits, from the least significant
+ * @param       separator - character sent after the digits
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void trxSpiTraceUartHex(uint16 value, uint8 digits, uint8 separator)
+{
+  uint8 nibble;
+
+  while(digits--)
+  {
+    nibble = (value >> (digits * 4)) & 0x0F;
+    trxSpiTraceUartPutc((nibble < 10) ? ('0' + nibble) : ('A' - 10 + nibble));
+  }
+  if(separator == '\n')
+  {
+    trxSpiTraceUartPutc('\r');
+  }
+  trxSpiTraceUartPutc(separator);
+}
+/*******************************************************************************
+ * @fn          trxSpiTraceUartPutc
+ *
+ * @brief       Sends one character, waiting for room in UCA0TXBUF.
+ *
+ * input parameters
+ *
+ * @param       c - character
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void trxSpiTraceUartPutc(uint8 c)
+{
+  while(!(IFG2 & UCA0TXIFG));
+  UCA0TXBUF = c;
+}
+#endif
 /*******************************************************************************
  * @fn          trxReadWriteBurstSingle
  *
@@ -226,6 +893,21 @@ rfStatus_t trxSpiCmdStrobe(uint8 cmd)
  *              mode if the burst bit is set. If the burst bit is not set, only
  *              one data byte is communicated.
  *
+ *              Burst writes are pipelined: the next byte is queued in the
+ *              double buffered UCB0TXBUF while the current one is shifted, so
+ *              SCLK runs back to back instead of idling while the CPU polls
+ *              UCB0RXIFG between bytes. They discard the bytes clocked in.
+ *
+ *              Burst reads are pipelined only with UCB0BR0 at least
+ *              TRX_SPI_PIPELINE_MIN_BR, at 16 MHz and up, and run with
+ *              interrupts locked then: about 32 cycles per byte, so GDO and
+ *              UART interrupts wait up to some 0.13 ms for a full 64 byte
+ *              FIFO at 16 MHz. At the lower clocks SCLK is too close to
+ *              MCLK to read each byte while the next shifts in; they read a
+ *              byte before sending the next, with interrupts enabled. An
+ *              overrun of UCB0RXBUF (UCOE) in a pipelined read fails
+ *              HAL_ASSERT().
+ *
  *              NOTE: This function is used in the following way:
  *
  *              SPI_BEGIN();
@@ -244,44 +926,65 @@ rfStatus_t trxSpiCmdStrobe(uint8 cmd)
  */
 static void trxReadWriteBurstSingle(uint8 addr,uint8 *pData,uint16 len)
 {
-	uint16 i;
-	/* Communicate len number of bytes: if RX - the procedure sends 0x00 to push bytes from slave*/
-  if(addr&RADIO_READ_ACCESS)
+  istate_t key;
+  uint8    rxStat;
+
+  if(!(addr&RADIO_BURST_ACCESS))
   {
-    if(addr&RADIO_BURST_ACCESS)
-    {
-      for (i = 0; i < len; i++)
-      {
-          SPI_TX(0);            /* Possible to combining read and write as one access type */
-          SPI_WAIT_DONE();
-          *pData = SPI_RX();     /* Store pData from last pData RX */
-          pData++;
-      }
-    }
-    else
+    len = 1;
+  }
+  if(len == 0)
+  {
+    return;
+  }
+  /* Communicate len number of bytes: if RX - the procedure sends 0x00 to push bytes from slave*/
+  if((addr&RADIO_READ_ACCESS) && (UCB0BR0 < TRX_SPI_PIPELINE_MIN_BR))
+  {
+    /* One byte in flight at a time, nothing to overrun */
+    do
     {
       SPI_TX(0);
       SPI_WAIT_DONE();
-      *pData = SPI_RX();
+      *pData++ = SPI_RX();
     }
+    while(--len);
   }
-  else
+  else if(addr&RADIO_READ_ACCESS)
   {
-    if(addr&RADIO_BURST_ACCESS)
+    /* Once the next dummy byte is queued the current one must be read within
+     * 8 SCLK periods, before the next lands in UCB0RXBUF and overruns it
+     * (UCOE), so no ISR may run until the last byte is read. Reading
+     * UCB0RXBUF clears UCOE, so it is sampled before each read.
+     */
+    rxStat = 0;
+    HAL_INT_LOCK(key);
+    /* First dummy byte goes straight to the shift register */
+    SPI_TX(0);
+    while(--len)
     {
-      /* Communicate len number of bytes: if TX - the procedure doesn't overwrite pData */
-      for (i = 0; i < len; i++)
-      {
-        SPI_TX(*pData);
-        SPI_WAIT_DONE();
-        pData++;
-      }
+      /* Queue the next dummy byte before collecting the current one */
+      SPI_TX_QUEUE(0);
+      SPI_RX_WAIT();
+      rxStat |= UCB0STAT;
+      *pData++ = SPI_RX();
     }
-    else
+    SPI_RX_WAIT();
+    *pData = SPI_RX();
+    HAL_INT_UNLOCK(key);
+    HAL_ASSERT(!(rxStat & UCOE));
+  }
+  else
+  {
+    /* Communicate len number of bytes: if TX - the procedure doesn't overwrite pData */
+    do
     {
-      SPI_TX(*pData);
-      SPI_WAIT_DONE();
+      SPI_TX_QUEUE(*pData++);
     }
+    while(--len);
+    /* Last byte must have left the shift register before CS_N is released */
+    SPI_WAIT_IDLE();
+    /* Discard the bytes clocked in during the write (clears RXIFG and UCOE) */
+    (void)SPI_RX();
   }
   return;
 }
@@ -74,6 +74,15 @@ extern "C" {
 #define STATUS_CHIP_RDYn_BM             0x80
 #define STATUS_STATE_BM                 0x70
 #define STATUS_FIFO_BYTES_AVAILABLE_BM  0x0F  
+
+/* Transaction trace, compiled in by defining TRX_SPI_TRACE. Entries in the
+ * RAM ring, a power of two; the oldest entry is overwritten when full.
+ */
+#ifdef TRX_SPI_TRACE
+#ifndef TRX_SPI_TRACE_SIZE
+#define TRX_SPI_TRACE_SIZE              8
+#endif
+#endif
   
 /******************************************************************************
  * MACROS
@@ -84,6 +93,14 @@ extern "C" {
 #define     SPI_RX()              UCB0RXBUF
 #define     SPI_END()             st(  CS_N_PORT_OUT |= CS_N_PIN; )//NOP();
 
+/* Pipelined access: UCB0TXBUF is double buffered, so the next byte can be
+ * queued as soon as UCB0TXIFG signals that the previous one has moved to the
+ * shift register. RXIFG is cleared by reading UCB0RXBUF, not by the writer.
+ */
+#define     SPI_TX_QUEUE(x)       st( while(!(IFG2 & UCB0TXIFG)); UCB0TXBUF = (x); )
+#define     SPI_RX_WAIT()         st( while(!(IFG2 & UCB0RXIFG)); )
+#define     SPI_WAIT_IDLE()       st( while(UCB0STAT & UCBUSY); )
+
 /******************************************************************************
  * TYPEDEFS
  */
@@ -95,16 +112,61 @@ typedef struct
 }registerSetting_t;
 
 typedef uint8 rfStatus_t;
+
+/* Descriptor for an asynchronous transaction, see trxSpiSubmit() */
+typedef struct trxSpiTrans
+{
+  struct trxSpiTrans  *pNext;
+  void               (*callback)(struct trxSpiTrans *pTrans);
+  uint8               *pData;
+  uint16               len;
+  uint8                header;    /* access type | address, or command strobe */
+  uint8                regAddr;   /* extended address space only */
+  uint8                extended;
+  rfStatus_t           status;
+  volatile uint8       done;
+}trxSpiTrans_t;
+
+/* One segment of a gather write or scatter read, see trx8BitRegAccessSg() */
+typedef struct
+{
+  uint8   *pData;
+  uint16   len;
+}trxSpiSeg_t;
+
+#ifdef TRX_SPI_TRACE
+/* One traced transaction, see trxSpiTraceRead() */
+typedef struct
+{
+  uint16      timestamp;  /* TA1R when CS_N was pulled low */
+  uint16      rdyWait;    /* TA1R ticks until CHIP_RDYn went low */
+  uint16      duration;   /* TA1R ticks from CS_N low to CS_N high */
+  uint16      len;        /* data bytes communicated */
+  uint8       header;     /* access type | address, or command strobe */
+  rfStatus_t  status;     /* chip status byte */
+}trxSpiTraceEntry_t;
+#endif
 /******************************************************************************
  * PROTOTYPES
  */
 void exp430RfSpiInit(void);
+void exp430RfSpiSetClock(uint8 systemClock);
 
 uint8 trx8BitRegAccess(uint8 accessType, uint8 addrByte, uint8 *pData, uint16 len);
+uint8 trx8BitRegAccessSg(uint8 accessType, uint8 addrByte, const trxSpiSeg_t *pSegs, uint8 numSegs);
 /* CC112X specific prototype function */
 rfStatus_t trx16BitRegAccess(uint8 accessType, uint8 extAddr, uint8 regAddr, uint8 *pData, uint8 len);
 rfStatus_t trxSpiCmdStrobe(uint8 cmd);
 
+/* Non-blocking access, completed from the USCIAB0RX ISR */
+void  trxSpiSubmit(trxSpiTrans_t *pTrans);
+uint8 trxSpiAsyncPending(void);
+
+#ifdef TRX_SPI_TRACE
+uint8 trxSpiTraceRead(trxSpiTraceEntry_t *pEntry);
+void  trxSpiTraceDrain(void);
+#endif
+
 #ifdef  __cplusplus
 }
 #endif
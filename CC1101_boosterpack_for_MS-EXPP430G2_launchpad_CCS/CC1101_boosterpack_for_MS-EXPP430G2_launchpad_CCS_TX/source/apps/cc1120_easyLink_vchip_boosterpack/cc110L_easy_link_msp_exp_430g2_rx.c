@@ -14,6 +14,19 @@
 #include "msp430.h"
 #include "hal_board.h"
 #include "cc11xL_spi.h"
+#include "cc11xL_config.h"
+#include "cc11xL_stream.h"
+#include "cc11xL_radio.h"
+#include "cc11xL_profile.h"
+#include "cc11xL_rate.h"
+#include "cc11xL_packet.h"
+#include "cc11xL_stats.h"
+#include "cc11xL_txpower.h"
+#include "cc11xL_filter.h"
+#include "cc11xL_rxqueue.h"
+#include "cc11xL_pool.h"
+#include "hal_mcu.h"
+#include "hal_sched.h"
 #include "hal_int_rf_msp_exp430g2.h"
 #include "cc11xL_easy_link_msp_exp_430g2_reg_config.h"
 #include "stdlib.h"
@@ -24,22 +37,166 @@
 /******************************************************************************
 * DEFINES
 */
-#define ISR_ACTION_REQUIRED 1
-#define ISR_IDLE            0
+/* Tasks, by priority, see hal_sched.c */
+#define TASK_RADIO          0
+#define TASK_BUTTON         1
+#define NUM_TASKS           2
+
+/* Radio task events */
+#define EVENT_RADIO         0x0001  /* GDO0 edge, radioRxTxISR() */
+#define EVENT_RATE_REVERT   0x0002  /* RATE_REVERT_MS after a rate change */
+
+/* Button task events */
+#define EVENT_BUTTON        0x0001
+
+/* rxRead() result besides the CC11XL_STREAM_x values: a frame the radio
+ * dropped for its CRC
+ */
+#define RX_FLUSHED          3
 
 #define PKTLEN              30
+
+#ifdef EASY_LINK_RX_STREAM
+/* Frames are streamed out of the RX FIFO as they arrive, see
+ * cc11xL_stream.c, so they may be longer than the FIFO. It takes some 18
+ *  SPI accesses per frame, against 5 for a frame read whole at its end, so
+ * build with it only to receive frames that do not fit the FIFO.
+ */
+/* Longest length byte accepted */
+#define RX_MAX_LEN          255
+
+/* Bytes read per RX FIFO access by rxDrain() */
+#define RX_CHUNK            16
+#endif
+
+/* Data rate profile, index into dataRateProfiles[]. Build both ends of the
+ * link with the same profile.
+ */
+#ifndef EASY_LINK_PROFILE
+#define EASY_LINK_PROFILE   0
+#endif
+
+#if defined(EASY_LINK_RATE_ADAPT) || defined(EASY_LINK_TX_POWER)
+#define EASY_LINK_LISTEN
+#endif
+
+#ifdef EASY_LINK_ADDR
+/* Hardware address filtering, see cc11xL_filter.c. EASY_LINK_ADDR is the
+ * address of this node, build the TX side with the same value. Frames are
+ * read whole once the radio has passed address and CRC, so frames for
+ * other nodes and corrupt frames do not wake the MCU.
+ */
+#ifndef EASY_LINK_ADR_CHK
+#define EASY_LINK_ADR_CHK   CC11XL_ADR_CHK_ADDR_BCAST
+#endif
+/* Payload offset of the packet counter, after the address byte */
+#define RX_COUNTER_OFFSET   1
+#else
+#define RX_COUNTER_OFFSET   0
+#endif
+
+#ifdef EASY_LINK_RX_QUEUE
+/* Frames are read by the GDO0 interrupt into a queue, see cc11xL_rxqueue.c,
+ * and taken by the main loop in batches, so frames arriving while it is
+ * busy are not lost. Needs hardware filtering; on its own only the CRC is
+ * checked.
+ */
+#define EASY_LINK_FILTER
+#endif
+
+#if defined(EASY_LINK_ADDR) || defined(EASY_LINK_CRC_FLUSH)
+#define EASY_LINK_FILTER
+#endif
+
+#if defined(EASY_LINK_FILTER) && defined(EASY_LINK_RX_STREAM)
+#error "EASY_LINK_RX_STREAM does not go with hardware filtering or the RX queue"
+#endif
+
+#if defined(EASY_LINK_CRC_FLUSH) || !defined(EASY_LINK_FILTER)
+/* The end of every frame signalled. With CRC autoflush the frames the
+ * radio flushed are counted in the link statistics without being read. On
+ * its own no address is checked; with EASY_LINK_ADDR frames for other
+ * nodes are counted as flushed too. Without filtering, frames with a bad
+ * CRC are read and counted, and only frames longer than a pool block are
+ * dropped by the radio.
+ */
+#define RX_FILTER_WAKE      CC11XL_FILTER_WAKE_END
+#else
+#define RX_FILTER_WAKE      CC11XL_FILTER_WAKE_GOOD
+#endif
+
+#ifdef EASY_LINK_LISTEN
+/* The TX side listens after each packet whose counter is a multiple of
+ * LINK_SLOT_PERIOD, and one frame may be sent to it right after such a
+ * packet: a rate control, or else a TX power report.
+ */
+#define LINK_SLOT_PERIOD    16
+#endif
+
+#ifdef EASY_LINK_RATE_ADAPT
+/* Adaptive data rate, see cc11xL_rate.c. Without a packet for
+ * RATE_REVERT_MS after a change, the peer is taken to have missed it and
+ * the previous profile is used again.
+ */
+#define RATE_REVERT_MS      1000
+#endif
 /******************************************************************************
 * LOCAL VARIABLES
 */
-static uint8  packetSemaphore;
 static uint32 packetCounter;
+static uint16 rxPacketNumber;   /* packet counter of the frame being received */
+static uint16 lastPacketNumber; /* packet counter of the last good frame */
+static uint32 packetsMissed;    /* gaps in the packet counter, for the PER */
+static cc11xLStats_t linkStats; /* RSSI, LQI, CRC failures and packet rate */
+#ifdef EASY_LINK_RX_QUEUE
+static uint8  rxStopped;        /* a reply took the radio from the queue */
+#endif
+#ifdef EASY_LINK_RATE_ADAPT
+static uint8  ratePending = CC11XL_RATE_NO_CHANGE;
+static uint8  ratePrevious;     /* profile before the last change */
+static uint8  rateReverting;    /* TRUE until a packet arrives after a change */
+static uint16 rateBadSinceGood; /* bad CRC frames since the last good one */
+#endif
+#ifdef EASY_LINK_TX_POWER
+static int16  powerRssiSum;     /* good frames since the last report */
+static uint8  powerReceived;
+#endif
 
 /******************************************************************************
 * STATIC FUNCTIONS
 */
 static void registerConfig(void);
 static void runRX(void);
+static void radioTask(uint16 events);
+static void buttonTask(uint16 events);
 static void radioRxTxISR(void);
+static void rxStart(void);
+static void rxPacket(const cc11xLPacket_t *pPacket);
+#ifdef EASY_LINK_RX_QUEUE
+static void rxBatch(void);
+#else
+static uint8 rxRead(cc11xLPacket_t *pPacket);
+#endif
+#ifdef EASY_LINK_RX_STREAM
+static void rxDrain(uint8 length, uint8 offset, uint8 count);
+#endif
+#ifdef EASY_LINK_LISTEN
+static void  linkReply(const uint8 *pFrame, uint8 len);
+#endif
+#ifdef EASY_LINK_RATE_ADAPT
+static uint8 rateAdapt(const cc11xLPacket_t *pPacket, uint16 gap);
+static void  rateControl(uint8 profile);
+#endif
+#ifdef EASY_LINK_TX_POWER
+static void  powerReport(const cc11xLPacket_t *pPacket, uint8 slotUsed);
+#endif
+
+/* Task table, index TASK_x */
+static const halSchedTask_t tasks[NUM_TASKS] =
+{
+  radioTask,
+  buttonTask
+};
 /******************************************************************************
  * @fn          main
  *
@@ -59,10 +216,18 @@ void main(void)
   //init button
   halButtonInit();
   halButtonInterruptEnable();
+  // millisecond time base for the link statistics
+  halMcuTimeInit();
   // init spi
   exp430RfSpiInit();
   // write radio registers
   registerConfig();
+#ifdef TRX_SPI_TRACE
+  // report the time of 64 byte FIFO bursts on the application UART
+  cc11xLRadioIdle();
+  cc11xLSpiTraceBench();
+  trxSpiTraceDrain();
+#endif
 
   // run either TX or RX dependent of build define  
   runRX();
@@ -71,8 +236,9 @@ void main(void)
 /******************************************************************************
  * @fn          runRX
  *
- * @brief       puts radio in RX and waits for packets. Update packet counter
- *              and display for each packet received.
+ * @brief       puts radio in RX and hands the main loop to the tasks: the
+ *              radio task takes the packets, the button task starts the
+ *              link statistics over.
  *                
  * @param       none
  *
@@ -80,64 +246,138 @@ void main(void)
  */
 static void runRX(void)
 {
-  uint8 rxBuffer[64] = {0};
-  uint8 rxBytes;
-  uint8 rxBytesVerify;
+  halSchedInit(tasks, NUM_TASKS);
+  halButtonSetTask(TASK_BUTTON, EVENT_BUTTON);
   
    P2SEL &= ~0x40; // P2SEL bit 6 (GDO0) set to one as default. Set to zero (I/O)
   // connect ISR function to GPIO0, interrupt on falling edge
   trxIsrConnect(GPIO_0, FALLING_EDGE, &radioRxTxISR);
   
   // enable interrupt from GPIO_0
-  trxEnableInt(GPIO_0);
+  TRX_INT_ENABLE(GPIO_0);
      
     
-  // set radio in RX
-  trxSpiCmdStrobe(CC110L_SRX);
+  // set radio in RX and keep it there after each packet, no SRX strobe
+  // and calibration per packet. GDO0 signals the end of the packet, and
+  // rxRead() takes the frame whole; with hardware filtering only the end
+  // of a good frame, and with the queue the interrupt reads that frame
+  // itself. Streamed, GDO0 signals the RX FIFO threshold before the end,
+  // each falling edge lets rxRead() take what has arrived
+  cc11xLRadioSetMode(CC11XL_RADIO_MODE_RX_CONT);
+  rxStart();
 
   // reset packet counter
   packetCounter = 0;
+  cc11xLStatsReset(&linkStats, halMcuGetTimeMs());
   
-  // infinite loop
-  while(1)
+  // sleep until a task is posted, run it, and so on for ever
+  halSchedRun();
+}
+/******************************************************************************
+ * @fn          radioTask
+ *
+ * @brief       Highest priority task: takes the packets on each GDO0 edge,
+ *              and takes a rate change back when no packet came after it.
+ *
+ * @param       events - EVENT_RADIO and EVENT_RATE_REVERT
+ *
+ * @return      none
+ */
+static void radioTask(uint16 events)
+{
+#ifndef EASY_LINK_RX_QUEUE
+  // length, RSSI, LQI and CRC result of each frame
+  cc11xLPacket_t packet;
+  uint8  streamStatus;
+#endif
+
+#ifdef EASY_LINK_RATE_ADAPT
+  if((events & EVENT_RATE_REVERT) && rateReverting)
   {
-    // wait for packet received interrupt 
-    if(packetSemaphore == ISR_ACTION_REQUIRED)
-    {
-        cc11xLSpiReadReg(CC110L_RXBYTES,&rxBytesVerify,1);
-        
-        do
-        {
-          rxBytes = rxBytesVerify;
-          cc11xLSpiReadReg(CC110L_RXBYTES,&rxBytesVerify,1);
-        }
-        while(rxBytes != rxBytesVerify);
-        
-        cc11xLSpiReadRxFifo(rxBuffer,(rxBytes));
-        
-        // check CRC ok (CRC_OK: bit7 in second status byte)
-        if(rxBuffer[rxBytes-1] & 0x80)
-        {
-          // toggle led
-           halLedToggle(LED1);
-          // update packet counter
-          packetCounter++;
-        }
-      
-      // reset packet semaphore
-      packetSemaphore = ISR_IDLE;
-      
-      // set radio back in RX
-      trxSpiCmdStrobe(CC110L_SRX);
-      
-    }
-  } 
+    // nothing heard since the change: the peer may have missed it
+    rateReverting = FALSE;
+#ifdef EASY_LINK_RX_QUEUE
+    cc11xLRxQueueStop();
+#endif
+    cc11xLRateApply(ratePrevious);
+    cc11xLSpiCmdStrobe(CC110L_SFRX);
+    rxStart();
+  }
+#endif
+  if(!(events & EVENT_RADIO))
+  {
+    return;
+  }
+
+#ifdef EASY_LINK_RX_QUEUE
+  // take the frames the interrupt has queued, oldest first; a reply in
+  // the batch drops the posts of frames queued meanwhile, run again for
+  // those
+  rxBatch();
+  if(cc11xLRxQueueCount())
+  {
+    halSchedPost(TASK_RADIO, EVENT_RADIO);
+  }
+#else
+  // RX FIFO threshold or end of packet
+  streamStatus = rxRead(&packet);
+  if(streamStatus == CC11XL_STREAM_BUSY)
+  {
+    return;
+  }
+
+  if(streamStatus == CC11XL_STREAM_DONE)
+  {
+    rxPacket(&packet);
+  }
+  else if(streamStatus == RX_FLUSHED)
+  {
+    // dropped by the radio, counted without reading it; the gap in the
+    // packet counter shows it to the rate control
+    cc11xLStatsAddFlushed(&linkStats, halMcuGetTimeMs());
+  }
+  else
+  {
+    // discard whatever is left in the FIFO
+    cc11xLRadioIdle();
+    cc11xLSpiCmdStrobe(CC110L_SFRX);
+  }
+  
+  // an end of packet edge may have been latched while the frame was
+  // read; get ready for the next packet, the radio is still in RX
+  // unless it had to be flushed
+  halSchedClear(TASK_RADIO, EVENT_RADIO);
+  rxStart();
+
+#ifdef TRX_SPI_TRACE
+  // report the radio accesses of this packet on the application UART
+  trxSpiTraceDrain();
+#endif
+#endif
+}
+/******************************************************************************
+ * @fn          buttonTask
+ *
+ * @brief       Starts the link statistics and the packet error count over
+ *              on a button push. Runs between packets.
+ *
+ * @param       events - EVENT_BUTTON
+ *
+ * @return      none
+ */
+static void buttonTask(uint16 events)
+{
+  (void)events;
+  packetCounter = 0;
+  packetsMissed = 0;
+  cc11xLStatsReset(&linkStats, halMcuGetTimeMs());
 }
 /*******************************************************************************
 * @fn          radioRxTxISR
 *
-* @brief       ISR for packet handling in RX. Sets packet semaphore, puts radio
-*              in idle state and clears isr flag.
+* @brief       ISR for packet handling in RX. Posts to the radio task, with
+*              the frame read into the RX queue first if it runs, and clears
+*              isr flag.
 *
 * @param       none
 *
@@ -145,11 +385,375 @@ static void runRX(void)
 */
 static void radioRxTxISR(void) {
 
-  // set packet semaphore
-  packetSemaphore = ISR_ACTION_REQUIRED;
+#ifdef EASY_LINK_RX_QUEUE
+  // a received frame goes into the queue; the main loop takes it from
+  // there, and other edges, the end of a reply sent, itself
+  cc11xLRxQueueFill();
+#endif
+  halSchedPost(TASK_RADIO, EVENT_RADIO);
   // clear isr flag
-  trxClearIntFlag(GPIO_0);
+  TRX_INT_CLEAR(GPIO_0);
+  // let the main loop run
+  HAL_DIGIO2_WAKE_ON_EXIT();
+}
+
+/*******************************************************************************
+* @fn          rxStart
+*
+* @brief       Gets ready for the next packet: read whole once it has ended,
+*              with hardware filtering once the radio has checked it, by the
+*              main loop or into the queue; or streamed out of the RX FIFO
+*              as it arrives.
+*
+* @param       none
+*
+* @return      none
+*/
+static void rxStart(void)
+{
+#if defined(EASY_LINK_RX_QUEUE)
+  rxStopped = FALSE;
+  cc11xLRxQueueStart(CC110L_IOCFG0, RX_FILTER_WAKE);
+#elif defined(EASY_LINK_RX_STREAM)
+  cc11xLStreamRxStart(CC110L_IOCFG0, RX_MAX_LEN, &rxDrain);
+#else
+  cc11xLFilterRxStart(CC110L_IOCFG0, RX_FILTER_WAKE, CC11XL_POOL_MAX_LEN);
+#endif
+}
+
+/*******************************************************************************
+* @fn          rxPacket
+*
+* @brief       Handles a complete frame: link statistics, packet counter and
+*              LED for a good one, then the rate control and TX power
+*              report, which may reply to the TX side.
+*
+* @param       pPacket - length and link quality of the frame
+*
+* @return      none
+*/
+static void rxPacket(const cc11xLPacket_t *pPacket)
+{
+  uint16 gap = 0;
+
+  // check CRC ok and keep the link quality
+  cc11xLStatsAdd(&linkStats, pPacket, halMcuGetTimeMs());
+  if(pPacket->crcOk)
+  {
+    // toggle led
+    P1OUT ^= 0x01;
+    // count the packets missed since the last good one
+    if(packetCounter && (rxPacketNumber != lastPacketNumber))
+    {
+      gap = (uint16)(rxPacketNumber - lastPacketNumber - 1);
+      packetsMissed += gap;
+    }
+    lastPacketNumber = rxPacketNumber;
+    // update packet counter
+    packetCounter++;
+  }
+#if defined(EASY_LINK_RATE_ADAPT) && defined(EASY_LINK_TX_POWER)
+  powerReport(pPacket, rateAdapt(pPacket, gap));
+#elif defined(EASY_LINK_RATE_ADAPT)
+  rateAdapt(pPacket, gap);
+#elif defined(EASY_LINK_TX_POWER)
+  powerReport(pPacket, FALSE);
+#else
+  (void)gap;
+#endif
+}
+
+#ifdef EASY_LINK_RX_QUEUE
+/*******************************************************************************
+* @fn          rxBatch
+*
+* @brief       Takes the entries queued so far, oldest first; the interrupt
+*              goes on filling the queue meanwhile. The frame of each is in
+*              a pool block, given back once the packet counter is taken. A
+*              reply sent after one of them stops the queue, it is started
+*              again once the batch is done.
+*
+* @param       none
+*
+* @return      none
+*/
+static void rxBatch(void)
+{
+  const cc11xLRxQueueEntry_t *pEntry;
+  uint8 n = cc11xLRxQueueCount();
+
+  while(n--)
+  {
+    pEntry = cc11xLRxQueuePeek();
+    if(pEntry->status == CC11XL_FILTER_FLUSHED)
+    {
+      // dropped by the radio, see runRX()
+      cc11xLStatsAddFlushed(&linkStats, halMcuGetTimeMs());
+    }
+    else if(pEntry->packet.length >= RX_COUNTER_OFFSET + 2)
+    {
+      rxPacketNumber = ((uint16)pEntry->packet.pPayload[RX_COUNTER_OFFSET] << 8)
+                       | pEntry->packet.pPayload[RX_COUNTER_OFFSET + 1];
+      rxPacket(&pEntry->packet);
+    }
+    cc11xLPoolFree(pEntry->buf);
+    cc11xLRxQueueRelease();
+  }
+  if(rxStopped)
+  {
+    halSchedClear(TASK_RADIO, EVENT_RADIO);
+    rxStart();
+  }
+
+#ifdef TRX_SPI_TRACE
+  // report the radio accesses of the batch on the application UART
+  trxSpiTraceDrain();
+#endif
+}
+#else
+/*******************************************************************************
+* @fn          rxRead
+*
+* @brief       Takes what has arrived of a packet on a GDO0 edge. A frame
+*              read whole must hold the address byte, if any, and the
+*              packet counter. It is read into a pool block, given back
+*              once the counter is taken: nothing else of the payload is
+*              used, so pPacket->pPayload is not to be followed.
+*
+* @param       pPacket - gets the length and link quality of a complete
+*                        frame
+*
+* @return      CC11XL_STREAM_BUSY, CC11XL_STREAM_DONE, CC11XL_STREAM_ERROR
+*              or RX_FLUSHED
+*/
+static uint8 rxRead(cc11xLPacket_t *pPacket)
+{
+#ifndef EASY_LINK_RX_STREAM
+  cc11xLBuf_t buf = cc11xLPoolAlloc();
+  uint8 filterStatus;
+
+  if(buf == CC11XL_POOL_NONE)
+  {
+    return (CC11XL_STREAM_ERROR);
+  }
+  filterStatus = cc11xLFilterRxRead(cc11xLPoolData(buf), pPacket);
+  if((filterStatus == CC11XL_FILTER_FRAME) && (pPacket->length >= RX_COUNTER_OFFSET + 2))
+  {
+    rxPacketNumber = ((uint16)pPacket->pPayload[RX_COUNTER_OFFSET] << 8)
+                     | pPacket->pPayload[RX_COUNTER_OFFSET + 1];
+  }
+  cc11xLPoolFree(buf);
+
+  if(filterStatus == CC11XL_FILTER_FLUSHED)
+  {
+    return (RX_FLUSHED);
+  }
+  if((filterStatus != CC11XL_FILTER_FRAME) || (pPacket->length < RX_COUNTER_OFFSET + 2))
+  {
+    return (CC11XL_STREAM_ERROR);
+  }
+  return (CC11XL_STREAM_DONE);
+#else
+  uint8 streamStatus = cc11xLStreamRxDrain();
+
+  if(streamStatus == CC11XL_STREAM_DONE)
+  {
+    cc11xLStreamRxGetPacket(pPacket);
+  }
+  return (streamStatus);
+#endif
+}
+#endif
+
+#ifdef EASY_LINK_RX_STREAM
+/*******************************************************************************
+* @fn          rxDrain
+*
+* @brief       Stream drain function, called as the payload arrives. The
+*              packet counter in the first two payload bytes is taken as
+*              soon as it is in, while the rest of the frame is still on air.
+*              The remaining bytes are read in chunks of up to RX_CHUNK
+*              bytes and dropped, so RAM use does not grow with the frame.
+*
+* @param       length - length byte of the frame
+* @param       offset - payload offset of the first byte to read
+* @param       count  - number of bytes to read
+*
+* @return      none
+*/
+static void rxDrain(uint8 length, uint8 offset, uint8 count)
+{
+  uint8 chunk[RX_CHUNK];
+  uint8 n;
+  uint8 i;
+
+  (void)length;
+  while(count)
+  {
+    n = (count > RX_CHUNK) ? RX_CHUNK : count;
+    cc11xLSpiReadRxFifo(chunk, n);
+    for(i = 0; (i < n) && (offset + i < 2); i++)
+    {
+      // MSB then LSB of the packet counter
+      rxPacketNumber = (rxPacketNumber << 8) | chunk[i];
+    }
+    offset += n;
+    count  -= n;
+  }
+}
+#endif
+
+#ifdef EASY_LINK_LISTEN
+/*******************************************************************************
+* @fn          linkReply
+*
+* @brief       Sends a short frame to the TX side while it listens after a
+*              packet. The radio is left in IDLE, the caller starts RX
+*              again.
+*
+* @param       pFrame - frame, starting with the length byte
+* @param       len    - number of bytes in pFrame
+*
+* @return      none
+*/
+static void linkReply(const uint8 *pFrame, uint8 len)
+{
+  // GDO0 back to sync word / end of packet, and out of RX to send
+#if defined(EASY_LINK_RX_QUEUE)
+  cc11xLRxQueueStop();
+  rxStopped = TRUE;
+#elif defined(EASY_LINK_RX_STREAM)
+  cc11xLStreamRxEnd();
+#else
+  cc11xLFilterRxEnd();
+#endif
+  cc11xLRadioIdle();
+  cc11xLSpiWriteTxFifo((uint8 *)pFrame, len);
+  halSchedClear(TASK_RADIO, EVENT_RADIO);
+  cc11xLRadioTx();
+  halSchedWait(TASK_RADIO, EVENT_RADIO);
+  cc11xLRadioPacketEnd();
 }
+#endif
+
+#ifdef EASY_LINK_RATE_ADAPT
+/*******************************************************************************
+* @fn          rateAdapt
+*
+* @brief       Feeds a received frame to the rate control. A change it asks
+*              for is kept until the next packet after which the TX side
+*              listens, and then sent.
+*
+* @param       pPacket - the frame
+* @param       gap     - packets missed before this one, from the counter
+*
+* @return      TRUE if a control frame was sent after this packet
+*/
+static uint8 rateAdapt(const cc11xLPacket_t *pPacket, uint16 gap)
+{
+  uint8  profile;
+  uint16 number;
+
+  if(!pPacket->crcOk)
+  {
+    // the counter in a bad frame cannot be trusted, assume one packet on
+    // from the last good one for each bad frame since
+    rateBadSinceGood++;
+    number  = lastPacketNumber + rateBadSinceGood;
+    profile = cc11xLRateUpdate(pPacket);
+  }
+  else
+  {
+    // bad CRC frames are in the gap as well, they were counted already
+    gap = (gap > rateBadSinceGood) ? gap - rateBadSinceGood : 0;
+    rateBadSinceGood = 0;
+    rateReverting    = FALSE;
+    halSchedTimerStop(TASK_RADIO);
+    number  = rxPacketNumber;
+    profile = cc11xLRateMissed(gap);
+    if(profile == CC11XL_RATE_NO_CHANGE)
+    {
+      profile = cc11xLRateUpdate(pPacket);
+    }
+  }
+  if(profile != CC11XL_RATE_NO_CHANGE)
+  {
+    ratePending = profile;
+  }
+
+  // a step down is sent after a bad frame too, the link may give no more
+  // good ones at this rate
+  if((ratePending != CC11XL_RATE_NO_CHANGE)
+     && (pPacket->crcOk || (ratePending < cc11xLRateGetProfile()))
+     && ((number % LINK_SLOT_PERIOD) == 0))
+  {
+    rateControl(ratePending);
+    ratePending = CC11XL_RATE_NO_CHANGE;
+    return (TRUE);
+  }
+  return (FALSE);
+}
+
+/*******************************************************************************
+* @fn          rateControl
+*
+* @brief       Sends a rate control frame at the current rate, then changes
+*              to the new profile. The radio is left in IDLE, the caller
+*              starts RX again.
+*
+* @param       profile - index into dataRateProfiles[]
+*
+* @return      none
+*/
+static void rateControl(uint8 profile)
+{
+  uint8 frame[CC11XL_RATE_CTRL_LEN + 1];
+
+  linkReply(frame, cc11xLRateBuildControl(frame, profile));
+
+  ratePrevious  = cc11xLRateGetProfile();
+  rateReverting = TRUE;
+  halSchedTimerStart(TASK_RADIO, EVENT_RATE_REVERT, RATE_REVERT_MS);
+  cc11xLRateApply(profile);
+}
+#endif
+
+#ifdef EASY_LINK_TX_POWER
+/*******************************************************************************
+* @fn          powerReport
+*
+* @brief       Collects the RSSI of good frames, and reports the mean and
+*              their number to the TX side after each packet it listens
+*              after, unless the slot was taken by a rate control.
+*
+* @param       pPacket  - the frame
+* @param       slotUsed - TRUE if a frame was sent after this packet already
+*
+* @return      none
+*/
+static void powerReport(const cc11xLPacket_t *pPacket, uint8 slotUsed)
+{
+  uint8 frame[CC11XL_TXPOWER_FB_LEN + 1];
+
+  if(!pPacket->crcOk)
+  {
+    return;
+  }
+  if(powerReceived < 0xFF)
+  {
+    powerRssiSum += pPacket->rssiDbm;
+    powerReceived++;
+  }
+  if(slotUsed || (rxPacketNumber % LINK_SLOT_PERIOD))
+  {
+    return;
+  }
+  linkReply(frame, cc11xLTxPowerBuildFeedback(frame, (int8)(powerRssiSum / powerReceived),
+                                              powerReceived));
+  powerRssiSum  = 0;
+  powerReceived = 0;
+}
+#endif
 
 /*******************************************************************************
 * @fn          registerConfig
@@ -161,15 +765,22 @@ static void radioRxTxISR(void) {
 * @return      none
 */
 static void registerConfig(void) {
-  uint8 writeByte;
-  uint16 i;
   // reset radio
-  trxSpiCmdStrobe(CC110L_SRES);
-  // write registers to radio
-  for(i = 0; i < (sizeof  preferredSettings/sizeof(registerSetting_t)); i++) {
-    writeByte =  preferredSettings[i].data;
-    cc11xLSpiWriteReg( preferredSettings[i].addr, &writeByte, 1);
-  }
+  cc11xLConfigReset();
+  // write registers to radio, one burst per run of consecutive addresses
+  cc11xLConfigLoad(preferredSettings, sizeof(preferredSettings)/sizeof(registerSetting_t));
+  // switch the modem to the data rate profile of the build
+  cc11xLProfileSelect(&dataRateProfiles[EASY_LINK_PROFILE]);
+#ifdef EASY_LINK_RATE_ADAPT
+  cc11xLRateInit(dataRateProfiles, NUM_DATA_RATE_PROFILES, EASY_LINK_PROFILE);
+#endif
+#if defined(EASY_LINK_ADDR)
+  // drop frames for other nodes and corrupt frames in the radio
+  cc11xLFilterSet(EASY_LINK_ADDR, EASY_LINK_ADR_CHK);
+#elif defined(EASY_LINK_FILTER)
+  // drop corrupt frames in the radio
+  cc11xLFilterSet(0, CC11XL_ADR_CHK_NONE);
+#endif
 }
 /***********************************************************************************
   Copyright 2012 Texas Instruments Incorporated. All rights reserved.
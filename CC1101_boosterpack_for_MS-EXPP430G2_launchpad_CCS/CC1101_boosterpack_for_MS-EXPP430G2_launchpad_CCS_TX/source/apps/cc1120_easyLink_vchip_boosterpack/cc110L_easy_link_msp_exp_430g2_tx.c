@@ -14,6 +14,16 @@
 #include "msp430.h"
 #include "hal_board.h"
 #include "cc11xL_spi.h"
+#include "cc11xL_config.h"
+#include "cc11xL_stream.h"
+#include "cc11xL_radio.h"
+#include "cc11xL_profile.h"
+#include "cc11xL_rate.h"
+#include "cc11xL_txpower.h"
+#include "cc11xL_lbt.h"
+#include "cc11xL_filter.h"
+#include "hal_mcu.h"
+#include "hal_sched.h"
 #include "hal_int_rf_msp_exp430g2.h"
 #include "cc11xL_easy_link_msp_exp_430g2_reg_config.h"
 #include "stdlib.h"
@@ -24,23 +34,126 @@
 /******************************************************************************
 * DEFINES
 */
-#define ISR_ACTION_REQUIRED 1
-#define ISR_IDLE            0
+/* Tasks, by priority, see hal_sched.c */
+#define TASK_RADIO          0
+#define TASK_SEND           1
+#define TASK_BUTTON         2
+#define NUM_TASKS           3
 
+/* Task events */
+#define EVENT_RADIO         0x0001  /* radio task: GDO0 edge, radioRxTxISR() */
+#define EVENT_SEND          0x0001  /* send task: the radio is free */
+#define EVENT_BUTTON        0x0001  /* button task: a push */
+
+/* txStatus besides the CC11XL_STREAM_x values: no packet on air */
+#define TX_IDLE             3
+
+/* Length byte of the packets sent, 1 to 255. Packets longer than the TX FIFO
+ * are streamed, see cc11xL_stream.c.
+ */
+#ifndef PKTLEN
 #define PKTLEN              30
+#endif
+#if (PKTLEN < 3) || (PKTLEN > 255)
+#error "PKTLEN must be 3 to 255"
+#endif
+
+#ifdef EASY_LINK_ADDR
+/* Address of the receiving end, sent after the length byte; it filters on
+ * it, see cc11xL_filter.c, and reads frames whole, so they must fit its
+ * RX FIFO
+ */
+#if (PKTLEN < 4) || (PKTLEN > CC11XL_FILTER_MAX_LEN)
+#error "PKTLEN must be 4 to CC11XL_FILTER_MAX_LEN with EASY_LINK_ADDR"
+#endif
+#define TX_COUNTER_OFFSET   2
+#else
+#define TX_COUNTER_OFFSET   1
+#endif
+
+/* Packets that fit the TX FIFO are written in one go, header and payload
+ * as two segments of one burst. Longer ones are produced by txFill() as the
+ * FIFO drains, TX_CHUNK bytes per FIFO write.
+ */
+#if (PKTLEN + 1 <= CC11XL_FIFO_SIZE)
+#define TX_GATHER
+#else
+#define TX_CHUNK            32
+#endif
+
+/* Data rate profile, index into dataRateProfiles[]. Build both ends of the
+ * link with the same profile.
+ */
+#ifndef EASY_LINK_PROFILE
+#define EASY_LINK_PROFILE   0
+#endif
+
+/* PA ramp for TX power control, PATABLE entries below the level */
+#ifndef EASY_LINK_PA_RAMP
+#define EASY_LINK_PA_RAMP   0
+#endif
+
+#if defined(EASY_LINK_RATE_ADAPT) || defined(EASY_LINK_TX_POWER)
+#define EASY_LINK_LISTEN
+#endif
+
+#ifdef EASY_LINK_LBT
+/* Listen before talk, see cc11xL_lbt.c. The backoff is seeded with
+ * EASY_LINK_LBT_SEED and RSSI noise, so boards running the same image do
+ * not back off in step.
+ */
+#ifndef EASY_LINK_LBT_SEED
+#define EASY_LINK_LBT_SEED  0
+#endif
+#define LBT_SEED_READS      16
+#endif
+
+#ifdef EASY_LINK_LISTEN
+/* Adaptive data rate (cc11xL_rate.c) and TX power control
+ * (cc11xL_txpower.c). After each packet whose counter is a multiple of
+ * LINK_SLOT_PERIOD the radio listens for a short frame from the receiving
+ * end, a rate control or a TX power report: for LINK_TURNAROUND_US, the
+ * time the peer takes to go from RX to TX, plus preamble and sync word.
+ */
+#define LINK_SLOT_PERIOD    16
+#define LINK_TURNAROUND_US  2000
+#define LINK_SYNC_BYTES     8
+#define LINK_POLL_US        100
+
+/* Longest frame taken in the slot, length and status bytes included */
+#define LINK_REPLY_MAX      8
+#endif
 /******************************************************************************
 * LOCAL VARIABLES
 */
-static uint8  packetSemaphore;
 static uint32 packetCounter;
+static uint8  txStatus = TX_IDLE;  /* stream status of the packet on air */
+static uint8  txPaused;         /* sending stopped by the button */
 
 /******************************************************************************
 * STATIC FUNCTIONS
 */
 static void registerConfig(void);
 static void runTX(void);
-static void createPacket(uint8 txBuffer[]);
+static void radioTask(uint16 events);
+static void sendTask(uint16 events);
+static void buttonTask(uint16 events);
+static void txFill(uint16 offset, uint8 count);
 static void radioRxTxISR(void);
+#ifdef EASY_LINK_LISTEN
+static void linkListen(void);
+#endif
+#ifdef EASY_LINK_LBT
+static uint16 lbtSeed(void);
+#endif
+
+/* Task table, index TASK_x */
+static const halSchedTask_t tasks[NUM_TASKS] =
+{
+  radioTask,
+  sendTask,
+  buttonTask
+};
 /******************************************************************************
  * @fn          main
  *
@@ -61,10 +174,18 @@ void main(void)
   P1DIR |= 0x01;
 
   halButtonInterruptEnable();
+  // time base for the CPU load, running in LPM3
+  halMcuTimeInit();
   // init spi
   exp430RfSpiInit();
   // write radio registers
   registerConfig();
+#ifdef TRX_SPI_TRACE
+  // report the time of 64 byte FIFO bursts on the application UART
+  cc11xLRadioIdle();
+  cc11xLSpiTraceBench();
+  trxSpiTraceDrain();
+#endif
 
   uint8 version;
   cc11xLSpiReadReg(CC110L_VERSION ,&version , 1);
@@ -77,8 +198,10 @@ void main(void)
 /******************************************************************************
  * @fn          runTX
  *
- * @brief       sends one packet on button push. Updates packet counter and
- *              display for each packet sent.
+ * @brief       hands the main loop to the tasks: the send task starts a
+ *              packet, the radio task takes it to the end and asks for the
+ *              next, the button task pauses and resumes sending. Lower
+ *              priority tasks run while the radio sends.
  *                
  * @param       none
  *
@@ -86,52 +209,165 @@ void main(void)
  */
 static void runTX(void)
 {
-  // Initialize packet buffer of size PKTLEN + 1
-  uint8 txBuffer[PKTLEN+1] = {0};
+  halSchedInit(tasks, NUM_TASKS);
+  halButtonSetTask(TASK_BUTTON, EVENT_BUTTON);
 
    P2SEL &= ~0x40; // P2SEL bit 6 (GDO0) set to one as default. Set to zero (I/O)
   // connect ISR function to GPIO0, interrupt on falling edge
   trxIsrConnect(GPIO_0, FALLING_EDGE, &radioRxTxISR);
   
   // enable interrupt from GPIO_0
-  trxEnableInt(GPIO_0);
+  TRX_INT_ENABLE(GPIO_0);
   
-  // infinite loop
-  while(1)
+  // first packet, then sleep until a task is posted, run it, and so on for
+  // ever
+  halSchedPost(TASK_SEND, EVENT_SEND);
+  halSchedRun();
+}
+/******************************************************************************
+ * @fn          sendTask
+ *
+ * @brief       Starts the next packet, unless paused. Updates packet
+ *              counter for each packet.
+ *
+ * @param       events - EVENT_SEND
+ *
+ * @return      none
+ */
+static void sendTask(uint16 events)
+{
+  (void)events;
+  if(txPaused)
+  {
+    return;
+  }
+
+  // update packet counter
+  packetCounter++;
+
+#ifdef EASY_LINK_LISTEN
+  // go to RX at the end of a packet after which the peer may send a
+  // rate control or TX power report
+  cc11xLRadioSetMode(((uint16)packetCounter % LINK_SLOT_PERIOD) ? CC11XL_RADIO_MODE_IDLE
+                                                               : CC11XL_RADIO_MODE_TX_LISTEN);
+#endif
+#ifdef EASY_LINK_TX_POWER
+  // PATABLE for the power level of the peer
+  cc11xLTxPowerSelect(0);
+#endif
+  // send the length byte as data in fixed length mode, which is the same
+  // on air as variable length mode. The first FIFO load goes in before
+  // STX, the rest on each falling edge of GDO0, set to the TX FIFO
+  // threshold meanwhile, by the radio task. The settings are left for the
+  // next packet.
+#ifdef EASY_LINK_LBT
+  txStatus = cc11xLStreamTxLoad(CC110L_IOCFG0, (uint16)PKTLEN + 1, &txFill);
+  if(cc11xLLbtTx() != SUCCESS)
+  {
+    // the channel stayed busy: drop the packet
+    cc11xLSpiCmdStrobe(CC110L_SFTX);
+    txStatus = TX_IDLE;
+    halSchedPost(TASK_SEND, EVENT_SEND);
+    return;
+  }
+  // edges of frames heard while assessing the channel
+  halSchedClear(TASK_RADIO, EVENT_RADIO);
+#else
+  txStatus = cc11xLStreamTxStart(CC110L_IOCFG0, (uint16)PKTLEN + 1, &txFill);
+#endif
+  if(txStatus == CC11XL_STREAM_ERROR)
+  {
+    // flush and go on with the next packet
+    cc11xLRadioIdle();
+    cc11xLSpiCmdStrobe(CC110L_SFTX);
+    txStatus = TX_IDLE;
+    halSchedPost(TASK_SEND, EVENT_SEND);
+  }
+}
+/******************************************************************************
+ * @fn          radioTask
+ *
+ * @brief       Highest priority task, on each GDO0 edge: tops the TX FIFO
+ *              up while the packet is streamed, then ends it, listens for a
+ *              reply in the slots the peer may send one, and asks for the
+ *              next packet.
+ *
+ * @param       events - EVENT_RADIO
+ *
+ * @return      none
+ */
+static void radioTask(uint16 events)
+{
+  (void)events;
+  if(txStatus == CC11XL_STREAM_BUSY)
+  {
+    // the radio sends on while the FIFO is topped up
+    txStatus = cc11xLStreamTxRefill();
+    if(txStatus == CC11XL_STREAM_ERROR)
+    {
+      // underflow: the radio stops in TXFIFO_UNDERFLOW, flush and retry
+      cc11xLRadioIdle();
+      cc11xLSpiCmdStrobe(CC110L_SFTX);
+      txStatus = TX_IDLE;
+      halSchedPost(TASK_SEND, EVENT_SEND);
+    }
+    return;
+  }
+  if(txStatus != CC11XL_STREAM_DONE)
   {
-    // wait for button push
-    //if(halButtonPushed())
-
-        // update packet counter
-        packetCounter++;
-        
-        // create a random packet with PKTLEN + 2 byte packet counter + n x random bytes
-        createPacket(txBuffer);
-      
-      // write packet to tx fifo
-      cc11xLSpiWriteTxFifo(txBuffer,sizeof(txBuffer));
-      
-      // strobe TX to send packet
-      trxSpiCmdStrobe(CC110L_STX);
-      
-        // wait for interrupt that packet has been sent. 
-        // (Assumes the GPIO connected to the radioRxTxISR function is set 
-        // to GPIOx_CFG = 0x06)
-        while(!packetSemaphore);
-        
-        // clear semaphore flag
-        packetSemaphore = ISR_IDLE;
-        
-        P1OUT ^= 0x01;
+    // no packet on air
+    return;
+  }
+
+  // the packet has been sent (assumes the GPIO connected to the
+  // radioRxTxISR function is set to GPIOx_CFG = 0x06); the radio is back
+  // in IDLE, or in RX to listen
+  cc11xLRadioPacketEnd();
+
+  P1OUT ^= 0x01;
+
+#ifdef EASY_LINK_TX_POWER
+  cc11xLTxPowerSent(0, (uint16)PKTLEN + 1);
+#endif
+#ifdef EASY_LINK_LISTEN
+  if(cc11xLRadioGetState() == CC11XL_MARC_RX)
+  {
+    linkListen();
+  }
+#endif
 
+#ifdef TRX_SPI_TRACE
+  // report the radio accesses of this packet on the application UART
+  trxSpiTraceDrain();
+#endif
 
+  txStatus = TX_IDLE;
+  halSchedPost(TASK_SEND, EVENT_SEND);
+}
+/******************************************************************************
+ * @fn          buttonTask
+ *
+ * @brief       Pauses sending on a button push, and resumes it on the next.
+ *              A packet on air is sent to the end.
+ *
+ * @param       events - EVENT_BUTTON
+ *
+ * @return      none
+ */
+static void buttonTask(uint16 events)
+{
+  (void)events;
+  txPaused = !txPaused;
+  if(!txPaused && (txStatus == TX_IDLE))
+  {
+    halSchedPost(TASK_SEND, EVENT_SEND);
   }
 }
 /*******************************************************************************
 * @fn          radioRxTxISR
 *
-* @brief       ISR for packet handling in RX. Sets packet semaphore, puts radio
-*              in idle state and clears isr flag.
+* @brief       ISR for packet handling. Posts to the radio task and clears
+*              isr flag.
 *
 * @param       none
 *
@@ -139,11 +375,101 @@ static void runTX(void)
 */
 static void radioRxTxISR(void) {
 
-  // set packet semaphore
-  packetSemaphore = ISR_ACTION_REQUIRED;
+  halSchedPost(TASK_RADIO, EVENT_RADIO);
   // clear isr flag
-  trxClearIntFlag(GPIO_0);
+  TRX_INT_CLEAR(GPIO_0);
+  // let the main loop run
+  HAL_DIGIO2_WAKE_ON_EXIT();
 }
+#ifdef EASY_LINK_LISTEN
+/*******************************************************************************
+* @fn          linkListen
+*
+* @brief       Listens for a frame from the receiving end after a packet: a
+*              rate control, which changes to the profile it asks for, or a
+*              TX power report, which sets the power for the next packets.
+*              The stream settings are put back for ordinary packet
+*              handling, so GDO0 signals the sync word and the end of the
+*              packet. Leaves the radio in IDLE.
+*
+* @param       none
+*
+* @return      none
+*/
+static void linkListen(void)
+{
+  uint8  frame[LINK_REPLY_MAX];
+  cc11xLPacket_t packet;
+  uint16 windowUs;
+  uint16 waitUs;
+  uint8  rxBytes;
+#ifdef EASY_LINK_RATE_ADAPT
+  uint8  profile;
+#endif
+#ifdef EASY_LINK_TX_POWER
+  int8   rssiDbm;
+  uint8  received;
+  uint8  reported = FALSE;
+#endif
+
+  cc11xLStreamTxEnd();
+  halSchedClear(TASK_RADIO, EVENT_RADIO);
+  windowUs = LINK_TURNAROUND_US
+             + (uint16)(LINK_SYNC_BYTES * 8000000UL / cc11xLProfileGet()->dataRate);
+
+  for(waitUs = 0; !trxSampleSyncPin(GPIO_0); waitUs += LINK_POLL_US)
+  {
+    if(waitUs >= windowUs)
+    {
+      cc11xLRadioIdle();
+#ifdef EASY_LINK_TX_POWER
+      // no report: the peer may not have heard the packet
+      cc11xLTxPowerMissed(0);
+#endif
+      return;
+    }
+    halMcuWaitUs(LINK_POLL_US);
+  }
+
+  // sync word found, wait for the end of the packet
+  halSchedWait(TASK_RADIO, EVENT_RADIO);
+  cc11xLRadioIdle();
+
+  rxBytes = cc11xLGetRxFifoBytes();
+  if((rxBytes > 0) && (rxBytes <= sizeof(frame)))
+  {
+    cc11xLSpiReadRxFifo(frame, rxBytes);
+    if((cc11xLPacketParse(&packet, frame, rxBytes) == SUCCESS) && packet.crcOk)
+    {
+#ifdef EASY_LINK_RATE_ADAPT
+      profile = cc11xLRateParseControl(frame, rxBytes);
+      if(profile != CC11XL_RATE_NO_CHANGE)
+      {
+        cc11xLRateApply(profile);
+#ifdef EASY_LINK_TX_POWER
+        reported = TRUE;
+#endif
+      }
+#endif
+#ifdef EASY_LINK_TX_POWER
+      if(cc11xLTxPowerParseFeedback(frame, rxBytes, &rssiDbm, &received) == SUCCESS)
+      {
+        cc11xLTxPowerFeedback(0, rssiDbm, received);
+        reported = TRUE;
+      }
+#endif
+    }
+  }
+#ifdef EASY_LINK_TX_POWER
+  if(!reported)
+  {
+    cc11xLTxPowerMissed(0);
+  }
+#endif
+  cc11xLSpiCmdStrobe(CC110L_SFRX);
+}
+#endif
+
 /*******************************************************************************
 * @fn          registerConfig
 *
@@ -154,37 +480,77 @@ static void radioRxTxISR(void) {
 * @return      none
 */
 static void registerConfig(void) {
-  uint8 writeByte;
-  uint8 readByte;
 #ifdef PA_TABLE
   uint8 paTable[] = PA_TABLE;
 #endif
   
-  uint16 i;
   // reset radio
-  trxSpiCmdStrobe(CC110L_SRES);
-  // write registers to radio
-  for(i = 0; i < (sizeof  preferredSettings/sizeof(registerSetting_t)); i++) {
-    writeByte =  preferredSettings[i].data;
-    cc11xLSpiWriteReg( preferredSettings[i].addr, &writeByte, 1);
-  }
-
-
-  for(i = 0; i < (sizeof  preferredSettings/sizeof(registerSetting_t)); i++) {
-     cc11xLSpiReadReg( preferredSettings[i].addr, &readByte, 1);
-   }
-
+  cc11xLConfigReset();
+  // write registers to radio, one burst per run of consecutive addresses
+  cc11xLConfigLoad(preferredSettings, sizeof(preferredSettings)/sizeof(registerSetting_t));
+  // switch the modem to the data rate profile of the build
+  cc11xLProfileSelect(&dataRateProfiles[EASY_LINK_PROFILE]);
+#ifdef EASY_LINK_RATE_ADAPT
+  cc11xLRateInit(dataRateProfiles, NUM_DATA_RATE_PROFILES, EASY_LINK_PROFILE);
+#endif
 #ifdef PA_TABLE
   // write PA_TABLE
   cc11xLSpiWriteReg(CC11xL_PA_TABLE0,paTable, sizeof(paTable));
 #endif
+#ifdef EASY_LINK_TX_POWER
+  // start at full power, the PATABLE is written before the first packet
+  cc11xLTxPowerInit(paSettings, NUM_PA_SETTINGS, EASY_LINK_PA_RAMP);
+#endif
+#ifdef EASY_LINK_LBT
+  // send only when the channel is clear
+  cc11xLLbtInit(lbtSeed());
+#endif
+}
+#ifdef EASY_LINK_LBT
+/*******************************************************************************
+* @fn          lbtSeed
+*
+* @brief       Builds a backoff seed from EASY_LINK_LBT_SEED and the least
+*              significant bits of RSSI readings taken in RX, which vary
+*              with the noise seen by each board. Leaves the radio in IDLE.
+*
+* @param       none
+*
+* @return      the seed
+*/
+static uint16 lbtSeed(void)
+{
+  uint16 seed = EASY_LINK_LBT_SEED;
+  uint8  rssi;
+  uint8  i;
+
+  cc11xLRadioRx();
+  for(i = 0; i < LBT_SEED_READS; i++)
+  {
+    halMcuWaitUs(cc11xLLbtGetSlotUs());
+    cc11xLSpiReadReg(CC110L_RSSI, &rssi, 1);
+    seed = ((seed << 1) | (seed >> 15)) ^ rssi;
+  }
+  cc11xLRadioIdle();
+  cc11xLSpiCmdStrobe(CC110L_SFRX);
+  return (seed);
 }
+#endif
+
 /******************************************************************************
- * @fn          createPacket
+ * @fn          txFill
+ *
+ * @brief       Stream fill function, called for each TX FIFO load. The
+ *              packet consists of a length byte, two bytes packet counter
+ *              and n random bytes. With EASY_LINK_ADDR the destination
+ *              address goes between length byte and counter.
  *
- * @brief       This function is called before a packet is transmitted. It fills
- *              the txBuffer with a packet consisting of a length byte, two
- *              bytes packet counter and n random bytes.
+ *              A packet that fits the TX FIFO is asked for whole, in the
+ *              one load before STX: header and payload are built in
+ *              separate buffers and written as two segments of one burst.
+ *              A longer packet is produced count bytes at a time, in chunks
+ *              of up to TX_CHUNK bytes, so RAM use does not grow with
+ *              PKTLEN.
  *
  *              The packet format is as follows:
  *              |--------------------------------------------------------------|
@@ -192,24 +558,69 @@ static void registerConfig(void) {
  *              | pktLength | pktCount1 | pktCount0 | rndData |.......| rndData|
  *              |           |           |           |         |       |        |
  *              |--------------------------------------------------------------|
- *               txBuffer[0] txBuffer[1] txBuffer[2]  ......... txBuffer[PKTLEN]
+ *               offset 0    offset 1    offset 2    offset 3  ...     offset PKTLEN
  *                
- * @param       pointer to start of txBuffer
+ * @param       offset - packet offset of the first byte to write
+ * @param       count  - number of bytes to write
  *
  * @return      none
  */
-static void createPacket(uint8 txBuffer[])
+static void txFill(uint16 offset, uint8 count)
 {
-    uint8 i;
-  txBuffer[0] = PKTLEN;                     // Length byte
-  txBuffer[1] = (uint8) packetCounter >> 8; // MSB of packetCounter
-  txBuffer[2] = (uint8) packetCounter;      // LSB of packetCounter
-  
-  // fill rest of buffer with random bytes
-  for(i =3; i< (PKTLEN+1); i++)
+#ifdef TX_GATHER
+  uint8 txHeader[TX_COUNTER_OFFSET + 2];
+  uint8 txPayload[PKTLEN - TX_COUNTER_OFFSET - 1];
+  trxSpiSeg_t txSegs[2];
+  uint8 i;
+
+  (void)offset;
+  (void)count;
+  txHeader[0] = PKTLEN;                                           // Length byte
+#ifdef EASY_LINK_ADDR
+  txHeader[1] = EASY_LINK_ADDR;                                   // Destination address
+#endif
+  txHeader[TX_COUNTER_OFFSET]     = (uint8)(packetCounter >> 8);  // MSB of packetCounter
+  txHeader[TX_COUNTER_OFFSET + 1] = (uint8) packetCounter;        // LSB of packetCounter
+
+  // fill payload with random bytes
+  for(i = 0; i < sizeof(txPayload); i++)
+  {
+    txPayload[i] = (uint8)rand();
+  }
+
+  txSegs[0].pData = txHeader;
+  txSegs[0].len   = sizeof(txHeader);
+  txSegs[1].pData = txPayload;
+  txSegs[1].len   = sizeof(txPayload);
+  // write header and payload to tx fifo in one burst
+  cc11xLSpiWriteTxFifoGather(txSegs, 2);
+#else
+  uint8 chunk[TX_CHUNK];
+  uint8 n;
+  uint8 i;
+
+  while(count)
   {
-    txBuffer[i] = (uint8)rand();
+    n = (count > TX_CHUNK) ? TX_CHUNK : count;
+    for(i = 0; i < n; i++, offset++)
+    {
+      switch(offset)
+      {
+        case 0:  chunk[i] = PKTLEN;                       break; // Length byte
+#ifdef EASY_LINK_ADDR
+        case 1:  chunk[i] = EASY_LINK_ADDR;               break; // Destination address
+#endif
+        case TX_COUNTER_OFFSET:
+                 chunk[i] = (uint8)(packetCounter >> 8);  break; // MSB of packetCounter
+        case TX_COUNTER_OFFSET + 1:
+                 chunk[i] = (uint8) packetCounter;        break; // LSB of packetCounter
+        default: chunk[i] = (uint8)rand();                break; // random payload
+      }
+    }
+    cc11xLSpiWriteTxFifo(chunk, n);
+    count -= n;
   }
+#endif
 }
 /***********************************************************************************
   Copyright 2012 Texas Instruments Incorporated. All rights reserved.
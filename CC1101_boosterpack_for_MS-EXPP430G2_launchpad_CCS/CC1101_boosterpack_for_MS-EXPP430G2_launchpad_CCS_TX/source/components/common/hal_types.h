@@ -200,6 +200,8 @@ typedef unsigned short istate_t;
 #define FAR far
 #endif
 
+typedef unsigned short istate_t;
+
 
 /*******************************************************************************
 * Code Composer Studio
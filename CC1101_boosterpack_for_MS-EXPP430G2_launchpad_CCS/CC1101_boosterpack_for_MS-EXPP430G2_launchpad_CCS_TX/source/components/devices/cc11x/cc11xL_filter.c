@@ -0,0 +1,215 @@
+/******************************************************************************
+    Filename: cc11xL_filter.c
+
+    Description: hardware packet filtering. The radio checks the address
+                 byte, the first after the length byte, against ADDR and the
+                 broadcast addresses PKTCTRL1.ADR_CHK allows, and drops a
+                 frame that does not match two bytes in, going on in RX.
+                 With CRC_AUTOFLUSH it also flushes a frame whose CRC fails.
+                 The GDO is set to signal a frame with CRC OK in the RX
+                 FIFO, so the MCU is only woken, and the FIFO only read, for
+                 frames that are good and meant for this node; frames for
+                 other nodes and corrupt frames cost no interrupt and no SPI
+                 access at all.
+
+                 To count dropped frames the GDO can signal the end of
+                 every frame instead. A frame that ends with the RX FIFO
+                 empty was dropped, which costs reading RXBYTES (a single
+                 status byte out of RX) and no FIFO access. A frame
+                 dropped for its address ends the same way, so with an
+                 address check on, frames for other nodes are counted as
+                 dropped too.
+
+                 Autoflush needs the whole frame in the RX FIFO, and it
+                 flushes all of the FIFO, so frames are limited to
+                 CC11XL_FILTER_MAX_LEN bytes, or less to fit the caller's
+                 buffer, and each is read before the next one ends, unlike
+                 with cc11xL_stream.c.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_filter.h"
+#include "cc11xL_config.h"
+#include "cc11xL_radio.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 filterRxSaved;
+static uint8 filterRxIocfgAddr;
+static uint8 filterRxMaxLen = CC11XL_FILTER_MAX_LEN;
+/* Setting found at start, put back by cc11xLFilterRxEnd() */
+static uint8 filterRxIocfg;
+
+/******************************************************************************
+ * @fn          cc11xLFilterSet
+ *
+ * @brief       Programs the node address and the address check, and turns
+ *              on CRC autoflush and status appending. Frames sent to a
+ *              node filtering on its address must carry the address byte.
+ *
+ * input parameters
+ *
+ * @param       addr   - address of this node, not a broadcast address
+ *                       when one is allowed by adrChk
+ * @param       adrChk - CC11XL_ADR_CHK_x; CC11XL_ADR_CHK_NONE filters on
+ *                       the CRC only
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLFilterSet(uint8 addr, uint8 adrChk)
+{
+  uint8 pktctrl1 = cc11xLConfigGet(CC110L_PKTCTRL1);
+
+  cc11xLConfigSet(CC110L_ADDR, addr);
+  cc11xLConfigSet(CC110L_PKTCTRL1, (pktctrl1 & ~CC11XL_PKTCTRL1_ADR_CHK_BM)
+                  | (adrChk & CC11XL_PKTCTRL1_ADR_CHK_BM)
+                  | CC11XL_PKTCTRL1_CRC_AUTOFLUSH | CC11XL_PKTCTRL1_APPEND_STATUS);
+}
+
+/******************************************************************************
+ * @fn          cc11xLFilterOff
+ *
+ * @brief       Turns the address check and CRC autoflush off again, e.g.
+ *              to stream frames longer than the RX FIFO.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLFilterOff(void)
+{
+  uint8 pktctrl1 = cc11xLConfigGet(CC110L_PKTCTRL1);
+
+  cc11xLConfigSet(CC110L_PKTCTRL1, pktctrl1
+                  & ~(CC11XL_PKTCTRL1_ADR_CHK_BM | CC11XL_PKTCTRL1_CRC_AUTOFLUSH));
+}
+
+/******************************************************************************
+ * @fn          cc11xLFilterRxStart
+ *
+ * @brief       Limits the length byte to maxLen, sets the GDO at iocfgAddr to signal a frame with CRC OK, active low,
+ *              or the sync word until the end of the frame, and enters RX,
+ *              unless the radio is there already. Call
+ *              cc11xLFilterRxRead() on each falling edge of the GDO; with
+ *              CC11XL_RADIO_MODE_RX_CONT set the radio stays in RX and
+ *              receives the next frame meanwhile.
+ *
+ * input parameters
+ *
+ * @param       iocfgAddr - CC110L_IOCFG0 or CC110L_IOCFG2, the GDO whose
+ *                          interrupt is serviced on the falling edge
+ * @param       wake      - CC11XL_FILTER_WAKE_GOOD or CC11XL_FILTER_WAKE_END
+ * @param       maxLen    - longest length byte, up to CC11XL_FILTER_MAX_LEN;
+ *                          the radio drops longer frames
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+uint8 cc11xLFilterRxStart(uint8 iocfgAddr, uint8 wake, uint8 maxLen)
+{
+  if(!filterRxSaved)
+  {
+    filterRxIocfg = cc11xLConfigGet(iocfgAddr);
+    filterRxSaved = TRUE;
+  }
+  filterRxIocfgAddr = iocfgAddr;
+  filterRxMaxLen    = (maxLen > CC11XL_FILTER_MAX_LEN) ? CC11XL_FILTER_MAX_LEN : maxLen;
+
+  cc11xLConfigSet(CC110L_PKTLEN, filterRxMaxLen);
+  cc11xLConfigSet(iocfgAddr, (wake == CC11XL_FILTER_WAKE_END) ? CC11XL_GDO_SYNC_EOP
+                                                              : CC11XL_GDO_CRC_OK | CC11XL_GDO_INV);
+  return (cc11xLRadioRx());
+}
+
+/******************************************************************************
+ * @fn          cc11xLFilterRxRead
+ *
+ * @brief       Reads the frame at the head of the RX FIFO: the length byte,
+ *              then payload and status bytes in one burst. Bytes of a next
+ *              frame already arriving are left in the FIFO. An empty FIFO
+ *              means the radio dropped the frame, only possible with
+ *              CC11XL_FILTER_WAKE_END. The end of the frame is passed on
+ *              to cc11xLRadioPacketEnd().
+ *
+ * input parameters
+ *
+ * @param       pFrame  - buffer of 1 + maxLen + CC11XL_STATUS_LEN bytes,
+ *                        maxLen as given to cc11xLFilterRxStart()
+ *
+ * output parameters
+ *
+ * @param       pPacket - the descriptor, its payload points into pFrame
+ *
+ * @return      CC11XL_FILTER_FRAME, CC11XL_FILTER_FLUSHED or
+ *              CC11XL_FILTER_ERROR; flush the RX FIFO on an error
+ */
+uint8 cc11xLFilterRxRead(uint8 *pFrame, cc11xLPacket_t *pPacket)
+{
+  uint8 rxBytes = cc11xLGetRxFifoBytes();
+
+  pPacket->pPayload = NULL;
+  pPacket->length   = 0;
+  pPacket->crcOk    = FALSE;
+  if(CC11XL_STATUS_STATE(cc11xLGetCachedStatus()) == CC110L_STATE_RXFIFO_ERROR)
+  {
+    return (CC11XL_FILTER_ERROR);
+  }
+  if(rxBytes == 0)
+  {
+    cc11xLRadioPacketEnd();
+    return (CC11XL_FILTER_FLUSHED);
+  }
+  if(rxBytes < 1 + CC11XL_STATUS_LEN)
+  {
+    return (CC11XL_FILTER_ERROR);
+  }
+  cc11xLSpiReadRxFifo(pFrame, 1);
+  if((pFrame[0] > filterRxMaxLen) || (rxBytes < pFrame[0] + 1 + CC11XL_STATUS_LEN))
+  {
+    return (CC11XL_FILTER_ERROR);
+  }
+  cc11xLSpiReadRxFifo(&pFrame[1], pFrame[0] + CC11XL_STATUS_LEN);
+  cc11xLRadioPacketEnd();
+  return ((cc11xLPacketParse(pPacket, pFrame, pFrame[0] + 1 + CC11XL_STATUS_LEN) == SUCCESS)
+          ? CC11XL_FILTER_FRAME : CC11XL_FILTER_ERROR);
+}
+
+/******************************************************************************
+ * @fn          cc11xLFilterRxEnd
+ *
+ * @brief       Puts back the GDO setting found by the first
+ *              cc11xLFilterRxStart(), e.g. to signal the end of a packet
+ *              sent. PKTLEN is left as it is, it does not limit TX in
+ *              variable length mode.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLFilterRxEnd(void)
+{
+  if(filterRxSaved)
+  {
+    cc11xLConfigSet(filterRxIocfgAddr, filterRxIocfg);
+    filterRxSaved = FALSE;
+  }
+}
@@ -0,0 +1,260 @@
+/******************************************************************************
+    Filename: cc11xL_fscal.c  
+    
+    Description: per-channel frequency synthesizer calibration cache. With
+                 FS_AUTOCAL set, every start of the synthesizer from IDLE
+                 runs a calibration (about 720 us) before the 90 us settling
+                 time. For a small hop set each channel is calibrated once
+                 with SCAL and the resulting FSCAL3..FSCAL1 values are kept in
+                 RAM; a channel switch then writes the frequency word and the
+                 stored values, and the radio only settles when it leaves
+                 IDLE. The CC11xL has no CHANNR register, so channels are
+                 given as 24 bit FREQ words. A calibration is redone after
+                 CC11XL_FSCAL_MAX_AGE switches to its channel, or on the next
+                 switch after the temperature reported by the caller has
+                 drifted by more than CC11XL_FSCAL_TEMP_DELTA.
+                 
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_fscal.h"
+#include "cc11xL_config.h"
+#include "cc11xL_radio.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Age of an entry without a calibration */
+#define FSCAL_INVALID             0xFF
+
+#if (CC11XL_FSCAL_MAX_AGE >= FSCAL_INVALID)
+#error "CC11XL_FSCAL_MAX_AGE must be below 255"
+#endif
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint8 fscal3;
+  uint8 fscal2;
+  uint8 fscal1;
+  uint8 age;      /* switches since calibration, FSCAL_INVALID if none */
+}fscalEntry_t;
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static fscalEntry_t  fscalCache[CC11XL_FSCAL_MAX_CHANNELS];
+static const uint32 *pFscalFreqs;
+static uint8         fscalNumChannels;
+static uint8         fscalChannel = CC11XL_FSCAL_NO_CHANNEL;
+static int8          fscalTempC;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static void cc11xLFscalCalibrate(uint8 channel);
+
+/******************************************************************************
+ * @fn          cc11xLFscalInit
+ *
+ * @brief       Takes over synthesizer calibration from the radio: clears
+ *              FS_AUTOCAL in MCSM0 and calibrates each channel of the hop
+ *              set once. Leaves the radio in IDLE on the last channel.
+ *
+ * input parameters
+ *
+ * @param       pFreqs      - FREQ2:FREQ1:FREQ0 word per channel, kept by
+ *                            reference
+ * @param       numChannels - channels in the set, at most
+ *                            CC11XL_FSCAL_MAX_CHANNELS are used
+ * @param       tempC       - current temperature in degrees C
+ *
+ * output parameters
+ *
+ * @return      number of channels cached
+ */
+uint8 cc11xLFscalInit(const uint32 *pFreqs, uint8 numChannels, int8 tempC)
+{
+  uint8 i;
+
+  if(numChannels > CC11XL_FSCAL_MAX_CHANNELS)
+  {
+    numChannels = CC11XL_FSCAL_MAX_CHANNELS;
+  }
+  pFscalFreqs      = pFreqs;
+  fscalNumChannels = numChannels;
+  fscalTempC       = tempC;
+  fscalChannel     = CC11XL_FSCAL_NO_CHANNEL;
+
+  cc11xLConfigSet(CC110L_MCSM0, cc11xLConfigGet(CC110L_MCSM0) & ~CC11XL_MCSM0_FS_AUTOCAL_BM);
+  if(cc11xLRadioGetState() != CC11XL_MARC_IDLE)
+  {
+    cc11xLRadioIdle();
+  }
+  for(i = 0; i < numChannels; i++)
+  {
+    cc11xLFscalCalibrate(i);
+    fscalChannel = i;
+  }
+  return (numChannels);
+}
+
+/******************************************************************************
+ * @fn          cc11xLFscalSetChannel
+ *
+ * @brief       Switches to a channel of the hop set. The radio is put in
+ *              IDLE, where the frequency may be changed, and the frequency
+ *              word and the cached calibration are written with one burst
+ *              each. A channel without a valid calibration is calibrated
+ *              first. Enter RX or TX afterwards as usual.
+ *
+ * input parameters
+ *
+ * @param       channel - index into the hop set
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+rfStatus_t cc11xLFscalSetChannel(uint8 channel)
+{
+  registerSetting_t settings[6];
+  fscalEntry_t     *pEntry;
+  uint32            freq;
+
+  if(channel >= fscalNumChannels)
+  {
+    return (cc11xLGetCachedStatus());
+  }
+  if(cc11xLRadioGetState() != CC11XL_MARC_IDLE)
+  {
+    cc11xLRadioIdle();
+  }
+
+  pEntry = &fscalCache[channel];
+  if(pEntry->age >= CC11XL_FSCAL_MAX_AGE)
+  {
+    cc11xLFscalCalibrate(channel);
+  }
+  else
+  {
+    freq = pFscalFreqs[channel];
+    settings[0].addr = CC110L_FREQ2;
+    settings[0].data = (uint8)(freq >> 16);
+    settings[1].addr = CC110L_FREQ1;
+    settings[1].data = (uint8)(freq >> 8);
+    settings[2].addr = CC110L_FREQ0;
+    settings[2].data = (uint8)freq;
+    settings[3].addr = CC110L_FSCAL3;
+    settings[3].data = pEntry->fscal3;
+    settings[4].addr = CC110L_FSCAL2;
+    settings[4].data = pEntry->fscal2;
+    settings[5].addr = CC110L_FSCAL1;
+    settings[5].data = pEntry->fscal1;
+    cc11xLConfigLoad(settings, 6);
+  }
+  pEntry->age++;
+  fscalChannel = channel;
+  return (cc11xLGetCachedStatus());
+}
+
+/******************************************************************************
+ * @fn          cc11xLFscalGetChannel
+ *
+ * @brief       Returns the channel the radio is set to.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      index into the hop set, CC11XL_FSCAL_NO_CHANNEL if none
+ */
+uint8 cc11xLFscalGetChannel(void)
+{
+  return (fscalChannel);
+}
+
+/******************************************************************************
+ * @fn          cc11xLFscalSetTemperature
+ *
+ * @brief       Reports the current temperature, e.g. from the MCU's ADC
+ *              temperature sensor. If it is more than
+ *              CC11XL_FSCAL_TEMP_DELTA away from the temperature at
+ *              calibration, every channel is recalibrated on its next use.
+ *
+ * input parameters
+ *
+ * @param       tempC - temperature in degrees C
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLFscalSetTemperature(int8 tempC)
+{
+  int16 drift = (int16)tempC - fscalTempC;
+
+  if((drift > CC11XL_FSCAL_TEMP_DELTA) || (drift < -CC11XL_FSCAL_TEMP_DELTA))
+  {
+    cc11xLFscalInvalidate();
+    fscalTempC = tempC;
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLFscalInvalidate
+ *
+ * @brief       Drops all cached calibrations, so each channel is calibrated
+ *              on its next use, e.g. after a change of supply voltage.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLFscalInvalidate(void)
+{
+  uint8 i;
+
+  for(i = 0; i < CC11XL_FSCAL_MAX_CHANNELS; i++)
+  {
+    fscalCache[i].age = FSCAL_INVALID;
+  }
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* Sets the frequency of a channel, calibrates the synthesizer with SCAL (the
+ * radio is in IDLE) and stores the result.
+ */
+static void cc11xLFscalCalibrate(uint8 channel)
+{
+  fscalEntry_t *pEntry = &fscalCache[channel];
+  uint32        freq   = pFscalFreqs[channel];
+
+  cc11xLConfigSet(CC110L_FREQ2, (uint8)(freq >> 16));
+  cc11xLConfigSet(CC110L_FREQ1, (uint8)(freq >> 8));
+  cc11xLConfigSet(CC110L_FREQ0, (uint8)freq);
+  cc11xLSpiCmdStrobe(CC110L_SCAL);
+  while(cc11xLRadioReadState() != CC11XL_MARC_IDLE);
+
+  cc11xLConfigRefresh(CC110L_FSCAL3, 3);
+  pEntry->fscal3 = cc11xLConfigGet(CC110L_FSCAL3);
+  pEntry->fscal2 = cc11xLConfigGet(CC110L_FSCAL2);
+  pEntry->fscal1 = cc11xLConfigGet(CC110L_FSCAL1);
+  pEntry->age    = 0;
+}
@@ -0,0 +1,275 @@
+/******************************************************************************
+    Filename: cc11xL_lbt.c
+
+    Description: listen before talk. The frame is loaded into the TX FIFO
+                 with the radio in IDLE (cc11xLStreamTxLoad()), then for
+                 each attempt:
+
+                 - wait a random number of slots, 0 to 2^BE - 1
+                 - enter RX and wait one slot for the RSSI to settle
+                 - strobe STX: with MCSM1.CCA_MODE set, the radio only
+                   leaves RX for TX when the channel is clear
+                 - read MARCSTATE, again while it is on the way from RX
+                   to TX (RXTX_SWITCH, FSTXON); still in RX means the STX
+                   was refused and the channel busy, so the radio goes
+                   back to IDLE and BE is raised by one, up to
+                   CC11XL_LBT_MAX_BE
+
+                 A frame is given up after CC11XL_LBT_MAX_BACKOFFS busy
+                 assessments. The slot is CC11XL_LBT_SLOT_BITS at the data
+                 rate of the profile in use plus the RX to TX turnaround,
+                 so it follows cc11xLProfileSelect(); it can be fixed with
+                 cc11xLLbtSetSlotUs() instead. Backoffs come from a 16 bit
+                 xorshift generator, seeded per node so that nodes do not
+                 back off in step.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_lbt.h"
+#include "cc11xL_config.h"
+#include "cc11xL_radio.h"
+#include "cc11xL_profile.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_mcu.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Used for a seed of 0, which the generator would not leave */
+#define LBT_RANDOM_SEED             0xACE1
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static uint16 lbtRandom = LBT_RANDOM_SEED;
+static cc11xLLbtStats_t lbtStats;
+
+/* Slot set by the application, 0 to derive it from the profile */
+static uint16 lbtSlotUs;
+/* Slot derived for the profile it was derived for */
+static const cc11xLProfile_t *pLbtSlotProfile;
+static uint16 lbtSlotProfileUs = CC11XL_LBT_TURNAROUND_US;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static uint8  cc11xLLbtAssess(uint16 slotUs);
+static uint16 cc11xLLbtRandom(void);
+static void   cc11xLLbtAdd(uint32 *pCounter, uint32 value);
+
+/******************************************************************************
+ * @fn          cc11xLLbtInit
+ *
+ * @brief       Sets MCSM1.CCA_MODE to CC11XL_LBT_CCA_MODE, seeds the
+ *              backoff and clears the counters. Call after the registers
+ *              are loaded; the other MCSM1 fields are kept.
+ *
+ * input parameters
+ *
+ * @param       seed - differs between nodes, e.g. an address or RSSI
+ *                     readings; 0 is replaced by a fixed seed
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLLbtInit(uint16 seed)
+{
+  uint8 mcsm1 = cc11xLConfigGet(CC110L_MCSM1);
+
+  cc11xLConfigSet(CC110L_MCSM1, (mcsm1 & ~CC11XL_MCSM1_CCA_MODE_BM) | CC11XL_LBT_CCA_MODE);
+  lbtRandom             = seed ? seed : LBT_RANDOM_SEED;
+  lbtStats.frames       = 0;
+  lbtStats.busy         = 0;
+  lbtStats.failures     = 0;
+  lbtStats.backoffSlots = 0;
+}
+
+/******************************************************************************
+ * @fn          cc11xLLbtSetSlotUs
+ *
+ * @brief       Fixes the slot time, e.g. to that of the slowest node, or
+ *              goes back to deriving it from the profile in use.
+ *
+ * input parameters
+ *
+ * @param       slotUs - slot time in microseconds, 0 to derive it
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLLbtSetSlotUs(uint16 slotUs)
+{
+  lbtSlotUs = slotUs;
+}
+
+/******************************************************************************
+ * @fn          cc11xLLbtGetSlotUs
+ *
+ * @brief       Returns the slot time. A derived slot is worked out once per
+ *              profile selected; with no profile selected only the
+ *              turnaround is used, so set the slot in that case.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      slot time in microseconds
+ */
+uint16 cc11xLLbtGetSlotUs(void)
+{
+  const cc11xLProfile_t *pProfile;
+  uint32 slotUs;
+
+  if(lbtSlotUs)
+  {
+    return (lbtSlotUs);
+  }
+  pProfile = cc11xLProfileGet();
+  if(pProfile != pLbtSlotProfile)
+  {
+    slotUs = CC11XL_LBT_TURNAROUND_US;
+    if(pProfile != NULL)
+    {
+      slotUs += CC11XL_LBT_SLOT_BITS * 1000000UL / pProfile->dataRate;
+    }
+    lbtSlotProfileUs = (slotUs > 0xFFFF) ? 0xFFFF : (uint16)slotUs;
+    pLbtSlotProfile  = pProfile;
+  }
+  return (lbtSlotProfileUs);
+}
+
+/******************************************************************************
+ * @fn          cc11xLLbtTx
+ *
+ * @brief       Sends the frame in the TX FIFO once the channel is clear,
+ *              backing off while it is busy. Call with the radio in IDLE.
+ *              On success the radio is in TX, as after cc11xLRadioTx();
+ *              GDO edges from frames heard during the assessment may have
+ *              fired, so clear the packet interrupt flag before waiting
+ *              for the end of the frame. On failure the radio is in IDLE
+ *              with the frame still in the TX FIFO, to flush or to try
+ *              again.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      SUCCESS, or FAILED if the channel stayed busy
+ */
+uint8 cc11xLLbtTx(void)
+{
+  uint16 slotUs   = cc11xLLbtGetSlotUs();
+  uint8  be       = CC11XL_LBT_MIN_BE;
+  uint8  backoffs = 0;
+  uint8  slots;
+
+  cc11xLLbtAdd(&lbtStats.frames, 1);
+  for(;;)
+  {
+    slots = (uint8)(cc11xLLbtRandom() & ((1 << be) - 1));
+    cc11xLLbtAdd(&lbtStats.backoffSlots, slots);
+    while(slots--)
+    {
+      halMcuWaitUs(slotUs);
+    }
+
+    if(cc11xLLbtAssess(slotUs))
+    {
+      return (SUCCESS);
+    }
+
+    // busy: back off in IDLE, dropping what the RX FIFO got meanwhile
+    cc11xLLbtAdd(&lbtStats.busy, 1);
+    cc11xLRadioIdle();
+    cc11xLSpiCmdStrobe(CC110L_SFRX);
+    if(++backoffs > CC11XL_LBT_MAX_BACKOFFS)
+    {
+      cc11xLLbtAdd(&lbtStats.failures, 1);
+      return (FAILED);
+    }
+    if(be < CC11XL_LBT_MAX_BE)
+    {
+      be++;
+    }
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLLbtGetStats
+ *
+ * @brief       Returns the channel access counters.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      the counters
+ */
+const cc11xLLbtStats_t *cc11xLLbtGetStats(void)
+{
+  return (&lbtStats);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* One assessment: RX, a slot for the RSSI, then STX. Returns TRUE if the
+ * radio left RX for TX. Only a refused STX leaves it in RX; right after the
+ * strobe it may still be switching, which is not taken for busy. Not
+ * reaching RX, e.g. after an RX FIFO overflow, counts as busy.
+ */
+static uint8 cc11xLLbtAssess(uint16 slotUs)
+{
+  uint8 polls;
+  uint8 state;
+
+  cc11xLRadioRx();
+  for(polls = 0; cc11xLRadioReadState() != CC11XL_MARC_RX; polls++)
+  {
+    if(polls >= CC11XL_LBT_MAX_POLLS)
+    {
+      return (FALSE);
+    }
+    halMcuWaitUs(CC11XL_LBT_POLL_US);
+  }
+  halMcuWaitUs(slotUs);
+
+  cc11xLRadioTx();
+  state = cc11xLRadioReadState();
+  for(polls = 0; ((state == CC11XL_MARC_RXTX_SWITCH) || (state == CC11XL_MARC_FSTXON))
+                 && (polls < CC11XL_LBT_MAX_POLLS); polls++)
+  {
+    halMcuWaitUs(CC11XL_LBT_POLL_US);
+    state = cc11xLRadioReadState();
+  }
+  return ((state != CC11XL_MARC_RX) && (state != CC11XL_MARC_RXFIFO_OVERFLOW));
+}
+
+/* 16 bit xorshift (7, 9, 8), period 2^16 - 1 */
+static uint16 cc11xLLbtRandom(void)
+{
+  lbtRandom ^= lbtRandom << 7;
+  lbtRandom ^= lbtRandom >> 9;
+  lbtRandom ^= lbtRandom << 8;
+  return (lbtRandom);
+}
+
+/* Adds to a counter, saturating */
+static void cc11xLLbtAdd(uint32 *pCounter, uint32 value)
+{
+  *pCounter = (*pCounter > 0xFFFFFFFFUL - value) ? 0xFFFFFFFFUL : *pCounter + value;
+}
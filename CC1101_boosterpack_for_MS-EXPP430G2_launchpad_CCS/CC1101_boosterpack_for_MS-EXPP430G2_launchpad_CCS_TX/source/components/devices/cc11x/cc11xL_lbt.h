@@ -0,0 +1,90 @@
+/******************************************************************************
+    Filename: cc11xL_lbt.h
+
+    Description: header file for listen before talk channel access of the
+                 CC11xL: clear channel assessment in RX with randomized
+                 binary exponential backoff.
+
+*******************************************************************************/
+#ifndef CC11xL_LBT_H
+#define CC11xL_LBT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* MCSM1 CCA_MODE field: when STX from RX is allowed to enter TX */
+#define CC11XL_MCSM1_CCA_MODE_BM        0x30
+#define CC11XL_CCA_MODE_ALWAYS          0x00  /* no assessment */
+#define CC11XL_CCA_MODE_RSSI            0x10  /* RSSI below threshold */
+#define CC11XL_CCA_MODE_NOT_RX          0x20  /* not receiving a packet */
+#define CC11XL_CCA_MODE_RSSI_NOT_RX     0x30  /* both */
+
+/* Assessment used by cc11xLLbtInit() */
+#ifndef CC11XL_LBT_CCA_MODE
+#define CC11XL_LBT_CCA_MODE             CC11XL_CCA_MODE_RSSI_NOT_RX
+#endif
+
+/* Backoff exponents: the first backoff is 0 to 2^MIN_BE - 1 slots, each
+ * busy channel doubles the range up to 2^MAX_BE slots
+ */
+#ifndef CC11XL_LBT_MIN_BE
+#define CC11XL_LBT_MIN_BE               3
+#endif
+#ifndef CC11XL_LBT_MAX_BE
+#define CC11XL_LBT_MAX_BE               5
+#endif
+
+/* Busy assessments after which a frame is given up */
+#ifndef CC11XL_LBT_MAX_BACKOFFS
+#define CC11XL_LBT_MAX_BACKOFFS         4
+#endif
+
+/* Slot time: CC11XL_LBT_SLOT_BITS at the data rate of the profile in use,
+ * for the RSSI to settle in RX, plus the RX to TX turnaround
+ */
+#ifndef CC11XL_LBT_SLOT_BITS
+#define CC11XL_LBT_SLOT_BITS            16
+#endif
+#ifndef CC11XL_LBT_TURNAROUND_US
+#define CC11XL_LBT_TURNAROUND_US        100
+#endif
+
+/* Polling for RX to be reached after SRX, calibration included */
+#define CC11XL_LBT_POLL_US              100
+#define CC11XL_LBT_MAX_POLLS            20
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* Channel access counters, saturating */
+typedef struct
+{
+  uint32 frames;                            /* cc11xLLbtTx() calls */
+  uint32 busy;                              /* assessments that backed off */
+  uint32 failures;                          /* frames given up */
+  uint32 backoffSlots;                      /* slots waited in backoff */
+}cc11xLLbtStats_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+void       cc11xLLbtInit(uint16 seed);
+void       cc11xLLbtSetSlotUs(uint16 slotUs);
+uint16     cc11xLLbtGetSlotUs(void);
+uint8      cc11xLLbtTx(void);
+const cc11xLLbtStats_t *cc11xLLbtGetStats(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_LBT_H
@@ -0,0 +1,59 @@
+/******************************************************************************
+    Filename: cc11xL_packet.h
+
+    Description: header file for parsing received CC11xL frames and the
+                 link quality the radio appends to them.
+
+*******************************************************************************/
+#ifndef CC11xL_PACKET_H
+#define CC11xL_PACKET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Status bytes appended with PKTCTRL1.APPEND_STATUS: RSSI, then LQI with
+ * CRC_OK in bit 7
+ */
+#define CC11XL_STATUS_LEN           2
+#define CC11XL_STATUS_CRC_OK_BM     0x80
+#define CC11XL_STATUS_LQI_BM        0x7F
+
+/* RSSI offset of the CC110L, RSSI dBm = RSSI / 2 - offset */
+#define CC11XL_RSSI_OFFSET          74
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* A received frame. pPayload points into the caller's buffer and is NULL
+ * for frames streamed out of the FIFO, whose payload has already gone to
+ * the drain function.
+ */
+typedef struct
+{
+  uint8 *pPayload;                          /* payload, after the length byte */
+  uint8  length;                            /* payload bytes */
+  int8   rssiDbm;
+  uint8  lqi;                               /* 0 - 127, lower is better */
+  uint8  crcOk;                             /* TRUE if the CRC matched */
+}cc11xLPacket_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+int8  cc11xLPacketRssiDbm(uint8 rssi);
+void  cc11xLPacketSetStatus(cc11xLPacket_t *pPacket, const uint8 *pStatus);
+uint8 cc11xLPacketParse(cc11xLPacket_t *pPacket, uint8 *pFrame, uint16 len);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_PACKET_H
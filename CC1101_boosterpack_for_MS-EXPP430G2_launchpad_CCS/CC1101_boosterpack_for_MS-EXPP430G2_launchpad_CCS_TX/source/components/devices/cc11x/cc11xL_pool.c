@@ -0,0 +1,169 @@
+/******************************************************************************
+    Filename: cc11xL_pool.c
+
+    Description: frame buffer pool. CC11XL_POOL_BLOCKS blocks of
+                 CC11XL_POOL_BLOCK_SIZE bytes, sized at compile time, take
+                 the place of a frame buffer in each layer: the driver reads
+                 the RX FIFO straight into a block, and the block is handed
+                 on by its one byte handle until its last owner frees it, so
+                 the frame is never copied.
+
+                 Free blocks are kept on a list linked through a byte per
+                 block, so allocating and freeing take the same few
+                 instructions whatever the pool size. Blocks never handed
+                 out yet are taken in order first, so the pool needs no
+                 initialization. Both run with interrupts locked for those
+                 instructions and may be called from an ISR.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_pool.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_int.h"
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8 poolBlock[CC11XL_POOL_BLOCKS][CC11XL_POOL_BLOCK_SIZE];
+/* Free list: head, and the next free block after each free block */
+static uint8 poolNext[CC11XL_POOL_BLOCKS];
+static uint8 poolFreeHead = CC11XL_POOL_NONE;
+/* Blocks handed out at least once, the others are free */
+static uint8 poolFresh;
+static uint8 poolInUse;
+static cc11xLPoolStats_t poolStats = {0, 0, CC11XL_POOL_BLOCKS};
+
+/******************************************************************************
+ * @fn          cc11xLPoolAlloc
+ *
+ * @brief       Takes a free block. The caller owns it until it is freed, or
+ *              handed on with its handle.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      handle of the block, CC11XL_POOL_NONE if none is free
+ */
+cc11xLBuf_t cc11xLPoolAlloc(void)
+{
+  cc11xLBuf_t buf;
+  istate_t key;
+
+  HAL_INT_LOCK(key);
+  buf = poolFreeHead;
+  if(buf != CC11XL_POOL_NONE)
+  {
+    poolFreeHead = poolNext[buf];
+  }
+  else if(poolFresh < CC11XL_POOL_BLOCKS)
+  {
+    buf = poolFresh++;
+  }
+  if(buf != CC11XL_POOL_NONE)
+  {
+    poolInUse++;
+    poolStats.allocs++;
+    if(CC11XL_POOL_BLOCKS - poolInUse < poolStats.minFree)
+    {
+      poolStats.minFree = CC11XL_POOL_BLOCKS - poolInUse;
+    }
+  }
+  else
+  {
+    poolStats.failures++;
+  }
+  HAL_INT_UNLOCK(key);
+  return (buf);
+}
+
+/******************************************************************************
+ * @fn          cc11xLPoolFree
+ *
+ * @brief       Gives a block back. CC11XL_POOL_NONE is ignored, so a handle
+ *              that may not have been allocated can be passed as it is.
+ *
+ * input parameters
+ *
+ * @param       buf - handle of the block
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLPoolFree(cc11xLBuf_t buf)
+{
+  istate_t key;
+
+  if(buf >= CC11XL_POOL_BLOCKS)
+  {
+    return;
+  }
+  HAL_INT_LOCK(key);
+  poolNext[buf] = poolFreeHead;
+  poolFreeHead  = buf;
+  poolInUse--;
+  HAL_INT_UNLOCK(key);
+}
+
+/******************************************************************************
+ * @fn          cc11xLPoolData
+ *
+ * @brief       Returns the bytes of a block.
+ *
+ * input parameters
+ *
+ * @param       buf - handle of the block
+ *
+ * output parameters
+ *
+ * @return      CC11XL_POOL_BLOCK_SIZE bytes, NULL for CC11XL_POOL_NONE
+ */
+uint8 *cc11xLPoolData(cc11xLBuf_t buf)
+{
+  return ((buf < CC11XL_POOL_BLOCKS) ? poolBlock[buf] : NULL);
+}
+
+/******************************************************************************
+ * @fn          cc11xLPoolFreeCount
+ *
+ * @brief       Returns the number of free blocks.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      free blocks
+ */
+uint8 cc11xLPoolFreeCount(void)
+{
+  return (CC11XL_POOL_BLOCKS - poolInUse);
+}
+
+/******************************************************************************
+ * @fn          cc11xLPoolGetStats
+ *
+ * @brief       Returns the pool counters.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      the counters
+ */
+const cc11xLPoolStats_t *cc11xLPoolGetStats(void)
+{
+  return (&poolStats);
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+    Filename: cc11xL_radio.h  
+    
+    Description: header file for the CC11xL radio state manager, which sets
+                 what the radio does at the end of a packet (MCSM1) and
+                 keeps track of the main radio control state.
+                 
+*******************************************************************************/
+#ifndef CC11xL_RADIO_H
+#define CC11xL_RADIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* MARCSTATE values */
+#define CC11XL_MARC_SLEEP               0x00
+#define CC11XL_MARC_IDLE                0x01
+#define CC11XL_MARC_RX                  0x0D
+#define CC11XL_MARC_RXFIFO_OVERFLOW     0x11
+#define CC11XL_MARC_FSTXON              0x12
+#define CC11XL_MARC_TX                  0x13
+#define CC11XL_MARC_RXTX_SWITCH         0x15
+#define CC11XL_MARC_TXFIFO_UNDERFLOW    0x16
+#define CC11XL_MARC_STATE_BM            0x1F
+
+/* MCSM1 RXOFF_MODE and TXOFF_MODE fields */
+#define CC11XL_MCSM1_RXOFF_BM           0x0C
+#define CC11XL_MCSM1_TXOFF_BM           0x03
+#define CC11XL_MCSM1_RXOFF(mcsm1)       (((mcsm1) & CC11XL_MCSM1_RXOFF_BM) >> 2)
+#define CC11XL_MCSM1_TXOFF(mcsm1)       ((mcsm1) & CC11XL_MCSM1_TXOFF_BM)
+
+/* Modes for cc11xLRadioSetMode(), the state entered at the end of a packet */
+#define CC11XL_RADIO_MODE_IDLE          0x00  /* IDLE after RX and TX */
+#define CC11XL_RADIO_MODE_RX_CONT       0x0C  /* RX after RX, IDLE after TX */
+#define CC11XL_RADIO_MODE_TX_LISTEN     0x0F  /* RX after RX and TX */
+
+/******************************************************************************
+ * PROTOTYPES
+ */
+void       cc11xLRadioSetMode(uint8 mode);
+rfStatus_t cc11xLRadioRx(void);
+rfStatus_t cc11xLRadioTx(void);
+rfStatus_t cc11xLRadioIdle(void);
+void       cc11xLRadioPacketEnd(void);
+uint8      cc11xLRadioGetState(void);
+uint8      cc11xLRadioReadState(void);
+
+/* Operations */
+rfStatus_t cc11xLRadioRxContinuous(void);
+rfStatus_t cc11xLRadioTxThenListen(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_RADIO_H
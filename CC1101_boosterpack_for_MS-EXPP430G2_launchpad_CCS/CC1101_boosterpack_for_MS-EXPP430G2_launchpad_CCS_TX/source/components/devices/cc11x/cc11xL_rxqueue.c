@@ -0,0 +1,287 @@
+/******************************************************************************
+    Filename: cc11xL_rxqueue.c
+
+    Description: RX frame queue. With hardware filtering (cc11xL_filter.c)
+                 each GDO edge stands for one complete frame in the RX FIFO,
+                 so the interrupt can read it at once, into a block from
+                 cc11xL_pool.c, and queue the block in the next free entry
+                 of a ring; the radio goes on receiving. The main loop takes
+                 the entries in batches when it gets to them; frames
+                 arriving while it is busy wait in the pool instead of in
+                 the RX FIFO, which holds one frame. Each block taken goes
+                 to the main loop with its entry, to free when done with.
+
+                 The ring has one producer, cc11xLRxQueueFill() in the
+                 interrupt, and one consumer, the main loop. Only the
+                 producer writes the head index and only the consumer the
+                 tail, each with a single 16 bit store, which the MSP430
+                 does in one instruction, so no interrupt lock is needed.
+                 An entry is written before the head moves past it, with a
+                 compiler barrier ahead of the volatile head store, and read
+                 by the main loop before the tail moves past it; the main
+                 loop's reads are made by the callers of the functions that
+                 move the tail, and are not moved across those calls.
+
+                 The interrupt uses the SPI only between
+                 cc11xLRxQueueStart() and cc11xLRxQueueStop(); the main loop
+                 must keep off the radio meanwhile, which CC11XL_SPI_CHECK
+                 builds assert, see cc11xL_spi.h. A frame arriving with
+                 the ring or the pool full, and a read error, flush the RX
+                 FIFO.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_rxqueue.h"
+#include "cc11xL_radio.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_mcu.h"
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static cc11xLRxQueueEntry_t rxqRing[CC11XL_RXQ_SIZE];
+static volatile uint16 rxqHead;   /* next entry filled, producer only */
+static volatile uint16 rxqTail;   /* next entry taken, consumer only */
+static volatile uint8  rxqActive; /* the interrupt reads the RX FIFO */
+static cc11xLRxQueueStats_t rxqStats;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static void cc11xLRxQueueTake(void);
+static void cc11xLRxQueueFlush(void);
+
+/******************************************************************************
+ * @fn          cc11xLRxQueueStart
+ *
+ * @brief       Enters RX with the GDO set by cc11xLFilterRxStart(), frames
+ *              limited to CC11XL_POOL_MAX_LEN, and hands the RX FIFO to the
+ *              interrupt. A radio not in RX has its RX FIFO flushed first:
+ *              a frame left there would keep the GDO asserted and never
+ *              give an edge. Call with the filter set, cc11xLFilterSet().
+ *
+ * input parameters
+ *
+ * @param       iocfgAddr - CC110L_IOCFG0 or CC110L_IOCFG2, the GDO whose
+ *                          falling edge calls cc11xLRxQueueFill()
+ * @param       wake      - CC11XL_FILTER_WAKE_GOOD or CC11XL_FILTER_WAKE_END
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLRxQueueStart(uint8 iocfgAddr, uint8 wake)
+{
+  if(cc11xLRadioGetState() != CC11XL_MARC_RX)
+  {
+    cc11xLRadioIdle();
+    cc11xLSpiCmdStrobe(CC110L_SFRX);
+  }
+  cc11xLFilterRxStart(iocfgAddr, wake, CC11XL_POOL_MAX_LEN);
+  CC11XL_SPI_ISR_OWNED(TRUE);
+  rxqActive = TRUE;
+}
+
+/******************************************************************************
+ * @fn          cc11xLRxQueueStop
+ *
+ * @brief       Takes the radio back from the interrupt, e.g. to send, and
+ *              puts back the GDO setting with cc11xLFilterRxEnd(). The radio
+ *              is left in RX; entries queued stay for the main loop.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLRxQueueStop(void)
+{
+  rxqActive = FALSE;
+  CC11XL_SPI_ISR_OWNED(FALSE);
+  cc11xLFilterRxEnd();
+}
+
+/******************************************************************************
+ * @fn          cc11xLRxQueueFill
+ *
+ * @brief       Producer: call from the GDO interrupt. Reads the frame at the
+ *              head of the RX FIFO into a pool block and publishes it in
+ *              the next free entry, or queues a dropped frame with
+ *              CC11XL_FILTER_WAKE_END.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      TRUE if the edge was taken, FALSE if the queue is stopped
+ *              and the edge is for the caller, e.g. the end of a packet
+ *              sent
+ */
+uint8 cc11xLRxQueueFill(void)
+{
+  if(!rxqActive)
+  {
+    return (FALSE);
+  }
+  // the interrupt's own SPI accesses
+  CC11XL_SPI_ISR_OWNED(FALSE);
+  cc11xLRxQueueTake();
+  CC11XL_SPI_ISR_OWNED(TRUE);
+  return (TRUE);
+}
+
+/******************************************************************************
+ * @fn          cc11xLRxQueueCount
+ *
+ * @brief       Consumer: returns the number of entries waiting, the batch
+ *              to take before looking again.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      entries waiting
+ */
+uint8 cc11xLRxQueueCount(void)
+{
+  return ((uint8)(rxqHead - rxqTail));
+}
+
+/******************************************************************************
+ * @fn          cc11xLRxQueuePeek
+ *
+ * @brief       Consumer: returns the oldest entry, which stays valid until
+ *              cc11xLRxQueueRelease(). Its block, if any, is the caller's
+ *              from here on, to free with cc11xLPoolFree(); it may be kept
+ *              after the entry is released.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      the entry, NULL if the queue is empty
+ */
+const cc11xLRxQueueEntry_t *cc11xLRxQueuePeek(void)
+{
+  uint16 tail = rxqTail;
+
+  if(rxqHead == tail)
+  {
+    return (NULL);
+  }
+  return (&rxqRing[tail & (CC11XL_RXQ_SIZE - 1)]);
+}
+
+/******************************************************************************
+ * @fn          cc11xLRxQueueRelease
+ *
+ * @brief       Consumer: hands the oldest entry back to the producer.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLRxQueueRelease(void)
+{
+  uint16 tail = rxqTail;
+
+  if(rxqHead != tail)
+  {
+    rxqTail = tail + 1;
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLRxQueueGetStats
+ *
+ * @brief       Returns the queue counters. They change under the main loop,
+ *              read them as a snapshot.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      the counters
+ */
+const cc11xLRxQueueStats_t *cc11xLRxQueueGetStats(void)
+{
+  return (&rxqStats);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* Reads the frame at the head of the RX FIFO into the next free entry and
+ * publishes it, or flushes the RX FIFO
+ */
+static void cc11xLRxQueueTake(void)
+{
+  cc11xLRxQueueEntry_t *pEntry;
+  uint16 head  = rxqHead;
+  uint8  depth = (uint8)(head - rxqTail);
+
+  if(depth >= CC11XL_RXQ_SIZE)
+  {
+    rxqStats.overruns++;
+    cc11xLRxQueueFlush();
+    return;
+  }
+
+  pEntry = &rxqRing[head & (CC11XL_RXQ_SIZE - 1)];
+  pEntry->buf = cc11xLPoolAlloc();
+  if(pEntry->buf == CC11XL_POOL_NONE)
+  {
+    rxqStats.overruns++;
+    cc11xLRxQueueFlush();
+    return;
+  }
+  pEntry->status = cc11xLFilterRxRead(cc11xLPoolData(pEntry->buf), &pEntry->packet);
+  if(pEntry->status != CC11XL_FILTER_FRAME)
+  {
+    cc11xLPoolFree(pEntry->buf);
+    pEntry->buf = CC11XL_POOL_NONE;
+  }
+  if(pEntry->status == CC11XL_FILTER_ERROR)
+  {
+    rxqStats.errors++;
+    cc11xLRxQueueFlush();
+    return;
+  }
+  rxqStats.queued++;
+  if(depth >= rxqStats.maxDepth)
+  {
+    rxqStats.maxDepth = depth + 1;
+  }
+  // publish the entry: its stores are made before the head store
+  HAL_MCU_COMPILER_BARRIER();
+  rxqHead = head + 1;
+}
+
+/* Drops what the RX FIFO holds and goes back to RX */
+static void cc11xLRxQueueFlush(void)
+{
+  cc11xLRadioIdle();
+  cc11xLSpiCmdStrobe(CC110L_SFRX);
+  cc11xLRadioRx();
+}
@@ -13,6 +13,58 @@
 #include "cc11xL_spi.h"
 
 #include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_mcu.h"
+#ifdef CC11XL_SPI_CHECK
+#include "hal_assert.h"
+#endif
+
+/******************************************************************************
+ * MACROS
+ */
+/* Run FIFO bursts at CC11XL_FIFO_SYSCLK and restore the previous clock after */
+#ifdef CC11XL_FIFO_SYSCLK
+#define FIFO_CLOCK_UP(len, save)  st( (save) = halMcuGetSystemClock(); \
+                                      if((len) >= CC11XL_FIFO_SYSCLK_MIN_LEN) \
+                                      { halMcuSetSystemClock(CC11XL_FIFO_SYSCLK); } )
+#define FIFO_CLOCK_RESTORE(save)  halMcuSetSystemClock(save)
+#else
+#define FIFO_CLOCK_UP(len, save)  st( (save) = 0; )
+#define FIFO_CLOCK_RESTORE(save)  ((void)(save))
+#endif
+
+/* Asserts that the SPI is not owned by the radio interrupt, see
+ * cc11xLSpiSetIsrOwned()
+ */
+#ifdef CC11XL_SPI_CHECK
+#define SPI_CHECK_OWNER()         HAL_ASSERT(!cc11xLSpiIsrOwned)
+#else
+#define SPI_CHECK_OWNER()
+#endif
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+#ifdef CC11XL_FIFO_SYSCLK
+static uint16 cc11xLSegLen(const trxSpiSeg_t *pSegs, uint8 numSegs);
+#endif
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Bytes moved by each burst of cc11xLSpiTraceBench(), the FIFO size */
+#define SPI_BENCH_LEN             64
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+/* Chip status byte returned by the last access made through this driver */
+static rfStatus_t cc11xLStatus;
+
+#ifdef CC11XL_SPI_CHECK
+/* Set while the radio interrupt owns the SPI and is not using it */
+static volatile uint8 cc11xLSpiIsrOwned;
+#endif
 
 /******************************************************************************
  * @fn          cc11xLSpiReadReg
@@ -33,7 +85,9 @@
 rfStatus_t cc11xLSpiReadReg(uint8 addr, uint8 *pData, uint8 len)
 {
   uint8 rc;
+  SPI_CHECK_OWNER();
   rc = trx8BitRegAccess((RADIO_BURST_ACCESS|RADIO_READ_ACCESS), addr, pData, len);
+  cc11xLStatus = rc;
   return (rc);
 }  
 
@@ -56,7 +110,9 @@ rfStatus_t cc11xLSpiReadReg(uint8 addr, uint8 *pData, uint8 len)
 rfStatus_t cc11xLSpiWriteReg(uint8 addr, uint8 *pData, uint8 len)
 {
   uint8 rc;
+  SPI_CHECK_OWNER();
   rc = trx8BitRegAccess((RADIO_BURST_ACCESS|RADIO_WRITE_ACCESS),addr, pData, len);
+  cc11xLStatus = rc;
   return (rc);
 }
 
@@ -77,7 +133,12 @@ rfStatus_t cc11xLSpiWriteReg(uint8 addr, uint8 *pData, uint8 len)
 rfStatus_t cc11xLSpiWriteTxFifo(uint8 *pData, uint8 len)
 {
   uint8 rc;
+  uint8 sysClk;
+  SPI_CHECK_OWNER();
+  FIFO_CLOCK_UP(len, sysClk);
   rc = trx8BitRegAccess((RADIO_BURST_ACCESS|RADIO_WRITE_ACCESS),CC11xL_FIFO, pData, len);
+  cc11xLStatus = rc;
+  FIFO_CLOCK_RESTORE(sysClk);
   return (rc);
 }
 
@@ -99,10 +160,71 @@ rfStatus_t cc11xLSpiWriteTxFifo(uint8 *pData, uint8 len)
 rfStatus_t cc11xLSpiReadRxFifo(uint8 *pData, uint8 len)
 {
   uint8 rc;
+  uint8 sysClk;
+  SPI_CHECK_OWNER();
+  FIFO_CLOCK_UP(len, sysClk);
   rc = trx8BitRegAccess((RADIO_BURST_ACCESS|RADIO_READ_ACCESS),CC11xL_FIFO, pData, len);
+  cc11xLStatus = rc;
+  FIFO_CLOCK_RESTORE(sysClk);
   return (rc);
 }  
 
+/******************************************************************************
+ * @fn          cc11xLSpiWriteTxFifoGather
+ *
+ * @brief       Writes a list of segments to the TX FIFO in one burst, e.g.
+ *              length byte, header, payload and trailer from where they are
+ *              kept, instead of staging the frame in one buffer first.
+ *
+ * input parameters
+ *
+ * @param       *pSegs  - segments written in order
+ * @param       numSegs - number of segments
+ *
+ * output parameters
+ *
+ * @return      rfStatus_t
+ */
+rfStatus_t cc11xLSpiWriteTxFifoGather(const trxSpiSeg_t *pSegs, uint8 numSegs)
+{
+  uint8 rc;
+  uint8 sysClk;
+  SPI_CHECK_OWNER();
+  FIFO_CLOCK_UP(cc11xLSegLen(pSegs, numSegs), sysClk);
+  rc = trx8BitRegAccessSg(RADIO_WRITE_ACCESS, CC11xL_FIFO, pSegs, numSegs);
+  cc11xLStatus = rc;
+  FIFO_CLOCK_RESTORE(sysClk);
+  return (rc);
+}
+
+/******************************************************************************
+ * @fn          cc11xLSpiReadRxFifoScatter
+ *
+ * @brief       Reads the RX FIFO in one burst, splitting the bytes across a
+ *              list of segments, e.g. header, payload and the two appended
+ *              status bytes into separate destinations.
+ *
+ * input parameters
+ *
+ * @param       *pSegs  - segments filled in order
+ * @param       numSegs - number of segments
+ *
+ * output parameters
+ *
+ * @return      rfStatus_t
+ */
+rfStatus_t cc11xLSpiReadRxFifoScatter(const trxSpiSeg_t *pSegs, uint8 numSegs)
+{
+  uint8 rc;
+  uint8 sysClk;
+  SPI_CHECK_OWNER();
+  FIFO_CLOCK_UP(cc11xLSegLen(pSegs, numSegs), sysClk);
+  rc = trx8BitRegAccessSg(RADIO_READ_ACCESS, CC11xL_FIFO, pSegs, numSegs);
+  cc11xLStatus = rc;
+  FIFO_CLOCK_RESTORE(sysClk);
+  return (rc);
+}
+
 /******************************************************************************
  * @fn      cc11xLGetTxStatus(void)
  *          
@@ -135,7 +257,7 @@ rfStatus_t cc11xLSpiReadRxFifo(uint8 *pData, uint8 len)
  */
 rfStatus_t cc11xLGetTxStatus(void)
 {
-    return(trxSpiCmdStrobe(CC11xL_SNOP));
+    return(cc11xLSpiCmdStrobe(CC11xL_SNOP));
 }
 
 /******************************************************************************
@@ -173,8 +295,190 @@ rfStatus_t cc11xLGetTxStatus(void)
  */
 rfStatus_t cc11xLGetRxStatus(void)
 {
-    return(trxSpiCmdStrobe(CC11xL_SNOP | RADIO_READ_ACCESS));
+    return(cc11xLSpiCmdStrobe(CC11xL_SNOP | RADIO_READ_ACCESS));
+}
+
+/******************************************************************************
+ * @fn          cc11xLSpiCmdStrobe
+ *
+ * @brief       Sends a command strobe and records the returned status byte.
+ *              Use instead of trxSpiCmdStrobe() to keep the cached status
+ *              current.
+ *
+ * input parameters
+ *
+ * @param       cmd - command strobe, RADIO_READ_ACCESS set to have the status
+ *                    byte report the RX FIFO instead of the TX FIFO
+ *
+ * output parameters
+ *
+ * @return      rfStatus_t
+ */
+rfStatus_t cc11xLSpiCmdStrobe(uint8 cmd)
+{
+  uint8 rc;
+  SPI_CHECK_OWNER();
+  rc = trxSpiCmdStrobe(cmd);
+  cc11xLStatus = rc;
+  return (rc);
+}
+
+/******************************************************************************
+ * @fn          cc11xLGetCachedStatus
+ *
+ * @brief       Returns the chip status byte of the last access made through
+ *              this driver without touching the SPI bus. Decode it with
+ *              CC11XL_STATUS_STATE() and CC11XL_STATUS_FIFO_BYTES(). The FIFO
+ *              count refers to the RX FIFO after a read access and to free
+ *              space in the TX FIFO after a write access, saturating at 15.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      rfStatus_t
+ */
+rfStatus_t cc11xLGetCachedStatus(void)
+{
+  return (cc11xLStatus);
+}
+
+/******************************************************************************
+ * @fn          cc11xLGetRxFifoBytes
+ *
+ * @brief       Returns the number of bytes in the RX FIFO with as few SPI
+ *              accesses as possible. One SNOP gives state and fill level;
+ *              the count is taken from it when the radio has left RX (the
+ *              FIFO is then stable) and fewer than 15 bytes are waiting.
+ *              Otherwise RXBYTES is read, twice in a row until stable while
+ *              the radio is still receiving (see errata note above).
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      number of bytes in the RX FIFO
+ */
+uint8 cc11xLGetRxFifoBytes(void)
+{
+  uint8 rxBytes;
+  uint8 rxBytesVerify;
+  rfStatus_t status;
+
+  status = cc11xLGetRxStatus();
+  if(CC11XL_STATUS_STATE(status) != CC110L_STATE_RX)
+  {
+    if(CC11XL_STATUS_FIFO_BYTES(status) < STATUS_FIFO_BYTES_AVAILABLE_BM)
+    {
+      return (CC11XL_STATUS_FIFO_BYTES(status));
+    }
+    cc11xLSpiReadReg(CC110L_RXBYTES, &rxBytes, 1);
+    return (rxBytes & CC11XL_NUM_RXBYTES_BM);
+  }
+
+  cc11xLSpiReadReg(CC110L_RXBYTES, &rxBytesVerify, 1);
+  do
+  {
+    rxBytes = rxBytesVerify;
+    cc11xLSpiReadReg(CC110L_RXBYTES, &rxBytesVerify, 1);
+  }
+  while(rxBytes != rxBytesVerify);
+  return (rxBytes & CC11XL_NUM_RXBYTES_BM);
+}
+
+#ifdef TRX_SPI_TRACE
+/******************************************************************************
+ * @fn          cc11xLSpiTraceBench
+ *
+ * @brief       Measures the SPI throughput at the current system clock: fills
+ *              the TX FIFO with one 64 byte burst, and reads 64 bytes from
+ *              the empty RX FIFO in another. Both show in the transaction
+ *              trace with their duration; 64 * SMCLK / duration gives the
+ *              bytes/s, to compare e.g. against a build with
+ *              TRX_SPI_PIPELINE_MIN_BR set above every prescaler. Both FIFOs
+ *              are flushed after. Call with the radio in IDLE, as the
+ *              flushes need it.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLSpiTraceBench(void)
+{
+  uint8 buf[SPI_BENCH_LEN];
+  uint8 i;
+
+  for(i = 0; i < SPI_BENCH_LEN; i++)
+  {
+    buf[i] = i;
+  }
+  cc11xLSpiWriteTxFifo(buf, SPI_BENCH_LEN);
+  cc11xLSpiCmdStrobe(CC110L_SFTX);
+  // underflows the RX FIFO, which the flush clears
+  cc11xLSpiReadRxFifo(buf, SPI_BENCH_LEN);
+  cc11xLSpiCmdStrobe(CC110L_SFRX);
+}
+#endif
+
+#ifdef CC11XL_SPI_CHECK
+/******************************************************************************
+ * @fn          cc11xLSpiSetIsrOwned
+ *
+ * @brief       Marks the SPI as owned by the radio interrupt, so that an
+ *              access from the main loop fails HAL_ASSERT(). Called by
+ *              cc11xL_rxqueue.c when it starts and stops, and around the
+ *              accesses of the interrupt itself.
+ *
+ * input parameters
+ *
+ * @param       owned - TRUE while the main loop must keep off the SPI
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLSpiSetIsrOwned(uint8 owned)
+{
+  cc11xLSpiIsrOwned = owned;
+}
+#endif
+
+#ifdef CC11XL_FIFO_SYSCLK
+/******************************************************************************
+ * @fn          cc11xLSegLen
+ *
+ * @brief       Total length of a segment list, to decide on raising the
+ *              clock for the burst.
+ *
+ * input parameters
+ *
+ * @param       *pSegs  - segment list
+ * @param       numSegs - number of segments
+ *
+ * output parameters
+ *
+ * @return      number of bytes
+ */
+static uint16 cc11xLSegLen(const trxSpiSeg_t *pSegs, uint8 numSegs)
+{
+  uint16 len = 0;
+
+  while(numSegs--)
+  {
+    len += pSegs->len;
+    pSegs++;
+  }
+  return (len);
 }
+#endif
 
 /******************************************************************************
   Copyright 2011 Texas Instruments Incorporated. All rights reserved.
@@ -23,6 +23,14 @@ extern "C" {
 /******************************************************************************
  * CONSTANTS
  */
+/* FIFO bursts of at least CC11XL_FIFO_SYSCLK_MIN_LEN bytes are run with the
+ * system clock raised to CC11XL_FIFO_SYSCLK (a HAL_MCU_SYSCLK_xMHZ value) when
+ * that is defined in the build settings, e.g. CC11XL_FIFO_SYSCLK=4 for 16 MHz.
+ */
+#ifndef CC11XL_FIFO_SYSCLK_MIN_LEN
+#define CC11XL_FIFO_SYSCLK_MIN_LEN  8
+#endif
+
 /* Register addresses for CC110L */
 #define CC110L_IOCFG2           0x00      /*  IOCFG2        - GDO2 output pin configuration  */
 #define CC110L_IOCFG1           0x01      /*  IOCFG1        - GDO1 output pin configuration  */
@@ -205,6 +213,8 @@ extern "C" {
 /* Other register bit fields */
 #define CC110L_CRC_OK_BM            0x80
 #define CC113L_CRC_OK_BM            0x80
+#define CC11XL_RXFIFO_OVERFLOW_BM   0x80      /*  RXBYTES / TXBYTES overflow flag */
+#define CC11XL_NUM_RXBYTES_BM       0x7F
 
 /* CC11xL Command strobe register*/
 #define CC11xL_SNOP                     0x3D      /*  SNOP    - No operation. Returns status byte. */
@@ -273,6 +283,13 @@ extern "C" {
 
 
 
+/******************************************************************************
+ * MACROS
+ */
+/* Decode a chip status byte, e.g. the one from cc11xLGetCachedStatus() */
+#define CC11XL_STATUS_STATE(status)       ((status) & STATUS_STATE_BM)
+#define CC11XL_STATUS_FIFO_BYTES(status)  ((status) & STATUS_FIFO_BYTES_AVAILABLE_BM)
+
 /******************************************************************************
  * TYPEDEFS
  */
@@ -290,7 +307,31 @@ rfStatus_t cc11xLGetTxStatus(void);
 rfStatus_t cc11xLGetRxStatus(void);                                                                        
 rfStatus_t cc11xLSpiReadReg(uint8 addr, uint8 *pData, uint8 len);  
 rfStatus_t cc11xLSpiWriteTxFifo(uint8 *pData, uint8 len);
-rfStatus_t cc11xLSpiReadRxFifo(uint8 *pData, uint8 len);  
+rfStatus_t cc11xLSpiReadRxFifo(uint8 *pData, uint8 len);
+rfStatus_t cc11xLSpiWriteTxFifoGather(const trxSpiSeg_t *pSegs, uint8 numSegs);
+rfStatus_t cc11xLSpiReadRxFifoScatter(const trxSpiSeg_t *pSegs, uint8 numSegs);
+rfStatus_t cc11xLSpiCmdStrobe(uint8 cmd);
+
+/* Status tracking from the chip status byte */
+rfStatus_t cc11xLGetCachedStatus(void);
+uint8      cc11xLGetRxFifoBytes(void);  
+
+/* 64 byte FIFO bursts timed in the transaction trace */
+#ifdef TRX_SPI_TRACE
+void       cc11xLSpiTraceBench(void);
+#endif
+
+/* Debug check of the rule in cc11xL_rxqueue.h: while the radio interrupt
+ * owns the SPI, the main loop makes no access. Build with CC11XL_SPI_CHECK
+ * to have every access above HAL_ASSERT() it; the queue marks the SPI owned
+ * from start to stop, except while the interrupt itself uses it.
+ */
+#ifdef CC11XL_SPI_CHECK
+void       cc11xLSpiSetIsrOwned(uint8 owned);
+#define CC11XL_SPI_ISR_OWNED(owned)  cc11xLSpiSetIsrOwned(owned)
+#else
+#define CC11XL_SPI_ISR_OWNED(owned)
+#endif
          
 
 
@@ -0,0 +1,518 @@
+/******************************************************************************
+    Filename: cc11xL_stream.c  
+    
+    Description: streaming transmitter and receiver for frames longer than
+                 the 64 byte FIFOs.
+
+                 TX: the FIFO is loaded before STX and topped up each time
+                 it drains below the FIFO_THR threshold, signalled on a GDO
+                 pin, so the frame goes out without gaps. Frames of more
+                 than 255 bytes are started in infinite length mode with
+                 PKTLEN set to the length modulo 256, and switched to fixed
+                 length mode once fewer than 256 bytes remain on air, so the
+                 packet ends (and the CRC is appended) at the right byte.
+
+                 RX (variable length mode): the GDO signals the RX FIFO
+                 threshold, set to 4 bytes until the length byte is in (or
+                 the end of a shorter packet), then to the FIFO_THR the
+                 application configured. Each time the FIFO drains all but
+                 one byte, as it must not be emptied before the end of the
+                 packet. When the rest of the frame no longer reaches the
+                 threshold the GDO is switched to signal the end of the
+                 packet, and the rest is read then.
+                 
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include "cc11xL_stream.h"
+#include "cc11xL_config.h"
+#include "cc11xL_radio.h"
+
+#include "hal_types.h"
+#include "hal_defs.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* RX threshold until the length byte is known, FIFO_THR = 0 */
+#define STREAM_RX_HDR_FIFO_THR  0x00
+
+/* Receiver stages */
+#define STREAM_RX_HEADER        0   /* waiting for the length byte */
+#define STREAM_RX_BODY          1   /* draining on the RX FIFO threshold */
+#define STREAM_RX_TAIL          2   /* waiting for the end of the packet */
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8  streamTxSaved;
+static cc11xLStreamFill_t streamFill;
+static uint16 streamLen;
+static uint16 streamWritten;
+static uint8  streamIocfgAddr;
+static uint8  streamInfinite;
+/* Settings found at start, put back by cc11xLStreamTxEnd() */
+static uint8  streamIocfg;
+static uint8  streamPktctrl0;
+static uint8  streamPktlen;
+
+static uint8  streamRxSaved;
+static cc11xLStreamDrain_t streamDrain;
+static uint8  streamRxStage;
+static uint8  streamRxIocfgAddr;
+static uint8  streamRxMaxLen;
+static uint8  streamRxLen;
+static uint16 streamRxRead;         /* bytes read after the length byte */
+static uint8  streamRxStatus[2];    /* appended RSSI and LQI / CRC_OK */
+/* Settings found at start, put back by cc11xLStreamRxEnd() */
+static uint8  streamRxIocfg;
+static uint8  streamRxFifothr;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static uint8 cc11xLGetTxFifoBytes(void);
+static void  cc11xLStreamRxRead(uint8 count);
+
+/******************************************************************************
+ * @fn          cc11xLStreamTxStart
+ *
+ * @brief       Sets up the length mode for a frame of len bytes, loads as
+ *              much of it as fits into the TX FIFO and strobes STX. If more
+ *              is left, the GDO at iocfgAddr is switched to signal the TX
+ *              FIFO threshold; call cc11xLStreamTxRefill() on each falling
+ *              edge of it until the frame is complete.
+ *
+ *              The frame is sent as written: in fixed or infinite length
+ *              mode the radio adds no length byte of its own.
+ *
+ * input parameters
+ *
+ * @param       iocfgAddr - CC110L_IOCFG0 or CC110L_IOCFG2, the GDO whose
+ *                          interrupt is serviced
+ * @param       len       - frame length in bytes
+ * @param       pfnFill   - writes frame bytes to the TX FIFO
+ *
+ * output parameters
+ *
+ * @return      CC11XL_STREAM_BUSY or CC11XL_STREAM_DONE
+ */
+uint8 cc11xLStreamTxStart(uint8 iocfgAddr, uint16 len, cc11xLStreamFill_t pfnFill)
+{
+  uint8 status = cc11xLStreamTxLoad(iocfgAddr, len, pfnFill);
+
+  cc11xLRadioTx();
+  return (status);
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamTxLoad
+ *
+ * @brief       As cc11xLStreamTxStart(), but leaves the STX strobe to the
+ *              caller, e.g. to send only once the channel is clear (see
+ *              cc11xLLbtTx()). Refills start with the first falling edge
+ *              of the GDO, once the frame is on air.
+ *
+ * input parameters
+ *
+ * @param       iocfgAddr - CC110L_IOCFG0 or CC110L_IOCFG2, the GDO whose
+ *                          interrupt is serviced
+ * @param       len       - frame length in bytes
+ * @param       pfnFill   - writes frame bytes to the TX FIFO
+ *
+ * output parameters
+ *
+ * @return      CC11XL_STREAM_BUSY or CC11XL_STREAM_DONE
+ */
+uint8 cc11xLStreamTxLoad(uint8 iocfgAddr, uint16 len, cc11xLStreamFill_t pfnFill)
+{
+  uint8 first = (len > CC11XL_FIFO_SIZE) ? CC11XL_FIFO_SIZE : (uint8)len;
+
+  streamFill      = pfnFill;
+  streamLen       = len;
+  streamIocfgAddr = iocfgAddr;
+  streamInfinite  = (len > 255);
+  if(!streamTxSaved)
+  {
+    streamIocfg    = cc11xLConfigGet(iocfgAddr);
+    streamPktctrl0 = cc11xLConfigGet(CC110L_PKTCTRL0);
+    streamPktlen   = cc11xLConfigGet(CC110L_PKTLEN);
+    streamTxSaved  = TRUE;
+  }
+
+  // the 8 bit packet byte counter ends the frame when it matches PKTLEN
+  cc11xLConfigSet(CC110L_PKTLEN, (uint8)len);
+  cc11xLConfigSet(CC110L_PKTCTRL0, (streamPktctrl0 & ~CC11XL_LENGTH_CONFIG_BM)
+                  | (streamInfinite ? CC11XL_LENGTH_INFINITE : CC11XL_LENGTH_FIXED));
+
+  (*streamFill)(0, first);
+  streamWritten = first;
+  if(streamWritten < streamLen)
+  {
+    cc11xLConfigSet(iocfgAddr, CC11XL_GDO_TXFIFO_THR);
+  }
+
+  return ((streamWritten < streamLen) ? CC11XL_STREAM_BUSY : CC11XL_STREAM_DONE);
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamTxRefill
+ *
+ * @brief       Tops the TX FIFO up with the next bytes of the frame. Called
+ *              when the threshold GDO falls: the FIFO is then below
+ *              FIFO_THR, and filling it to the top makes sure the pin rises
+ *              again before the next edge. Switches to fixed length mode once
+ *              fewer than 256 bytes remain on air. Before the last bytes are
+ *              written the GDO gets its setting back, e.g. to signal the end
+ *              of the packet.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      CC11XL_STREAM_BUSY, CC11XL_STREAM_DONE or CC11XL_STREAM_ERROR
+ */
+uint8 cc11xLStreamTxRefill(void)
+{
+  uint8  txBytes;
+  uint16 left;
+  uint8  count;
+
+  if(streamWritten >= streamLen)
+  {
+    return (CC11XL_STREAM_DONE);
+  }
+
+  txBytes = cc11xLGetTxFifoBytes();
+  if(txBytes & CC11XL_RXFIFO_OVERFLOW_BM)
+  {
+    cc11xLConfigSet(streamIocfgAddr, streamIocfg);
+    streamWritten = streamLen;
+    return (CC11XL_STREAM_ERROR);
+  }
+
+  // bytes on air = written - still in the FIFO
+  if(streamInfinite && (streamLen - (streamWritten - txBytes) < 256))
+  {
+    cc11xLConfigSet(CC110L_PKTCTRL0, (streamPktctrl0 & ~CC11XL_LENGTH_CONFIG_BM)
+                    | CC11XL_LENGTH_FIXED);
+    streamInfinite = FALSE;
+  }
+
+  left  = streamLen - streamWritten;
+  count = CC11XL_FIFO_SIZE - txBytes;
+  if(left < count)
+  {
+    count = (uint8)left;
+  }
+  streamWritten += count;
+  if(streamWritten == streamLen)
+  {
+    // before the last bytes go in, so no threshold edge follows the switch
+    cc11xLConfigSet(streamIocfgAddr, streamIocfg);
+  }
+  (*streamFill)(streamWritten - count, count);
+
+  return ((streamWritten < streamLen) ? CC11XL_STREAM_BUSY : CC11XL_STREAM_DONE);
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamTxEnd
+ *
+ * @brief       Puts back the GDO, PKTCTRL0 and PKTLEN settings found by
+ *              the first cc11xLStreamTxStart(). Call after the end of the packet when
+ *              going back to ordinary packet handling; an application that
+ *              only streams may leave the settings in place, which saves the
+ *              register writes on the next frame.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLStreamTxEnd(void)
+{
+  if(streamTxSaved)
+  {
+    cc11xLConfigSet(streamIocfgAddr, streamIocfg);
+    cc11xLConfigSet(CC110L_PKTCTRL0, streamPktctrl0);
+    cc11xLConfigSet(CC110L_PKTLEN, streamPktlen);
+    streamTxSaved = FALSE;
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamRxStart
+ *
+ * @brief       Sets the GDO at iocfgAddr to signal the RX FIFO threshold or
+ *              the end of the packet, active low, lowers the threshold to
+ *              4 bytes and enters RX, unless the radio is there already.
+ *              Call cc11xLStreamRxDrain() on each falling edge of the GDO
+ *              until the frame is read, then cc11xLStreamRxStart() again
+ *              for the next frame; with CC11XL_RADIO_MODE_RX_CONT set the
+ *              radio stays in RX in between. The packet must be in
+ *              variable length mode.
+ *
+ * input parameters
+ *
+ * @param       iocfgAddr - CC110L_IOCFG0 or CC110L_IOCFG2, the GDO whose
+ *                          interrupt is serviced on the falling edge
+ * @param       maxLen    - longest length byte accepted
+ * @param       pfnDrain  - reads payload bytes from the RX FIFO
+ *
+ * output parameters
+ *
+ * @return      status byte
+ */
+uint8 cc11xLStreamRxStart(uint8 iocfgAddr, uint8 maxLen, cc11xLStreamDrain_t pfnDrain)
+{
+  if(!streamRxSaved)
+  {
+    streamRxIocfg   = cc11xLConfigGet(iocfgAddr);
+    streamRxFifothr = cc11xLConfigGet(CC110L_FIFOTHR);
+    streamRxSaved   = TRUE;
+  }
+  streamDrain       = pfnDrain;
+  streamRxIocfgAddr = iocfgAddr;
+  streamRxMaxLen    = maxLen;
+  streamRxStage     = STREAM_RX_HEADER;
+  streamRxRead      = 0;
+
+  cc11xLConfigSet(CC110L_FIFOTHR, (streamRxFifothr & ~CC11XL_FIFO_THR_BM) | STREAM_RX_HDR_FIFO_THR);
+  cc11xLConfigSet(iocfgAddr, CC11XL_GDO_RXFIFO_THR_EOP | CC11XL_GDO_INV);
+  return (cc11xLRadioRx());
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamRxDrain
+ *
+ * @brief       Reads what has arrived of the frame, all but the last byte in
+ *              the RX FIFO unless the frame is complete. The first call
+ *              takes the length byte, raises the threshold back to FIFO_THR
+ *              and lets the GDO signal only the threshold. Once the rest of
+ *              the frame is shorter than the threshold, the GDO is switched
+ *              to signal the end of the packet; the FIFO is checked again
+ *              after the switch, in case the packet ended before it. A call
+ *              without a threshold or end of packet behind it (a stale
+ *              edge) returns BUSY. The end of the frame is passed on to
+ *              cc11xLRadioPacketEnd().
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      CC11XL_STREAM_BUSY, CC11XL_STREAM_DONE or CC11XL_STREAM_ERROR
+ */
+uint8 cc11xLStreamRxDrain(void)
+{
+  uint8  rxBytes;
+  uint16 left;
+
+  rxBytes = cc11xLGetRxFifoBytes();
+  if(streamRxStage == STREAM_RX_HEADER)
+  {
+    // nothing in yet, or too little to read while still receiving
+    if((rxBytes == 0)
+       || ((rxBytes < CC11XL_RX_THR_BYTES(STREAM_RX_HDR_FIFO_THR))
+           && (CC11XL_STATUS_STATE(cc11xLGetCachedStatus()) == CC110L_STATE_RX)))
+    {
+      return ((CC11XL_STATUS_STATE(cc11xLGetCachedStatus()) == CC110L_STATE_RXFIFO_ERROR)
+              ? CC11XL_STREAM_ERROR : CC11XL_STREAM_BUSY);
+    }
+    cc11xLSpiReadRxFifo(&streamRxLen, 1);
+    rxBytes--;
+    if(streamRxLen > streamRxMaxLen)
+    {
+      return (CC11XL_STREAM_ERROR);
+    }
+    // frames that never reach FIFO_THR go straight to the end of packet
+    if((uint16)streamRxLen + 2 >= CC11XL_RX_THR_BYTES(streamRxFifothr))
+    {
+      cc11xLConfigSet(CC110L_FIFOTHR, streamRxFifothr);
+    }
+    streamRxStage = STREAM_RX_BODY;
+  }
+
+  for(;;)
+  {
+    if(CC11XL_STATUS_STATE(cc11xLGetCachedStatus()) == CC110L_STATE_RXFIFO_ERROR)
+    {
+      return (CC11XL_STREAM_ERROR);
+    }
+
+    // payload and the 2 appended status bytes
+    left = (uint16)streamRxLen + 2 - streamRxRead;
+    if(rxBytes >= left)
+    {
+      cc11xLStreamRxRead((uint8)left);
+      cc11xLRadioPacketEnd();
+      return (CC11XL_STREAM_DONE);
+    }
+    if(rxBytes > 1)
+    {
+      cc11xLStreamRxRead(rxBytes - 1);
+      left -= rxBytes - 1;
+    }
+
+    // the threshold is reached again if the rest (and the byte left in the
+    // FIFO) make up FIFO_THR bytes, else wait for the end of the packet
+    if(streamRxStage == STREAM_RX_TAIL)
+    {
+      return (CC11XL_STREAM_BUSY);
+    }
+    if(left >= CC11XL_RX_THR_BYTES(streamRxFifothr))
+    {
+      cc11xLConfigSet(streamRxIocfgAddr, CC11XL_GDO_RXFIFO_THR | CC11XL_GDO_INV);
+      return (CC11XL_STREAM_BUSY);
+    }
+    cc11xLConfigSet(streamRxIocfgAddr, CC11XL_GDO_SYNC_EOP);
+    streamRxStage = STREAM_RX_TAIL;
+    rxBytes = cc11xLGetRxFifoBytes();
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamRxGetStatus
+ *
+ * @brief       Copies the 2 status bytes appended to the last frame: RSSI,
+ *              and LQI with CRC_OK in bit 7.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @param       pStatus - receives the 2 bytes
+ *
+ * @return      void
+ */
+void cc11xLStreamRxGetStatus(uint8 *pStatus)
+{
+  pStatus[0] = streamRxStatus[0];
+  pStatus[1] = streamRxStatus[1];
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamRxGetPacket
+ *
+ * @brief       Describes the last frame: its length and the link quality
+ *              appended to it. The payload went to the drain function, so
+ *              the payload pointer is NULL.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @param       pPacket - the descriptor
+ *
+ * @return      void
+ */
+void cc11xLStreamRxGetPacket(cc11xLPacket_t *pPacket)
+{
+  pPacket->pPayload = NULL;
+  pPacket->length   = streamRxLen;
+  cc11xLPacketSetStatus(pPacket, streamRxStatus);
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamRxEnd
+ *
+ * @brief       Puts back the GDO and FIFOTHR settings found by the first
+ *              cc11xLStreamRxStart(). Call with the radio out of RX.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void cc11xLStreamRxEnd(void)
+{
+  if(streamRxSaved)
+  {
+    cc11xLConfigSet(streamRxIocfgAddr, streamRxIocfg);
+    cc11xLConfigSet(CC110L_FIFOTHR, streamRxFifothr);
+    streamRxSaved = FALSE;
+  }
+}
+
+/******************************************************************************
+ * @fn          cc11xLGetTxFifoBytes
+ *
+ * @brief       Reads TXBYTES until two reads agree, as it may be updated by
+ *              the radio during the access (see cc11xLGetRxFifoBytes()).
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      TXBYTES, underflow flag and number of bytes in the TX FIFO
+ */
+static uint8 cc11xLGetTxFifoBytes(void)
+{
+  uint8 txBytes;
+  uint8 txBytesVerify;
+
+  cc11xLSpiReadReg(CC110L_TXBYTES, &txBytesVerify, 1);
+  do
+  {
+    txBytes = txBytesVerify;
+    cc11xLSpiReadReg(CC110L_TXBYTES, &txBytesVerify, 1);
+  }
+  while(txBytes != txBytesVerify);
+  return (txBytes);
+}
+
+/******************************************************************************
+ * @fn          cc11xLStreamRxRead
+ *
+ * @brief       Reads the next count bytes of the frame: payload bytes through
+ *              the drain function, the appended status bytes into
+ *              streamRxStatus.
+ *
+ * input parameters
+ *
+ * @param       count - number of bytes to read
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+static void cc11xLStreamRxRead(uint8 count)
+{
+  uint8 n;
+
+  if(streamRxRead < streamRxLen)
+  {
+    n = streamRxLen - (uint8)streamRxRead;
+    if(count < n)
+    {
+      n = count;
+    }
+    (*streamDrain)(streamRxLen, (uint8)streamRxRead, n);
+    streamRxRead += n;
+    count -= n;
+  }
+  if(count)
+  {
+    cc11xLSpiReadRxFifo(&streamRxStatus[streamRxRead - streamRxLen], count);
+    streamRxRead += count;
+  }
+}
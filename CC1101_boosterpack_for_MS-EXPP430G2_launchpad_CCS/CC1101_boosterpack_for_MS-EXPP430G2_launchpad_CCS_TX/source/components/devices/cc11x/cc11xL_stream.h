@@ -0,0 +1,81 @@
+/******************************************************************************
+    Filename: cc11xL_stream.h  
+    
+    Description: header file for sending and receiving frames longer than the
+                 CC11xL FIFOs by moving data while the frame is on air.
+                 
+*******************************************************************************/
+#ifndef CC11xL_STREAM_H
+#define CC11xL_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+#include "cc11xL_spi.h"
+#include "cc11xL_packet.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Return values of the TX and RX stream functions */
+#define CC11XL_STREAM_BUSY          0   /* bytes left, call again on the next GDO edge */
+#define CC11XL_STREAM_DONE          1   /* TX: whole frame in the FIFO, RX: frame read */
+#define CC11XL_STREAM_ERROR         2   /* FIFO underflow / overflow or bad length, flush */
+
+/* TX FIFO size and the PKTCTRL0 LENGTH_CONFIG field */
+#define CC11XL_FIFO_SIZE            64
+#define CC11XL_LENGTH_CONFIG_BM     0x03
+#define CC11XL_LENGTH_FIXED         0x00
+#define CC11XL_LENGTH_VARIABLE      0x01
+#define CC11XL_LENGTH_INFINITE      0x02
+
+/* FIFOTHR FIFO_THR field, RX threshold 4 * (FIFO_THR + 1) bytes */
+#define CC11XL_FIFO_THR_BM          0x0F
+#define CC11XL_RX_THR_BYTES(fifothr) (4 * (((fifothr) & CC11XL_FIFO_THR_BM) + 1))
+
+/* GDOx_CFG settings */
+#define CC11XL_GDO_RXFIFO_THR       0x00  /* RX FIFO filled at or above FIFO_THR */
+#define CC11XL_GDO_RXFIFO_THR_EOP   0x01  /* as above, or end of packet until FIFO empty */
+#define CC11XL_GDO_TXFIFO_THR       0x02  /* TX FIFO filled at or above FIFO_THR */
+#define CC11XL_GDO_SYNC_EOP         0x06  /* sync word sent / received until end of packet */
+#define CC11XL_GDO_INV              0x40  /* active low output */
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* Writes count bytes of the frame, from offset on, to the TX FIFO, e.g. with
+ * cc11xLSpiWriteTxFifo(). Bytes can be produced as they are asked for, so
+ * the frame does not have to be held in RAM.
+ */
+typedef void (*cc11xLStreamFill_t)(uint16 offset, uint8 count);
+
+/* Reads count bytes of the payload of a length byte long frame, from offset
+ * on, from the RX FIFO, e.g. with cc11xLSpiReadRxFifo(). Called as the bytes
+ * arrive, so the first call, made a few bytes into the frame, already gets
+ * the first bytes of the payload.
+ */
+typedef void (*cc11xLStreamDrain_t)(uint8 length, uint8 offset, uint8 count);
+
+/******************************************************************************
+ * PROTOTYPES
+ */
+uint8 cc11xLStreamTxStart(uint8 iocfgAddr, uint16 len, cc11xLStreamFill_t pfnFill);
+uint8 cc11xLStreamTxLoad(uint8 iocfgAddr, uint16 len, cc11xLStreamFill_t pfnFill);
+uint8 cc11xLStreamTxRefill(void);
+void  cc11xLStreamTxEnd(void);
+
+uint8 cc11xLStreamRxStart(uint8 iocfgAddr, uint8 maxLen, cc11xLStreamDrain_t pfnDrain);
+uint8 cc11xLStreamRxDrain(void);
+void  cc11xLStreamRxGetStatus(uint8 *pStatus);
+void  cc11xLStreamRxGetPacket(cc11xLPacket_t *pPacket);
+void  cc11xLStreamRxEnd(void);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// CC11xL_STREAM_H
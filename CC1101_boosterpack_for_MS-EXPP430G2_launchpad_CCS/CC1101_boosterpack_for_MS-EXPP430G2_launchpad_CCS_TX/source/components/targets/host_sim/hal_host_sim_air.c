@@ -0,0 +1,411 @@
+/******************************************************************************
+    Filename: hal_host_sim_air.c
+
+    Description: Shared channel of the host simulation target. Besides the
+                 radio model the application drives, HOST_SIM_NODES - 1
+                 other nodes send frames of the same length on the channel.
+                 Each runs the channel access of cc11xL_lbt.c with the same
+                 constants: a random backoff of 0 to 2^BE - 1 slots, a slot
+                 for the RSSI to settle, a clear channel assessment, and BE
+                 raised on a busy channel. Their frames make the radio
+                 model's carrier sense busy, and the application's frames
+                 make theirs busy.
+
+                 Every frame on air is logged. Frames that overlap in time
+                 collide: none of them is taken as received. The report
+                 gives collisions and backoffs per side and the aggregate
+                 goodput of the channel.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_host_sim.h"
+#include "cc11xL_lbt.h"
+#include "cc11xL_profile.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+#define SIM_AIR_MAX_NODES     16
+#define SIM_AIR_LOG_SIZE      32
+
+/* Node states */
+#define SIM_NODE_WAIT         0   /* until the next frame is ready */
+#define SIM_NODE_BACKOFF      1   /* until the assessment */
+#define SIM_NODE_TX           2   /* until the end of the frame */
+
+/* The application's radio in the air log */
+#define SIM_NODE_APP          0
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+typedef struct
+{
+  uint8  state;
+  uint8  be;
+  uint8  backoffs;
+  uint8  logIndex;                /* frame on air */
+  uint32 dueUs;
+  uint32 sent;
+  uint32 collided;
+  uint32 busy;
+  uint32 dropped;
+}simNode_t;
+
+typedef struct
+{
+  uint32 startUs;
+  uint32 endUs;
+  uint16 len;
+  uint8  node;
+  uint8  collided;
+}simAirFrame_t;
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+/* Run control, see hal_host_sim.h */
+static uint8         simNodes = 1;
+static uint32        simNodePeriodUs;
+static uint8         simCsma  = TRUE;
+static uint16        simFrameLen;
+
+static simNode_t     simNode[SIM_AIR_MAX_NODES];
+static simAirFrame_t simAirLog[SIM_AIR_LOG_SIZE];
+static uint8         simAirNext;
+static uint64_t      simAirUs;
+static uint64_t      simGoodBytes;
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static void  halHostSimAirNode(cc110LSim_t *pSim, uint8 node);
+static void  halHostSimAirBackoff(simNode_t *pNode, uint32 nowUs);
+static uint8 halHostSimAirBusy(const cc110LSim_t *pSim, uint32 nowUs, uint8 node);
+static uint8 halHostSimAirLog(uint32 startUs, uint32 endUs, uint16 len, uint8 node);
+static void  halHostSimAirEnd(uint8 index);
+static uint16 halHostSimAirSlotUs(void);
+
+/******************************************************************************
+ * @fn          halHostSimAirInit
+ *
+ * @brief       Reads the channel settings. The other nodes get their first
+ *              frame at a random time within one frame period.
+ *
+ * input parameters
+ *
+ * @param       frameLen - length byte of the other nodes' frames
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimAirInit(uint8 frameLen)
+{
+  uint8 i;
+
+  simNodes        = (uint8)halHostSimEnv("HOST_SIM_NODES", simNodes);
+  simNodes        = (simNodes < 1) ? 1 : (simNodes > SIM_AIR_MAX_NODES) ? SIM_AIR_MAX_NODES : simNodes;
+  simNodePeriodUs = halHostSimEnv("HOST_SIM_NODE_PERIOD", 0) * 1000UL;
+  simCsma         = (uint8)halHostSimEnv("HOST_SIM_CSMA", simCsma);
+  simFrameLen     = (uint16)frameLen + 1;
+  for(i = 1; i < simNodes; i++)
+  {
+    simNode[i].state = SIM_NODE_WAIT;
+    simNode[i].dueUs = simNodePeriodUs ? (uint32)rand() % simNodePeriodUs : 0;
+  }
+}
+
+/******************************************************************************
+ * @fn          halHostSimAirRun
+ *
+ * @brief       Runs the other nodes up to the model time, in time order,
+ *              and sets the carrier sense of the radio model from their
+ *              frames on air. Call with the interrupt lock held, after the
+ *              radio model has advanced.
+ *
+ * input parameters
+ *
+ * @param       pSim - the radio model
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimAirRun(cc110LSim_t *pSim)
+{
+  uint8 next;
+  uint8 i;
+
+  if(simNodes < 2)
+  {
+    return;
+  }
+  for(;;)
+  {
+    next = SIM_NODE_APP;
+    for(i = 1; i < simNodes; i++)
+    {
+      if(((int32)(pSim->timeUs - simNode[i].dueUs) >= 0)
+         && ((next == SIM_NODE_APP) || ((int32)(simNode[next].dueUs - simNode[i].dueUs) > 0)))
+      {
+        next = i;
+      }
+    }
+    if(next == SIM_NODE_APP)
+    {
+      break;
+    }
+    halHostSimAirNode(pSim, next);
+  }
+  pSim->ccaBusy = halHostSimAirBusy(pSim, pSim->timeUs, SIM_NODE_APP);
+}
+
+/******************************************************************************
+ * @fn          halHostSimAirNodes
+ *
+ * @brief       Returns the number of nodes on the channel.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      nodes, this one included
+ */
+uint8 halHostSimAirNodes(void)
+{
+  return (simNodes);
+}
+
+/******************************************************************************
+ * @fn          halHostSimAirTxFrame
+ *
+ * @brief       Logs a frame the application's radio has finished sending
+ *              and checks it for collisions.
+ *
+ * input parameters
+ *
+ * @param       pSim - the radio model
+ * @param       len  - bytes sent, length byte included
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimAirTxFrame(cc110LSim_t *pSim, uint16 len)
+{
+  uint32 airUs;
+
+  if(simNodes < 2)
+  {
+    return;
+  }
+  airUs = cc11xLProfileAirTimeUs(len);
+  simNode[SIM_NODE_APP].sent++;
+  halHostSimAirEnd(halHostSimAirLog(pSim->timeUs - airUs, pSim->timeUs, len, SIM_NODE_APP));
+}
+
+/******************************************************************************
+ * @fn          halHostSimAirReport
+ *
+ * @brief       Prints the channel statistics of the run.
+ *
+ * input parameters
+ *
+ * @param       pSim - the radio model
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimAirReport(const cc110LSim_t *pSim)
+{
+  const cc11xLLbtStats_t *pLbt = cc11xLLbtGetStats();
+  simNode_t others = {0};
+  uint8     i;
+
+  if(pLbt->frames)
+  {
+    printf("lbt: %lu frames, %lu busy, %lu given up, %lu backoff slots of %u us\n",
+           (unsigned long)pLbt->frames, (unsigned long)pLbt->busy,
+           (unsigned long)pLbt->failures, (unsigned long)pLbt->backoffSlots,
+           cc11xLLbtGetSlotUs());
+  }
+  if(simNodes < 2)
+  {
+    return;
+  }
+  for(i = 1; i < simNodes; i++)
+  {
+    others.sent     += simNode[i].sent;
+    others.collided += simNode[i].collided;
+    others.busy     += simNode[i].busy;
+    others.dropped  += simNode[i].dropped;
+  }
+  printf("nodes: %u, %s; this node %lu sent, %lu collided; others %lu sent, %lu collided, "
+         "%lu busy, %lu given up\n", simNodes, simCsma ? "CSMA" : "no CCA",
+         (unsigned long)simNode[SIM_NODE_APP].sent, (unsigned long)simNode[SIM_NODE_APP].collided,
+         (unsigned long)others.sent, (unsigned long)others.collided,
+         (unsigned long)others.busy, (unsigned long)others.dropped);
+  if(pSim->timeUs)
+  {
+    printf("channel: %lu bit/s goodput, load %lu%%\n",
+           (unsigned long)(simGoodBytes * 8000000ULL / pSim->timeUs),
+           (unsigned long)(simAirUs * 100ULL / pSim->timeUs));
+  }
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+/* Next step of a node, at its due time */
+static void halHostSimAirNode(cc110LSim_t *pSim, uint8 node)
+{
+  simNode_t *pNode = &simNode[node];
+  uint32     nowUs = pNode->dueUs;
+  uint32     airUs;
+
+  switch(pNode->state)
+  {
+    case SIM_NODE_WAIT:
+      // a frame is ready
+      pNode->be       = CC11XL_LBT_MIN_BE;
+      pNode->backoffs = 0;
+      halHostSimAirBackoff(pNode, nowUs);
+      break;
+
+    case SIM_NODE_BACKOFF:
+      if(simCsma && halHostSimAirBusy(pSim, nowUs, node))
+      {
+        pNode->busy++;
+        if(++pNode->backoffs > CC11XL_LBT_MAX_BACKOFFS)
+        {
+          pNode->dropped++;
+          pNode->state = SIM_NODE_WAIT;
+          pNode->dueUs = nowUs + simNodePeriodUs;
+          break;
+        }
+        if(pNode->be < CC11XL_LBT_MAX_BE)
+        {
+          pNode->be++;
+        }
+        halHostSimAirBackoff(pNode, nowUs);
+        break;
+      }
+      // clear: on air after the turnaround
+      airUs           = cc11xLProfileAirTimeUs(simFrameLen);
+      nowUs          += CC11XL_LBT_TURNAROUND_US;
+      pNode->logIndex = halHostSimAirLog(nowUs, nowUs + airUs, simFrameLen, node);
+      pNode->state    = SIM_NODE_TX;
+      pNode->dueUs    = nowUs + airUs;
+      break;
+
+    case SIM_NODE_TX:
+      pNode->sent++;
+      halHostSimAirEnd(pNode->logIndex);
+      pNode->state = SIM_NODE_WAIT;
+      pNode->dueUs = nowUs + simNodePeriodUs;
+      break;
+  }
+}
+
+/* Random backoff, then a slot for the RSSI before the assessment */
+static void halHostSimAirBackoff(simNode_t *pNode, uint32 nowUs)
+{
+  uint16 slotUs = halHostSimAirSlotUs();
+
+  pNode->state = SIM_NODE_BACKOFF;
+  pNode->dueUs = nowUs + ((uint32)(rand() % (1 << pNode->be)) + 1) * slotUs;
+}
+
+/* Carrier sense of a node: a frame of another node on air */
+static uint8 halHostSimAirBusy(const cc110LSim_t *pSim, uint32 nowUs, uint8 node)
+{
+  uint8 i;
+
+  if((node != SIM_NODE_APP) && (pSim->marcState == CC110L_SIM_MARC_TX))
+  {
+    return (TRUE);
+  }
+  for(i = 0; i < SIM_AIR_LOG_SIZE; i++)
+  {
+    if((simAirLog[i].node != node) && (simAirLog[i].endUs != simAirLog[i].startUs)
+       && ((int32)(nowUs - simAirLog[i].startUs) >= 0) && ((int32)(simAirLog[i].endUs - nowUs) > 0))
+    {
+      return (TRUE);
+    }
+  }
+  return (FALSE);
+}
+
+static uint8 halHostSimAirLog(uint32 startUs, uint32 endUs, uint16 len, uint8 node)
+{
+  uint8 index = simAirNext;
+
+  simAirLog[index].startUs  = startUs;
+  simAirLog[index].endUs    = endUs;
+  simAirLog[index].len      = len;
+  simAirLog[index].node     = node;
+  simAirLog[index].collided = FALSE;
+  simAirNext = (simAirNext + 1) % SIM_AIR_LOG_SIZE;
+  return (index);
+}
+
+/* A frame has ended: marks it and every frame it overlapped as collided,
+ * and counts it. Frames logged later than it ended cannot overlap it. The
+ * application's frames are only logged at their end, so an overlapped frame
+ * may have been counted already, as good.
+ */
+static void halHostSimAirEnd(uint8 index)
+{
+  simAirFrame_t *pFrame = &simAirLog[index];
+  simAirFrame_t *pOther;
+  uint8 i;
+
+  for(i = 0; i < SIM_AIR_LOG_SIZE; i++)
+  {
+    pOther = &simAirLog[i];
+    if((i == index) || (pOther->endUs == pOther->startUs)
+       || ((int32)(pOther->startUs - pFrame->endUs) >= 0)
+       || ((int32)(pFrame->startUs - pOther->endUs) >= 0))
+    {
+      continue;
+    }
+    if(!pOther->collided && ((int32)(pFrame->endUs - pOther->endUs) >= 0))
+    {
+      simNode[pOther->node].collided++;
+      simGoodBytes -= pOther->len;
+    }
+    pOther->collided = TRUE;
+    pFrame->collided = TRUE;
+  }
+  simAirUs += pFrame->endUs - pFrame->startUs;
+  if(pFrame->collided)
+  {
+    simNode[pFrame->node].collided++;
+  }
+  else
+  {
+    simGoodBytes += pFrame->len;
+  }
+}
+
+/* The slot of cc11xL_lbt.c for the data rate in use */
+static uint16 halHostSimAirSlotUs(void)
+{
+  const cc11xLProfile_t *pProfile = cc11xLProfileGet();
+
+  return ((uint16)(CC11XL_LBT_TURNAROUND_US
+                   + (pProfile ? CC11XL_LBT_SLOT_BITS * 1000000UL / pProfile->dataRate : 0)));
+}
@@ -0,0 +1,265 @@
+/******************************************************************************
+    Filename: hal_host_sim_int_rf.c
+
+    Description: Radio interrupt interface of the host simulation target.
+                 Edges on the model's GDO outputs latch a flag per pin, as
+                 PxIFG does, and the connected ISR is run from
+                 halHostSimRfDispatch() while simulated interrupts are
+                 enabled.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include "msp430.h"
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_int_rf_msp_exp430g2.h"
+#include "hal_digio2.h"
+#include "hal_host_sim.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* GPIO_0/GPIO_2/GPIO_3 index the tables, GPIO_3 has no CC110L pin */
+#define RF_NUM_GPIO  4
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static ISR_FUNC_PTR rfIsr[RF_NUM_GPIO];
+static uint8        rfEdge[RF_NUM_GPIO];
+static uint8        rfEnabled[RF_NUM_GPIO];
+static uint8        rfPending[RF_NUM_GPIO];
+/* ISR runs, each a wake-up of the MCU on the target */
+static uint32       rfIsrRuns;
+
+/******************************************************************************
+ * GLOBAL VARIABLES
+ */
+/* Set by HAL_DIGIO2_WAKE_ON_EXIT() in an ISR, see hal_digio2.h */
+uint8 halDigio2WakeOnExit;
+
+/******************************************************************************
+ * @fn          trxIsrConnect
+ *
+ * @brief       Connects an ISR to a radio GPIO and selects the edge.
+ *
+ * input parameters
+ *
+ * @param       gpio - GPIO_0, GPIO_2 or GPIO_3
+ * @param       edge - RISING_EDGE or FALLING_EDGE
+ * @param       pF   - ISR
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxIsrConnect(uint8 gpio, uint8 edge, ISR_FUNC_PTR pF)
+{
+  if(gpio >= RF_NUM_GPIO)
+  {
+    gpio = GPIO_0;
+  }
+  halHostSimIntLock();
+  rfIsr[gpio]     = pF;
+  rfEdge[gpio]    = edge;
+  rfPending[gpio] = FALSE;
+  halHostSimIntUnlock();
+}
+
+/******************************************************************************
+ * @fn          trxClearIntFlag
+ *
+ * @brief       Clears the latched edge of a radio GPIO.
+ *
+ * input parameters
+ *
+ * @param       gpio - GPIO_0, GPIO_2 or GPIO_3
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxClearIntFlag(uint8 gpio)
+{
+  if(gpio < RF_NUM_GPIO)
+  {
+    rfPending[gpio] = FALSE;
+  }
+}
+
+/******************************************************************************
+ * @fn          trxSetIntEdge
+ *
+ * @brief       Selects the edge a radio GPIO latches on.
+ *
+ * input parameters
+ *
+ * @param       gpio - GPIO_0, GPIO_2 or GPIO_3
+ * @param       edge - RISING_EDGE or FALLING_EDGE
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxSetIntEdge(uint8 gpio, uint8 edge)
+{
+  if(gpio < RF_NUM_GPIO)
+  {
+    rfEdge[gpio] = edge;
+  }
+}
+
+/******************************************************************************
+ * @fn          trxEnableInt
+ *
+ * @brief       Enables the interrupt of a radio GPIO.
+ *
+ * input parameters
+ *
+ * @param       gpio - GPIO_0, GPIO_2 or GPIO_3
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxEnableInt(uint8 gpio)
+{
+  if(gpio < RF_NUM_GPIO)
+  {
+    rfEnabled[gpio] = TRUE;
+  }
+}
+
+/******************************************************************************
+ * @fn          trxDisableInt
+ *
+ * @brief       Disables the interrupt of a radio GPIO.
+ *
+ * input parameters
+ *
+ * @param       gpio - GPIO_0, GPIO_2 or GPIO_3
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxDisableInt(uint8 gpio)
+{
+  if(gpio < RF_NUM_GPIO)
+  {
+    rfEnabled[gpio] = FALSE;
+  }
+}
+
+/******************************************************************************
+ * @fn          trxSampleSyncPin
+ *
+ * @brief       Reads the level of a radio GPIO.
+ *
+ * input parameters
+ *
+ * @param       gpio - GPIO_0, GPIO_2 or GPIO_3
+ *
+ * output parameters
+ *
+ * @return      pin level
+ */
+uint8 trxSampleSyncPin(uint8 gpio)
+{
+  if((gpio == GPIO_0) || (gpio == GPIO_2))
+  {
+    return (halHostSimRadio()->gdo[gpio]);
+  }
+  return (0);
+}
+
+/******************************************************************************
+ * @fn          halHostSimRfGdoEdge
+ *
+ * @brief       GDO edge hook of the radio model. Latches the flag of the
+ *              GPIO when the edge matches the one selected.
+ *
+ * input parameters
+ *
+ * @param       pSim  - model instance
+ * @param       gdo   - GDO pin number
+ * @param       level - new pin level
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimRfGdoEdge(cc110LSim_t *pSim, uint8 gdo, uint8 level)
+{
+  (void)pSim;
+  if((gdo != GPIO_0) && (gdo != GPIO_2))
+  {
+    return;
+  }
+  if((level && (rfEdge[gdo] == RISING_EDGE)) || (!level && (rfEdge[gdo] == FALLING_EDGE)))
+  {
+    rfPending[gdo] = TRUE;
+  }
+}
+
+/******************************************************************************
+ * @fn          halHostSimRfDispatch
+ *
+ * @brief       Runs the ISRs of enabled GPIOs with a latched edge, clearing
+ *              the flag first, and wakes the main loop if an ISR asked for
+ *              it, as the port ISRs in hal_digio2.c do. Called with the
+ *              interrupt lock held.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimRfDispatch(void)
+{
+  uint8 gpio;
+
+  for(gpio = 0; gpio < RF_NUM_GPIO; gpio++)
+  {
+    if(rfPending[gpio] && rfEnabled[gpio])
+    {
+      rfPending[gpio] = FALSE;
+      if(rfIsr[gpio])
+      {
+        rfIsrRuns++;
+        (*rfIsr[gpio])();
+      }
+    }
+  }
+  if(halDigio2WakeOnExit)
+  {
+    halDigio2WakeOnExit = FALSE;
+    __low_power_mode_off_on_exit();
+  }
+}
+
+/******************************************************************************
+ * @fn          halHostSimRfReport
+ *
+ * @brief       Prints the number of radio interrupts serviced.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimRfReport(void)
+{
+  printf("irq: %lu radio interrupts\n", (unsigned long)rfIsrRuns);
+}
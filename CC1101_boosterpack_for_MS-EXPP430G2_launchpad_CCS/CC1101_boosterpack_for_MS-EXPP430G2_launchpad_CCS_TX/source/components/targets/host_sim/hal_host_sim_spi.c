@@ -0,0 +1,454 @@
+/******************************************************************************
+    Filename: hal_host_sim_spi.c
+
+    Description: Radio SPI transport of the host simulation target. Provides
+                 the interface of hal_msp_exp430g2_spi.h, clocking each
+                 transaction byte by byte through the CC110L model, and counts
+                 the traffic so the on-target bus time can be estimated.
+                 With TRX_SPI_TRACE the transaction trace is kept as on the
+                 target, stamped with the model time in us; the model is
+                 always ready, so no CHIP_RDYn wait is recorded, and the
+                 duration is the bus time at the SCLK set, in us. The drain
+                 prints to stdout and takes the model time the target's UART
+                 would, so the main loop is held up as long as on the target.
+
+*******************************************************************************/
+
+
+/******************************************************************************
+ * INCLUDES
+ */
+#include <stdio.h>
+#include "hal_msp_exp430g2_spi.h"
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_mcu.h"
+#include "hal_host_sim.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Trace line "tttt hh llll ss wwww dddd\n" on the target's UART, 10 bits
+ * per character at 9600 baud
+ */
+#define SPI_TRACE_LINE_CHARS  25
+#define SPI_TRACE_CHAR_US     1042
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+/* SCLK in kHz per HAL_MCU_SYSCLK_xMHZ setting, mirrors the prescaler table in
+ * hal_msp_exp430g2_spi.c.
+ */
+static const uint16 spiClockKhz[] = {1000, 4000, 4000, 6000, 5333, 5000, 6250};
+
+static uint16 spiSclkKhz = 1000;
+static uint32 spiTransactions;
+static uint32 spiBytes;
+static uint32 spiBusTimeNs;
+
+#ifdef TRX_SPI_TRACE
+static uint16             spiBeginUs;
+static uint32             spiBeginBusNs;
+static trxSpiTraceEntry_t spiTrace[TRX_SPI_TRACE_SIZE];
+static uint8              spiTraceHead;
+static uint8              spiTraceCount;
+static uint16             spiTraceLost;
+#endif
+
+/******************************************************************************
+ * STATIC FUNCTIONS
+ */
+static void  trxSpiSimBegin(void);
+static uint8 trxSpiSimByte(uint8 data);
+static void  trxSpiSimEnd(void);
+static void  trxReadWriteBurstSingle(uint8 addr, uint8 *pData, uint16 len);
+static void  trxSpiSimTrace(uint8 header, uint16 len, uint8 status);
+
+/******************************************************************************
+ * @fn          exp430RfSpiInit
+ *
+ * @brief       Nothing to set up on the host, the model is owned by the
+ *              board module.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void exp430RfSpiInit(void)
+{
+  exp430RfSpiSetClock(halMcuGetSystemClock());
+}
+
+/******************************************************************************
+ * @fn          exp430RfSpiSetClock
+ *
+ * @brief       Records the SCLK the target would run at for the bus time
+ *              estimate.
+ *
+ * input parameters
+ *
+ * @param       systemClock - HAL_MCU_SYSCLK_xMHZ setting now in use
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void exp430RfSpiSetClock(uint8 systemClock)
+{
+  if(systemClock < sizeof(spiClockKhz)/sizeof(spiClockKhz[0]))
+  {
+    spiSclkKhz = spiClockKhz[systemClock];
+  }
+}
+
+/******************************************************************************
+ * @fn          trx8BitRegAccess
+ *
+ * @brief       Register or FIFO access, see hal_msp_exp430g2_spi.c.
+ *
+ * input parameters
+ *
+ * @param       accessType - RADIO_BURST_ACCESS/RADIO_READ_ACCESS bits
+ * @param       addrByte   - register address
+ * @param       *pData     - data array
+ * @param       len        - number of data bytes
+ *
+ * output parameters
+ *
+ * @return      chip status byte
+ */
+uint8 trx8BitRegAccess(uint8 accessType, uint8 addrByte, uint8 *pData, uint16 len)
+{
+  uint8 readValue;
+
+  trxSpiSimBegin();
+  readValue = trxSpiSimByte(accessType|addrByte);
+  trxReadWriteBurstSingle(accessType|addrByte, pData, len);
+  trxSpiSimTrace(accessType|addrByte, len, readValue);
+  trxSpiSimEnd();
+  return(readValue);
+}
+
+/******************************************************************************
+ * @fn          trx8BitRegAccessSg
+ *
+ * @brief       Gather write or scatter read burst, see
+ *              hal_msp_exp430g2_spi.c.
+ *
+ * input parameters
+ *
+ * @param       accessType - RADIO_READ_ACCESS or RADIO_WRITE_ACCESS
+ * @param       addrByte   - address of the burst
+ * @param       *pSegs     - segment list
+ * @param       numSegs    - number of segments
+ *
+ * output parameters
+ *
+ * @return      chip status byte
+ */
+uint8 trx8BitRegAccessSg(uint8 accessType, uint8 addrByte, const trxSpiSeg_t *pSegs, uint8 numSegs)
+{
+  uint8  readValue;
+  uint16 total = 0;
+
+  accessType |= RADIO_BURST_ACCESS;
+  trxSpiSimBegin();
+  readValue = trxSpiSimByte(accessType|addrByte);
+  while(numSegs--)
+  {
+    trxReadWriteBurstSingle(accessType|addrByte, pSegs->pData, pSegs->len);
+    total += pSegs->len;
+    pSegs++;
+  }
+  trxSpiSimTrace(accessType|addrByte, total, readValue);
+  trxSpiSimEnd();
+  return(readValue);
+}
+
+/******************************************************************************
+ * @fn          trx16BitRegAccess
+ *
+ * @brief       Extended address space access (CC112X). The CC110L has no
+ *              extended registers, the bytes are passed on unchanged.
+ *
+ * input parameters
+ *
+ * @param       accessType - RADIO_BURST_ACCESS/RADIO_READ_ACCESS bits
+ * @param       extAddr    - extended register space address
+ * @param       regAddr    - register address in the extended space
+ * @param       *pData     - data array
+ * @param       len        - number of data bytes
+ *
+ * output parameters
+ *
+ * @return      chip status byte
+ */
+rfStatus_t trx16BitRegAccess(uint8 accessType, uint8 extAddr, uint8 regAddr, uint8 *pData, uint8 len)
+{
+  uint8 readValue;
+
+  trxSpiSimBegin();
+  readValue = trxSpiSimByte(accessType|extAddr);
+  trxSpiSimByte(regAddr);
+  trxReadWriteBurstSingle(accessType|extAddr, pData, len);
+  trxSpiSimTrace(accessType|extAddr, len, readValue);
+  trxSpiSimEnd();
+  return(readValue);
+}
+
+/******************************************************************************
+ * @fn          trxSpiCmdStrobe
+ *
+ * @brief       Sends a command strobe.
+ *
+ * input parameters
+ *
+ * @param       cmd - command strobe
+ *
+ * output parameters
+ *
+ * @return      chip status byte
+ */
+rfStatus_t trxSpiCmdStrobe(uint8 cmd)
+{
+  uint8 rc;
+
+  trxSpiSimBegin();
+  rc = trxSpiSimByte(cmd);
+  trxSpiSimTrace(cmd, 0, rc);
+  trxSpiSimEnd();
+  return(rc);
+}
+
+/******************************************************************************
+ * @fn          trxSpiSubmit
+ *
+ * @brief       Asynchronous access. The host transport completes it before
+ *              returning; the callback still runs as it would from the
+ *              USCIAB0RX ISR, with simulated interrupts held off.
+ *
+ * input parameters
+ *
+ * @param       pTrans - transaction descriptor
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxSpiSubmit(trxSpiTrans_t *pTrans)
+{
+  pTrans->pNext = NULL;
+  pTrans->done  = FALSE;
+  if(!(pTrans->header & RADIO_BURST_ACCESS) && (pTrans->len > 1))
+  {
+    pTrans->len = 1;
+  }
+
+  halHostSimIntLock();
+  trxSpiSimBegin();
+  pTrans->status = trxSpiSimByte(pTrans->header);
+  if(pTrans->extended)
+  {
+    trxSpiSimByte(pTrans->regAddr);
+  }
+  trxReadWriteBurstSingle(pTrans->header, pTrans->pData, pTrans->len);
+  trxSpiSimTrace(pTrans->header, pTrans->len, pTrans->status);
+  trxSpiSimEnd();
+  pTrans->done = TRUE;
+  if(pTrans->callback)
+  {
+    pTrans->callback(pTrans);
+  }
+  halHostSimIntUnlock();
+}
+
+/******************************************************************************
+ * @fn          trxSpiAsyncPending
+ *
+ * @brief       Submitted transactions complete immediately on the host.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      FALSE
+ */
+uint8 trxSpiAsyncPending(void)
+{
+  return(FALSE);
+}
+
+#ifdef TRX_SPI_TRACE
+/******************************************************************************
+ * @fn          trxSpiTraceRead
+ *
+ * @brief       Takes the oldest entry out of the transaction trace.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @param       pEntry - receives the entry
+ *
+ * @return      TRUE if an entry was returned, FALSE if the trace is empty
+ */
+uint8 trxSpiTraceRead(trxSpiTraceEntry_t *pEntry)
+{
+  uint8 found = FALSE;
+
+  halHostSimIntLock();
+  if(spiTraceCount)
+  {
+    *pEntry = spiTrace[(uint8)(spiTraceHead - spiTraceCount) & (TRX_SPI_TRACE_SIZE - 1)];
+    spiTraceCount--;
+    found = TRUE;
+  }
+  halHostSimIntUnlock();
+  return(found);
+}
+
+/******************************************************************************
+ * @fn          trxSpiTraceDrain
+ *
+ * @brief       Empties the transaction trace to stdout, in the line format
+ *              of the target's UART output, waiting the UART time of each
+ *              line.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void trxSpiTraceDrain(void)
+{
+  trxSpiTraceEntry_t entry;
+  uint16             lost;
+
+  halHostSimIntLock();
+  lost         = spiTraceLost;
+  spiTraceLost = 0;
+  halHostSimIntUnlock();
+  if(lost)
+  {
+    printf("L%04X\n", lost);
+    halMcuWaitUs(6 * SPI_TRACE_CHAR_US);
+  }
+  while(trxSpiTraceRead(&entry))
+  {
+    printf("%04X %02X %04X %02X %04X %04X\n", entry.timestamp, entry.header,
+           entry.len, entry.status, entry.rdyWait, entry.duration);
+    halMcuWaitUs(SPI_TRACE_LINE_CHARS * SPI_TRACE_CHAR_US);
+  }
+}
+#endif
+
+/******************************************************************************
+ * @fn          halHostSimSpiReport
+ *
+ * @brief       Prints the SPI traffic and the bus time it would take on the
+ *              target at the SCLK last configured.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halHostSimSpiReport(void)
+{
+  printf("spi: %lu transactions, %lu bytes, %lu.%03lu ms bus time at %u kHz SCLK\n",
+         (unsigned long)spiTransactions, (unsigned long)spiBytes,
+         (unsigned long)(spiBusTimeNs / 1000000UL),
+         (unsigned long)((spiBusTimeNs / 1000UL) % 1000UL), spiSclkKhz);
+}
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ */
+static void trxSpiSimBegin(void)
+{
+  halHostSimIntLock();
+  cc110LSimSelect(halHostSimRadio());
+  spiTransactions++;
+#ifdef TRX_SPI_TRACE
+  spiBeginUs    = (uint16)halHostSimRadio()->timeUs;
+  spiBeginBusNs = spiBusTimeNs;
+#endif
+}
+
+static uint8 trxSpiSimByte(uint8 data)
+{
+  spiBytes++;
+  spiBusTimeNs += 8000000UL / spiSclkKhz;
+  return (cc110LSimSpiByte(halHostSimRadio(), data));
+}
+
+static void trxSpiSimEnd(void)
+{
+  cc110LSimDeselect(halHostSimRadio());
+  // interrupts latched during the access are taken once CS_N is released
+  halHostSimIntDispatch();
+  halHostSimIntUnlock();
+}
+
+static void trxReadWriteBurstSingle(uint8 addr, uint8 *pData, uint16 len)
+{
+  uint16 i;
+
+  if(!(addr & RADIO_BURST_ACCESS))
+  {
+    len = 1;
+  }
+  for(i = 0; i < len; i++)
+  {
+    if(addr & RADIO_READ_ACCESS)
+    {
+      pData[i] = trxSpiSimByte(0);
+    }
+    else
+    {
+      trxSpiSimByte(pData[i]);
+    }
+  }
+}
+
+static void trxSpiSimTrace(uint8 header, uint16 len, uint8 status)
+{
+#ifdef TRX_SPI_TRACE
+  trxSpiTraceEntry_t *pEntry = &spiTrace[spiTraceHead];
+
+  spiTraceHead = (spiTraceHead + 1) & (TRX_SPI_TRACE_SIZE - 1);
+  if(spiTraceCount < TRX_SPI_TRACE_SIZE)
+  {
+    spiTraceCount++;
+  }
+  else
+  {
+    spiTraceLost++;
+  }
+  pEntry->timestamp = spiBeginUs;
+  pEntry->rdyWait   = 0;
+  pEntry->duration  = (uint16)((spiBusTimeNs - spiBeginBusNs) / 1000UL);
+  pEntry->len       = len;
+  pEntry->header    = header;
+  pEntry->status    = status;
+#else
+  (void)header;
+  (void)len;
+  (void)status;
+#endif
+}
@@ -0,0 +1,70 @@
+/******************************************************************************
+    Filename: msp430.h
+
+    Description: Host stand-in for the MSP430 device header, used when the
+                 apps are built against the host_sim target. Port registers
+                 are plain variables and the status register intrinsics map
+                 onto the simulator, so application code compiles unchanged.
+
+*******************************************************************************/
+#ifndef HOST_SIM_MSP430_H
+#define HOST_SIM_MSP430_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * CONSTANTS
+ */
+#define BIT0                  (0x0001)
+#define BIT1                  (0x0002)
+#define BIT2                  (0x0004)
+#define BIT3                  (0x0008)
+#define BIT4                  (0x0010)
+#define BIT5                  (0x0020)
+#define BIT6                  (0x0040)
+#define BIT7                  (0x0080)
+
+/* Status register bits */
+#define GIE                   (0x0008)
+#define CPUOFF                (0x0010)
+#define OSCOFF                (0x0020)
+#define SCG0                  (0x0040)
+#define SCG1                  (0x0080)
+
+#define LPM0_bits             (CPUOFF)
+#define LPM1_bits             (SCG0+CPUOFF)
+#define LPM2_bits             (SCG1+CPUOFF)
+#define LPM3_bits             (SCG1+SCG0+CPUOFF)
+#define LPM4_bits             (SCG1+SCG0+OSCOFF+CPUOFF)
+
+/******************************************************************************
+ * PORT REGISTERS
+ */
+extern volatile unsigned char P1IN, P1OUT, P1DIR, P1IFG, P1IES, P1IE, P1SEL, P1SEL2, P1REN;
+extern volatile unsigned char P2IN, P2OUT, P2DIR, P2IFG, P2IES, P2IE, P2SEL, P2SEL2, P2REN;
+
+/******************************************************************************
+ * INTRINSICS
+ */
+/* Entering a low power mode blocks until a simulated ISR calls
+ * __low_power_mode_off_on_exit(), see hal_host_sim_board.c.
+ */
+void           __bis_SR_register(unsigned short bits);
+void           __bic_SR_register(unsigned short bits);
+unsigned short _get_SR_register(void);
+void           __low_power_mode_off_on_exit(void);
+
+#define _BIS_SR(x)              __bis_SR_register(x)
+#define _BIC_SR(x)              __bic_SR_register(x)
+#define _enable_interrupts()    __bis_SR_register(GIE)
+#define _disable_interrupts()   __bic_SR_register(GIE)
+#define __no_operation()
+#define __delay_cycles(x)
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// HOST_SIM_MSP430_H
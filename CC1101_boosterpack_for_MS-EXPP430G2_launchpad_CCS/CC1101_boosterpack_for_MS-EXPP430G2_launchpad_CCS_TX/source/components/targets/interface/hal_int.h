@@ -87,7 +87,7 @@ extern "C" {
 #define HAL_INT_OFF()     st( _disable_interrupts(); )
 #define HAL_INT_LOCK(x)    st( (x) = _get_SR_register(); \
                                _disable_interrupts(); )
-#define HAL_INT_UNLOCK(x)  st( _enable_interrupts(); /*_bis_SR_register(x);*/ )
+#define HAL_INT_UNLOCK(x)  st( if((x) & GIE) { _enable_interrupts(); } )
 #endif
 
 #elif defined __ICC8051__
@@ -101,10 +101,20 @@ typedef unsigned short istate_t;
 
 #elif defined DESKTOP
 
+#if defined HAL_HOST_SIM
+/* Host simulation target: simulated ISRs are held off while locked */
+void halHostSimIntLock(void);
+void halHostSimIntUnlock(void);
+#define HAL_INT_ON()
+#define HAL_INT_OFF()
+#define HAL_INT_LOCK(x)    st( (x) = 1; halHostSimIntLock(); )
+#define HAL_INT_UNLOCK(x)  st( (void)(x); halHostSimIntUnlock(); )
+#else
 #define HAL_INT_ON()
 #define HAL_INT_OFF()
 #define HAL_INT_LOCK(x)    st ((x)= 1; )
 #define HAL_INT_UNLOCK(x)
+#endif
 
 #elif defined __KEIL__
 
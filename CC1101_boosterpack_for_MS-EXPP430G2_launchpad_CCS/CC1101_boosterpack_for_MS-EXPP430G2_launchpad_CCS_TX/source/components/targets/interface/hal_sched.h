@@ -0,0 +1,74 @@
+/******************************************************************************
+    Filename: hal_sched.h
+
+    Description: header file for the task scheduler: fixed priority, run to
+                 completion tasks from a static table, posted events by ISRs
+                 and by each other, with the MCU asleep in
+                 halMcuEventWait() while none is ready.
+
+*******************************************************************************/
+#ifndef HAL_SCHED_H
+#define HAL_SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+ * INCLUDES
+ */
+#include "hal_types.h"
+
+/******************************************************************************
+ * CONSTANTS
+ */
+/* Tasks in a table, one bit each in the ready mask */
+#define HAL_SCHED_MAX_TASKS             16
+
+/* Task number of no task, e.g. for halButtonSetTask() */
+#define HAL_SCHED_NO_TASK               0xFF
+
+/* halMcuEventWait() event set by every post; keep it out of the events an
+ * application waits for itself
+ */
+#define HAL_SCHED_MCU_EVENT             0x4000
+
+/******************************************************************************
+ * TYPEDEFS
+ */
+/* A task: runs to completion with the events posted to it since it last
+ * ran, at least one
+ */
+typedef void (*halSchedTask_t)(uint16 events);
+
+/* Task counters, halMcuGetTimeTicks() ticks */
+typedef struct
+{
+  uint16 runs;                              /* wraps */
+  uint32 maxRunTicks;                       /* longest run */
+  uint32 maxWaitTicks;                      /* longest from post to run */
+}halSchedStats_t;
+
+/******************************************************************************
+ * PROTPTYPES
+ */
+/* Task table, index 0 the highest priority */
+void   halSchedInit(const halSchedTask_t *pTasks, uint8 nTasks);
+void   halSchedRun(void);
+
+/* ISRs and tasks */
+void   halSchedPost(uint8 task, uint16 events);
+void   halSchedClear(uint8 task, uint16 events);
+
+/* Tasks only */
+uint16 halSchedWait(uint8 task, uint16 events);
+void   halSchedTimerStart(uint8 task, uint16 events, uint16 ms);
+void   halSchedTimerStop(uint8 task);
+
+uint8  halSchedGetTaskCount(void);
+const halSchedStats_t *halSchedGetStats(uint8 task);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif// HAL_SCHED_H
@@ -15,16 +15,54 @@
 #include "hal_board.h"
 #include "hal_types.h"
 #include "hal_digio2.h"
+#include "hal_mcu.h"
+#include "hal_int.h"
+#include "hal_msp_exp430g2_spi.h"
+#include "hal_sched.h"
+
+/******************************************************************************
+* CONSTANTS
+*/
+/* Timer0_A counts of ACLK per overflow, times 1000 */
+#define TIME_OVERFLOW_X1000     65536000UL
+
+/* Longest step of the event timeout per CCR0 compare */
+#define TIMEOUT_STEP            0x8000
 
 /******************************************************************************
 * LOCAL VARIABLES
 */
 static uint8 buttonPressed;
+static uint8 buttonTask = HAL_SCHED_NO_TASK;
+static uint16 buttonEvents;
+static uint8 systemClock;
+
+/* Time base: Timer0_A counting ACLK, which runs in LPM3 */
+static uint16 aclkHz;
+static uint16 overflowMs;               /* ms per timer overflow */
+static uint16 overflowRem;              /* and the remainder, 1/aclkHz ms */
+static volatile uint32 timeMs;          /* at the last overflow */
+static volatile uint16 timeRem;         /* 1/aclkHz ms */
+static volatile uint16 timeOverflows;
+
+/* Events and the timeout of halMcuEventWait() */
+static volatile uint16 mcuEvents;
+static volatile uint32 timeoutTicks;    /* left after the armed compare */
+
+/* Time asleep, ACLK ticks */
+static uint32 cpuLpm0Ticks;
+static uint32 cpuLpm3Ticks;
 
 /******************************************************************************
 * STATIC FUNCTIONS
 */
 static void buttonPressedISR(void);
+static uint16 halMcuTimerRead(void);
+static uint32 halMcuTimeTicks(void);
+static void halMcuTimeoutStep(uint16 from);
+#ifndef HAL_MCU_ACLK_XT1
+static uint16 halMcuVloHz(void);
+#endif
 
 /******************************************************************************
  * @fn          halInitMCU
@@ -39,14 +77,502 @@ void halInitMCU(void)
 {
   WDTCTL = WDTPW + WDTHOLD;                 // Stop WDT
   
-  BCSCTL1 = CALBC1_1MHZ;                    // Set range
-  DCOCTL = CALDCO_1MHZ;
+  halMcuSetSystemClock(HAL_MCU_SYSCLK_1MHZ);
   BCSCTL2 &= ~(DIVS_3);                     // SMCLK = DCO = 1MHz  
   
   // Enable global interrupt
   _BIS_SR(GIE);
 }
 
+/******************************************************************************
+ * @fn          halMcuSetSystemClock
+ *
+ * @brief       Sets MCLK and SMCLK (DCO) to one of the factory calibrated
+ *              frequencies and re-derives the radio SPI prescaler for it.
+ *              Only the 1, 8, 12 and 16 MHz calibrations exist on the G2553,
+ *              other settings are ignored.
+ *
+ *              NOTE: 12 and 16 MHz need VCC above 2.7 and 3.3 V. Everything
+ *              clocked from SMCLK scales with the setting, e.g. the WDT
+ *              button debounce interval.
+ *
+ * input parameters
+ *
+ * @param       systemClockSpeed - HAL_MCU_SYSCLK_1MHZ, HAL_MCU_SYSCLK_8MHZ,
+ *                                 HAL_MCU_SYSCLK_12MHZ or HAL_MCU_SYSCLK_16MHZ
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuSetSystemClock(unsigned char systemClockSpeed)
+{
+  uint8 bcsCtl1;
+  uint8 dcoCtl;
+
+  switch(systemClockSpeed)
+  {
+    case HAL_MCU_SYSCLK_1MHZ:
+      bcsCtl1 = CALBC1_1MHZ;
+      dcoCtl  = CALDCO_1MHZ;
+      break;
+    case HAL_MCU_SYSCLK_8MHZ:
+      bcsCtl1 = CALBC1_8MHZ;
+      dcoCtl  = CALDCO_8MHZ;
+      break;
+    case HAL_MCU_SYSCLK_12MHZ:
+      bcsCtl1 = CALBC1_12MHZ;
+      dcoCtl  = CALDCO_12MHZ;
+      break;
+    case HAL_MCU_SYSCLK_16MHZ:
+      bcsCtl1 = CALBC1_16MHZ;
+      dcoCtl  = CALDCO_16MHZ;
+      break;
+    default:
+      return;
+  }
+  if(BCSCTL1 == bcsCtl1 && DCOCTL == dcoCtl)
+  {
+    return;
+  }
+
+  // Drop to the lowest tap first so the new range never overshoots
+  DCOCTL  = 0;
+  BCSCTL1 = bcsCtl1;
+  DCOCTL  = dcoCtl;
+  systemClock = systemClockSpeed;
+
+  exp430RfSpiSetClock(systemClockSpeed);
+}
+
+/******************************************************************************
+ * @fn          halMcuGetSystemClock
+ *
+ * @brief       Returns the clock setting last applied by halMcuSetSystemClock
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      HAL_MCU_SYSCLK_xMHZ
+ */
+uint8 halMcuGetSystemClock(void)
+{
+  return(systemClock);
+}
+
+/******************************************************************************
+ * @fn          halMcuWaitUs
+ *
+ * @brief       Busy waits for about usec microseconds at the clock set by
+ *              halMcuSetSystemClock(). A software loop: at 1 MHz it counts
+ *              in steps of 5 us, and interrupts taken meanwhile add to it.
+ *              Every pass holds a __delay_cycles() so the optimizer cannot
+ *              drop the loop.
+ *
+ * input parameters
+ *
+ * @param       usec - microseconds to wait
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuWaitUs(uint16 usec)
+{
+  // a pass of the loop takes about 4 cycles besides the delay
+  switch(systemClock)
+  {
+    case HAL_MCU_SYSCLK_16MHZ:
+      while(usec--)
+      {
+        __delay_cycles(12);
+      }
+      break;
+    case HAL_MCU_SYSCLK_12MHZ:
+      while(usec--)
+      {
+        __delay_cycles(8);
+      }
+      break;
+    case HAL_MCU_SYSCLK_8MHZ:
+      while(usec--)
+      {
+        __delay_cycles(4);
+      }
+      break;
+    default:
+      // too slow for a pass per microsecond: a pass takes 5 cycles,
+      // and usec/5 is taken as usec/4 - usec/16
+      usec = (usec >> 2) - (usec >> 4);
+      while(usec--)
+      {
+        __delay_cycles(1);
+      }
+      break;
+  }
+}
+
+/******************************************************************************
+ * @fn          halMcuWaitMs
+ *
+ * @brief       Busy waits for about msec milliseconds, see halMcuWaitUs().
+ *
+ * input parameters
+ *
+ * @param       msec - milliseconds to wait
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuWaitMs(uint16 msec)
+{
+  while(msec--)
+  {
+    halMcuWaitUs(1000);
+  }
+}
+
+/******************************************************************************
+ * @fn          halMcuTimeInit
+ *
+ * @brief       Starts the millisecond time base on Timer0_A, counting ACLK
+ *              in continuous mode, so it keeps running in LPM3. ACLK comes
+ *              from the VLO, measured against SMCLK here as it varies from
+ *              part to part, or from a 32768 Hz crystal on XIN/XOUT with
+ *              HAL_MCU_ACLK_XT1. The timer interrupts on overflow only,
+ *              every 2 s or so, and CCR0 times halMcuEventWait().
+ *
+ *              NOTE: the SPI trace, TRX_SPI_TRACE, timestamps in ticks of
+ *              this timer then.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuTimeInit(void)
+{
+#ifdef HAL_MCU_ACLK_XT1
+  BCSCTL3 = XCAP_3;                         // 12.5 pF, the LaunchPad crystal
+  do
+  {
+    IFG1 &= ~OFIFG;
+    __delay_cycles(1000);
+  } while(BCSCTL3 & LFXT1OF);
+  aclkHz = 32768;
+#else
+  BCSCTL3 = LFXT1S_2;                       // ACLK = VLO
+  aclkHz = halMcuVloHz();
+#endif
+  overflowMs  = (uint16)(TIME_OVERFLOW_X1000 / aclkHz);
+  overflowRem = (uint16)(TIME_OVERFLOW_X1000 % aclkHz);
+  timeMs        = 0;
+  timeRem       = 0;
+  timeOverflows = 0;
+  cpuLpm0Ticks  = 0;
+  cpuLpm3Ticks  = 0;
+  TA0CCTL0 = 0;
+  TA0CTL   = TASSEL_1 + MC_2 + TACLR + TAIE; // ACLK, continuous
+}
+
+/******************************************************************************
+ * @fn          halMcuGetTimeMs
+ *
+ * @brief       Returns the milliseconds since halMcuTimeInit(). Wraps after
+ *              about 49 days; take differences of unsigned values.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      time in milliseconds
+ */
+uint32 halMcuGetTimeMs(void)
+{
+  istate_t key;
+  uint32   now;
+  uint16   rem;
+  uint16   tar;
+
+  if(!aclkHz)
+  {
+    return (0);
+  }
+  HAL_INT_LOCK(key);
+  tar = halMcuTimerRead();
+  now = timeMs;
+  rem = timeRem;
+  // an overflow not yet counted by the ISR
+  if((TA0CTL & TAIFG) && !(tar & 0x8000))
+  {
+    now += overflowMs;
+    rem += overflowRem;
+  }
+  HAL_INT_UNLOCK(key);
+  return (now + ((uint32)tar * 1000 + rem) / aclkHz);
+}
+
+/******************************************************************************
+ * @fn          halMcuGetTimeTicks
+ *
+ * @brief       Returns the ticks of the time base since halMcuTimeInit(),
+ *              ACLK periods: about 83 us from the VLO, 31 us from a
+ *              crystal. Wraps; take differences of unsigned values.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      ticks
+ */
+uint32 halMcuGetTimeTicks(void)
+{
+  istate_t key;
+  uint32   ticks;
+
+  HAL_INT_LOCK(key);
+  ticks = halMcuTimeTicks();
+  HAL_INT_UNLOCK(key);
+  return (ticks);
+}
+
+/******************************************************************************
+ * @fn          halMcuTicksToUs
+ *
+ * @brief       Converts time base ticks to microseconds, to 16 us. Takes a
+ *              32 bit division, keep it out of time critical code.
+ *
+ * input parameters
+ *
+ * @param       ticks - halMcuGetTimeTicks() ticks
+ *
+ * output parameters
+ *
+ * @return      microseconds
+ */
+uint32 halMcuTicksToUs(uint32 ticks)
+{
+  if(!aclkHz)
+  {
+    return (0);
+  }
+  // the remainder is below 65536, times 62500 it fits 32 bits
+  return (ticks / aclkHz * 1000000UL + (ticks % aclkHz) * 62500UL / aclkHz * 16);
+}
+
+/******************************************************************************
+ * @fn          halMcuEventSet
+ *
+ * @brief       Sets events for halMcuEventWait(). A port pin handler also
+ *              calls HAL_DIGIO2_WAKE_ON_EXIT() to wake the main loop.
+ *
+ * input parameters
+ *
+ * @param       events - bitmask, defined by the application
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuEventSet(uint16 events)
+{
+  istate_t key;
+
+  HAL_INT_LOCK(key);
+  mcuEvents |= events;
+  HAL_INT_UNLOCK(key);
+}
+
+/******************************************************************************
+ * @fn          halMcuEventClear
+ *
+ * @brief       Drops events set so far, e.g. edges of a radio operation the
+ *              caller is about to start over.
+ *
+ * input parameters
+ *
+ * @param       events - bitmask
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halMcuEventClear(uint16 events)
+{
+  istate_t key;
+
+  HAL_INT_LOCK(key);
+  mcuEvents &= ~events;
+  HAL_INT_UNLOCK(key);
+}
+
+/******************************************************************************
+ * @fn          halMcuEventWait
+ *
+ * @brief       Sleeps until one of the events is set, and takes the ones
+ *              set. The CPU sleeps in the deepest low power mode the
+ *              clocks in use allow: LPM0 while SMCLK clocks an SPI
+ *              transaction submitted with trxSpiSubmit() or the WDT times
+ *              the button debounce, else LPM3, with ACLK left for the time
+ *              base. Each interrupt that does not set an awaited event
+ *              puts the CPU back to sleep.
+ *
+ *              The time asleep is kept for halMcuGetCpuStats(), ISRs run
+ *              meanwhile included.
+ *
+ * input parameters
+ *
+ * @param       events    - bitmask
+ * @param       timeoutMs - 0 to wait for ever, else HAL_MCU_EVENT_TIMEOUT
+ *                          is set after as many milliseconds; needs
+ *                          halMcuTimeInit()
+ *
+ * output parameters
+ *
+ * @return      the events taken, HAL_MCU_EVENT_TIMEOUT if none came
+ */
+uint16 halMcuEventWait(uint16 events, uint16 timeoutMs)
+{
+  istate_t key;
+  uint16   taken;
+  uint16   sleepBits;
+  uint32   ticks;
+
+  HAL_INT_LOCK(key);
+  if(timeoutMs && aclkHz)
+  {
+    ticks = (uint32)timeoutMs * aclkHz / 1000;
+    timeoutTicks = (ticks < 2) ? 2 : ticks;
+    mcuEvents &= ~HAL_MCU_EVENT_TIMEOUT;
+    events    |= HAL_MCU_EVENT_TIMEOUT;
+    halMcuTimeoutStep(halMcuTimerRead());
+    TA0CCTL0 = CCIE;
+  }
+  while(!(mcuEvents & events))
+  {
+    sleepBits = (trxSpiAsyncPending() || (IE1 & WDTIE)) ? LPM0_bits : LPM3_bits;
+    ticks = halMcuTimeTicks();
+    // sets GIE with the LPM bits, so a wake up cannot slip in between
+    _BIS_SR(sleepBits + GIE);
+    HAL_INT_OFF();
+    ticks = halMcuTimeTicks() - ticks;
+    if(sleepBits == LPM0_bits)
+    {
+      cpuLpm0Ticks += ticks;
+    }
+    else
+    {
+      cpuLpm3Ticks += ticks;
+    }
+  }
+  TA0CCTL0   = 0;
+  taken      = mcuEvents & events;
+  mcuEvents &= ~taken;
+  HAL_INT_UNLOCK(key);
+  return (taken);
+}
+
+/******************************************************************************
+ * @fn          halMcuGetCpuStats
+ *
+ * @brief       Returns the time spent awake and asleep since
+ *              halMcuTimeInit(), and the average MCU supply current from
+ *              the typical figures in hal_board.h.
+ *
+ * input parameters
+ *
+ * output parameters
+ *
+ * @param       pStats - gets the figures
+ *
+ * @return      void
+ */
+void halMcuGetCpuStats(halMcuCpuStats_t *pStats)
+{
+  istate_t key;
+  uint32   total;
+  uint32   lpm0;
+  uint32   lpm3;
+  uint16   lpm0Pm;
+  uint16   lpm3Pm;
+
+  HAL_INT_LOCK(key);
+  pStats->totalTicks = halMcuTimeTicks();
+  pStats->lpm0Ticks  = cpuLpm0Ticks;
+  pStats->lpm3Ticks  = cpuLpm3Ticks;
+  HAL_INT_UNLOCK(key);
+
+  // per mille of the total, scaled down so the products fit
+  total = pStats->totalTicks;
+  lpm0  = pStats->lpm0Ticks;
+  lpm3  = pStats->lpm3Ticks;
+  while(total > 0x3FFFFFUL)
+  {
+    total >>= 1;
+    lpm0  >>= 1;
+    lpm3  >>= 1;
+  }
+  lpm0Pm = total ? (uint16)(lpm0 * 1000 / total) : 0;
+  lpm3Pm = total ? (uint16)(lpm3 * 1000 / total) : 0;
+  pStats->activePermille = total ? 1000 - lpm0Pm - lpm3Pm : 1000;
+  pStats->currentNa = (HAL_BOARD_AM_NA * pStats->activePermille
+                       + HAL_BOARD_LPM0_NA * lpm0Pm
+                       + HAL_BOARD_LPM3_NA * lpm3Pm) / 1000;
+}
+
+/******************************************************************************
+ * @fn          halMcuCompilerBarrier
+ *
+ * @brief       Compiler barrier for compilers without one of their own, see
+ *              HAL_MCU_COMPILER_BARRIER(). Never inlined, so the compiler
+ *              must take it to read and write any memory.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+#pragma FUNC_CANNOT_INLINE(halMcuCompilerBarrier)
+void halMcuCompilerBarrier(void)
+{
+}
+
+/******************************************************************************
+ * @fn          halAssertHandler
+ *
+ * @brief       Called by HAL_ASSERT() on a failed check: stops with
+ *              interrupts off and both LEDs on, for the debugger.
+ *
+ * input parameters
+ *
+ * @param       none
+ *
+ * output parameters
+ *
+ * @return      void, does not return
+ */
+void halAssertHandler(void)
+{
+  HAL_INT_OFF();
+  LED_DIR |= LED1 + LED2;
+  LED_OUT |= LED1 + LED2;
+  while(1);
+}
+
 /******************************************************************************
  * @fn          halLedInit
  *
@@ -154,6 +680,32 @@ uint8 halButtonPushed(void)
   return value;
 }
 
+/******************************************************************************
+ * @fn          halButtonSetTask
+ *
+ * @brief       Has each button push, once halButtonInterruptEnable() is
+ *              called, post events to a task of hal_sched.c; the push is
+ *              still kept for halButtonPushed().
+ *
+ * input parameters
+ *
+ * @param       task   - task number, HAL_SCHED_NO_TASK for none
+ * @param       events - bitmask posted
+ *
+ * output parameters
+ *
+ * @return      void
+ */
+void halButtonSetTask(uint8 task, uint16 events)
+{
+  istate_t key;
+
+  HAL_INT_LOCK(key);
+  buttonTask   = task;
+  buttonEvents = events;
+  HAL_INT_UNLOCK(key);
+}
+
 /******************************************************************************
  * @fn          function name
  *
@@ -172,7 +724,11 @@ static void buttonPressedISR(void)
   IE1 |= WDTIE;
   
   buttonPressed = BUTTON_PRESSED;
-  
+  if(buttonTask != HAL_SCHED_NO_TASK)
+  {
+    halSchedPost(buttonTask, buttonEvents);
+    HAL_DIGIO2_WAKE_ON_EXIT();
+  }
 }
 /******************************************************************************
  * @fn          function name
@@ -192,6 +748,114 @@ __interrupt void WDT_ISR(void)
     BUTTON_IE |= BUTTON;             /* Debouncing complete */
 }
 
+/******************************************************************************
+ * @fn          TIMER0_A0_ISR
+ *
+ * @brief       Timeout of halMcuEventWait(). Long timeouts take several
+ *              compares, each moving CCR0 on from the last one.
+ *
+ * @param       none
+ *
+ * @return      none
+*/
+#pragma vector=TIMER0_A0_VECTOR
+__interrupt void TIMER0_A0_ISR(void)
+{
+    if(timeoutTicks)
+    {
+      halMcuTimeoutStep(TA0CCR0);
+      return;
+    }
+    TA0CCTL0   = 0;
+    mcuEvents |= HAL_MCU_EVENT_TIMEOUT;
+    __low_power_mode_off_on_exit();
+}
+
+/******************************************************************************
+ * @fn          TIMER0_A1_ISR
+ *
+ * @brief       Timer overflow, the time base moves on by a timer period.
+ *
+ * @param       none
+ *
+ * @return      none
+*/
+#pragma vector=TIMER0_A1_VECTOR
+__interrupt void TIMER0_A1_ISR(void)
+{
+    if(TA0IV == TA0IV_TAIFG)
+    {
+      timeOverflows++;
+      timeMs  += overflowMs;
+      timeRem += overflowRem;
+      if(timeRem >= aclkHz)
+      {
+        timeRem -= aclkHz;
+        timeMs++;
+      }
+    }
+}
+
+/* TA0R: ACLK is asynchronous to MCLK, read until two reads agree */
+static uint16 halMcuTimerRead(void)
+{
+  uint16 tar;
+
+  do
+  {
+    tar = TA0R;
+  } while(tar != TA0R);
+  return (tar);
+}
+
+/* ACLK ticks since halMcuTimeInit(), call with interrupts locked */
+static uint32 halMcuTimeTicks(void)
+{
+  uint16 tar       = halMcuTimerRead();
+  uint16 overflows = timeOverflows;
+
+  if((TA0CTL & TAIFG) && !(tar & 0x8000))
+  {
+    overflows++;
+  }
+  return (((uint32)overflows << 16) | tar);
+}
+
+/* Arms the next CCR0 compare of the event timeout, from a timer count */
+static void halMcuTimeoutStep(uint16 from)
+{
+  uint16 step = (timeoutTicks > TIMEOUT_STEP) ? TIMEOUT_STEP : (uint16)timeoutTicks;
+
+  timeoutTicks -= step;
+  TA0CCR0 = from + step;
+}
+
+#ifndef HAL_MCU_ACLK_XT1
+/* VLO frequency: SMCLK cycles in 8 periods of ACLK, divided by 8 for the
+ * measurement and captured by CCR0 on CCI0B, which is ACLK
+ */
+static uint16 halMcuVloHz(void)
+{
+  static const uint8 smclkMhz[] = {1, 4, 8, 12, 16, 20, 25};
+  uint16 first;
+  uint16 cycles;
+
+  BCSCTL1 |= DIVA_3;
+  TA0CCTL0 = CM_1 + CCIS_1 + CAP;
+  TA0CTL   = TASSEL_2 + MC_2 + TACLR;
+  TA0CCTL0 &= ~CCIFG;
+  while(!(TA0CCTL0 & CCIFG));
+  first = TA0CCR0;
+  TA0CCTL0 &= ~CCIFG;
+  while(!(TA0CCTL0 & CCIFG));
+  cycles = TA0CCR0 - first;
+  TA0CTL   = 0;
+  TA0CCTL0 = 0;
+  BCSCTL1 &= ~DIVA_3;
+  return ((uint16)(smclkMhz[systemClock] * 8000000UL / cycles));
+}
+#endif
+
 
 
 
@@ -15,6 +15,16 @@
 static ISR_FUNC_PTR port1_isr_tbl[8] = {0};
 static ISR_FUNC_PTR port2_isr_tbl[8] = {0};
 
+// Index of the lowest set bit of a nibble, the highest priority pin
+static const uint8 lowest_pin_tbl[16] = {0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
+
+// Number of the lowest pin set in a non-zero pin mask
+#define LOWEST_PIN(mask)  (((mask) & 0x0F) ? lowest_pin_tbl[(mask) & 0x0F] \
+                                           : 4 + lowest_pin_tbl[(mask) >> 4])
+
+// Set by HAL_DIGIO2_WAKE_ON_EXIT() in a pin handler
+uint8 halDigio2WakeOnExit;
+
 
 
 //----------------------------------------------------------------------------------
@@ -110,43 +120,61 @@ uint8 halDigio2IntSetEdge(digio io, uint8 edge)
 
 
 //----------------------------------------------------------------------------------
+//  Port ISRs. The pins to serve are taken once as PxIFG & PxIE and served
+//  from the lowest pin number up, each flag being cleared before its handler
+//  runs so an edge arriving meanwhile is kept for the next entry. Flags of
+//  enabled pins without a handler are cleared too. The main loop is woken
+//  only if a handler asked for it with HAL_DIGIO2_WAKE_ON_EXIT().
 //----------------------------------------------------------------------------------
 #pragma vector=PORT1_VECTOR
 __interrupt void port1_ISR(void)
 {
-    register uint8 i;
-    if (P1IFG)
+    register uint8 pending = P1IFG & P1IE;
+    register uint8 bitmask;
+    ISR_FUNC_PTR handler;
+
+    while (pending)
     {
-        for (i = 0; i < 8; i++)
+        bitmask  = pending & (uint8)(0 - pending);
+        pending &= ~bitmask;
+        P1IFG   &= ~bitmask;
+        handler  = port1_isr_tbl[LOWEST_PIN(bitmask)];
+        if (handler != 0)
         {
-            register const uint8 bitmask = 1 << i;
-            if ((P1IFG & bitmask) && (P1IE & bitmask) && (port1_isr_tbl[i] != 0))
-            {
-                (*port1_isr_tbl[i])();
-                P1IFG &= ~bitmask;
-            }
+            (*handler)();
         }
+    }
+    if (halDigio2WakeOnExit)
+    {
+        halDigio2WakeOnExit = FALSE;
         __low_power_mode_off_on_exit();
     }
 }
 
+
 //----------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------
 #pragma vector=PORT2_VECTOR
 __interrupt void port2_ISR(void)
 {
-    register uint8 i;
-    if (P2IFG)
+    register uint8 pending = P2IFG & P2IE;
+    register uint8 bitmask;
+    ISR_FUNC_PTR handler;
+
+    while (pending)
     {
-        for (i = 0; i < 8; i++)
+        bitmask  = pending & (uint8)(0 - pending);
+        pending &= ~bitmask;
+        P2IFG   &= ~bitmask;
+        handler  = port2_isr_tbl[LOWEST_PIN(bitmask)];
+        if (handler != 0)
         {
-            register const uint8 bitmask = 1 << i;
-            if ((P2IFG & bitmask) && (P2IE & bitmask) && (port2_isr_tbl[i] != 0))
-            {
-                (*port2_isr_tbl[i])();
-                P2IFG &= ~bitmask;
-            }
+            (*handler)();
         }
+    }
+    if (halDigio2WakeOnExit)
+    {
+        halDigio2WakeOnExit = FALSE;
         __low_power_mode_off_on_exit();
     }
 }
@@ -29,6 +29,58 @@ extern "C" {
 #define RISING_EDGE  1
 #define FALLING_EDGE 0
   
+/* Pins the radio GPIOs are wired to: port and pin number */
+#define TRX_GPIO0_PORT  2
+#define TRX_GPIO0_PIN   6
+#define TRX_GPIO2_PORT  1
+#define TRX_GPIO2_PIN   0
+#define TRX_GPIO3_PORT  1
+#define TRX_GPIO3_PIN   0
+
+#define TRX_GPIO0_BIT   (1 << TRX_GPIO0_PIN)
+#define TRX_GPIO2_BIT   (1 << TRX_GPIO2_PIN)
+#define TRX_GPIO3_BIT   (1 << TRX_GPIO3_PIN)
+
+/******************************************************************************
+ * MACROS
+ */
+/* Radio GPIO interrupt control bound at compile time. gpio must be a
+ * constant GPIO_x; each macro then compiles to one bis.b/bic.b/bit.b on the
+ * port register instead of the lookups behind the trx*Int functions, which
+ * makes them the choice for ISRs and other per packet paths.
+ *
+ * TRX_INT_ENABLE(GPIO_0);
+ * TRX_INT_CLEAR(GPIO_0);
+ */
+#ifndef HAL_HOST_SIM
+#define TRX_INT_ENABLE(gpio)          TRX_INT_ENABLE_(gpio)
+#define TRX_INT_DISABLE(gpio)         TRX_INT_DISABLE_(gpio)
+#define TRX_INT_CLEAR(gpio)           TRX_INT_CLEAR_(gpio)
+#define TRX_INT_SET_EDGE(gpio, edge)  TRX_INT_SET_EDGE_(gpio, edge)
+#define TRX_SAMPLE_PIN(gpio)          TRX_SAMPLE_PIN_(gpio)
+#else
+/* The host simulation models the pins behind the functions */
+#define TRX_INT_ENABLE(gpio)          trxEnableInt(gpio)
+#define TRX_INT_DISABLE(gpio)         trxDisableInt(gpio)
+#define TRX_INT_CLEAR(gpio)           trxClearIntFlag(gpio)
+#define TRX_INT_SET_EDGE(gpio, edge)  trxSetIntEdge(gpio, edge)
+#define TRX_SAMPLE_PIN(gpio)          trxSampleSyncPin(gpio)
+#endif
+
+/* Second level, so GPIO_x is expanded to its number before pasting */
+#define TRX_INT_ENABLE_(n)            st( TRX_GPIO_REG(TRX_GPIO##n##_PORT, IE)  |=  TRX_GPIO##n##_BIT; )
+#define TRX_INT_DISABLE_(n)           st( TRX_GPIO_REG(TRX_GPIO##n##_PORT, IE)  &= ~TRX_GPIO##n##_BIT; )
+#define TRX_INT_CLEAR_(n)             st( TRX_GPIO_REG(TRX_GPIO##n##_PORT, IFG) &= ~TRX_GPIO##n##_BIT; )
+#define TRX_INT_SET_EDGE_(n, edge)    st( if((edge) == FALLING_EDGE)                                 \
+                                          { TRX_GPIO_REG(TRX_GPIO##n##_PORT, IES) |=  TRX_GPIO##n##_BIT; } \
+                                          else                                                       \
+                                          { TRX_GPIO_REG(TRX_GPIO##n##_PORT, IES) &= ~TRX_GPIO##n##_BIT; } )
+#define TRX_SAMPLE_PIN_(n)            ((TRX_GPIO_REG(TRX_GPIO##n##_PORT, IN) & TRX_GPIO##n##_BIT) != 0)
+
+/* PxREG of a port number */
+#define TRX_GPIO_REG(port, reg)       TRX_GPIO_REG_(port, reg)
+#define TRX_GPIO_REG_(port, reg)      P##port##reg
+
 /******************************************************************************
  * FUNCTIONS
  */
@@ -38,6 +90,7 @@ void        trxIsrConnect(uint8 gpio, uint8 edge, ISR_FUNC_PTR pF);
 void        trxEnableInt(uint8 gpio);                                         
 void        trxDisableInt(uint8 gpio);                                        
 void        trxClearIntFlag(uint8 gpio); 
+void        trxSetIntEdge(uint8 gpio, uint8 edge);
 uint8       trxSampleSyncPin(uint8 gpio);    
 
 #ifdef  __cplusplus